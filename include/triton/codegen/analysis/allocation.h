@@ -30,12 +30,18 @@ public:
   bool has_offset(const data_layout *x)    const { return offsets_.find(x) != offsets_.end(); }
   unsigned offset(const data_layout *x)    const { return offsets_.at(x); }
   unsigned allocated_size()        const { return allocated_size_; }
+  // bytes above the maximum amount of simultaneously live memory
+  unsigned wasted_size()           const { return allocated_size_ - live_size_; }
+  // size found by the previous greedy allocator, for comparison.
+  // Re-runs that allocator, so only meant for statistics
+  unsigned legacy_allocated_size() const;
   // run
   void run(ir::module& mod);
 
 private:
   std::map<const data_layout*, unsigned> offsets_;
   size_t allocated_size_;
+  size_t live_size_;
   // dependences
   liveness *liveness_;
 };
@@ -23,6 +23,7 @@ private:
   // update graph
   void update_graph_store(ir::instruction *i);
   void update_graph_reduce(ir::instruction *i);
+  void update_graph_sort(ir::instruction *i);
   void update_graph_reshape(ir::instruction *i);
   void update_graph_trans(ir::instruction *i);
   void update_graph_broadcast(ir::instruction *i);
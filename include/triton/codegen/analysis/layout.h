@@ -16,6 +16,7 @@ namespace ir{
   class module;
   class instruction;
   class phi_node;
+  class reduce_inst;
 }
 
 namespace codegen{
@@ -148,6 +149,10 @@ struct scanline_layout: public distributed_layout {
   // accessor
   int mts(size_t k) { return mts_.at(k); }
   int nts(size_t k) { return nts_.at(k); }
+  // distance between the lanes of consecutive threads along axis `k`
+  int lane_stride(size_t k);
+  // number of threads along axis `k` within a single warp
+  int mts_per_warp(size_t k);
 
 public:
   // micro tile size. The size of a tile held by a thread block.
@@ -182,7 +187,7 @@ public:
                 const std::vector<unsigned>& shapes,
                 const std::vector<ir::value *> &values_,
                 ir::type *ty,
-                analysis::align* align);
+                analysis::align* align, target *tgt);
   void accept(layout_visitor* vst) { vst->visit_layout_shared(this); }
   // accessors
   size_t get_size()                         { return size_; }
@@ -226,6 +231,7 @@ private:
   void init_scanline_tile(data_layout &layouts);
 
   void create(size_t id, const std::vector<ir::value*>& values);
+  void fuse_reductions(ir::module &mod);
 
 public:
   // constructor
@@ -242,6 +248,8 @@ public:
   bool has_tmp(ir::value* i)                                  { return tmp_.find(i) != tmp_.end(); }
   int tmp(ir::value* i)                                       { return tmp_.at(i);}
   void copy(ir::value* dst, ir::value* src)                   { groups_[dst] = groups_[src]; }
+  // reductions lowered in the same tree as `red`, the first one included
+  const std::vector<ir::reduce_inst*>& fused_with(ir::reduce_inst* red) { return fused_.at(red); }
   // execution
   void run(ir::module &mod);
 
@@ -255,6 +263,7 @@ private:
   std::map<size_t, std::vector<ir::value*>> values_;
   std::map<size_t, data_layout*> layouts_;
   std::map<ir::value*, size_t> tmp_;
+  std::map<ir::reduce_inst*, std::vector<ir::reduce_inst*>> fused_;
 };
 
 }
@@ -0,0 +1,49 @@
+#ifndef TDL_INCLUDE_CODEGEN_PRESSURE_H
+#define TDL_INCLUDE_CODEGEN_PRESSURE_H
+
+#include <map>
+#include <set>
+
+namespace triton {
+
+namespace ir {
+  class value;
+  class module;
+  class function;
+}
+
+namespace codegen{
+namespace analysis{
+
+class layouts;
+
+// Estimate of the number of 32-bit registers each thread needs, from the
+// number of elements of each distributed layout held by a thread and from
+// the live ranges of values over the CFG.
+class pressure {
+private:
+  void run(ir::function *fn);
+
+public:
+  pressure(layouts *l, int num_warps): layouts_(l), num_warps_(num_warps) { }
+  void run(ir::module &mod);
+  // registers per thread needed to hold `v`
+  unsigned get(ir::value *v);
+  // largest number of registers live at the same time
+  unsigned max_live() const { return max_live_; }
+  // values live where `max_live` is reached
+  const std::set<ir::value*>& get_peak() const { return peak_; }
+
+private:
+  layouts *layouts_;
+  int num_warps_;
+  std::map<ir::value*, unsigned> registers_;
+  unsigned max_live_;
+  std::set<ir::value*> peak_;
+};
+
+}
+}
+}
+
+#endif
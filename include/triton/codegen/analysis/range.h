@@ -0,0 +1,60 @@
+#ifndef TDL_INCLUDE_CODEGEN_RANGE_H
+#define TDL_INCLUDE_CODEGEN_RANGE_H
+
+#include <map>
+#include <cstdint>
+
+namespace triton {
+
+namespace ir {
+  class value;
+  class type;
+  class module;
+  class instruction;
+  class phi_node;
+  class binary_operator;
+  class icmp_inst;
+  class cast_inst;
+}
+
+namespace codegen{
+namespace analysis{
+
+// Conservative bounds of integer values. The bounds of a block hold for
+// all of its elements; booleans are in [0, 1].
+class range {
+public:
+  struct interval {
+    int64_t lo;
+    int64_t hi;
+    bool operator==(const interval &other) const { return lo == other.lo && hi == other.hi; }
+    bool operator!=(const interval &other) const { return !(*this == other); }
+  };
+
+private:
+  // helpers
+  interval get_full(ir::type *ty);
+  interval fit(interval x, ir::type *ty);
+  // transfer functions
+  interval populate_phi(ir::phi_node *x);
+  interval populate_binop(ir::binary_operator *x);
+  interval populate_icmp(ir::icmp_inst *x);
+  interval populate_cast(ir::cast_inst *x);
+  interval populate(ir::instruction *i);
+
+public:
+  void run(ir::module &mod);
+  interval get(ir::value *v);
+  // whether all elements of a boolean are known to be true (resp. false)
+  bool is_true(ir::value *v);
+  bool is_false(ir::value *v);
+
+private:
+  std::map<ir::value*, interval> ranges_;
+};
+
+}
+}
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 
 #include <memory>
+#include <string>
 
 namespace triton{
 
@@ -19,10 +20,41 @@ namespace driver{
 namespace triton{
 namespace codegen{
 
+class target;
+
+// Codegen passes run on a Triton-IR module. The results are kept so that
+// the register estimate and the machine code come from a single run.
+// The module must outlive this object.
+class lowering {
+  struct passes;
+
+public:
+  lowering(ir::module &ir, driver::device* dev, int num_warps, int num_stages, bool force_nc_cache);
+  ~lowering();
+  unsigned num_registers() const { return num_registers_; }
+  size_t shared_mem() const { return shared_mem_; }
+  // lowers the module to machine code; can only be called once
+  void emit_bin(driver::module*& mod, driver::kernel*& ker);
+  // lowers the module to LLVM-IR only, so that code generation can be
+  // checked for targets that cannot load the result; can only be called once
+  std::string llir();
+
+private:
+  ir::module &ir_;
+  driver::device *dev_;
+  std::unique_ptr<target> target_;
+  std::unique_ptr<passes> passes_;
+  size_t shared_mem_;
+  unsigned num_registers_;
+};
+
 // TODO:
 // There should be a proper pass manager there!
 void add_passes_to_emit_bin(ir::module &ir, driver::device* dev, int num_warps, int num_stages, bool force_nc_cache,
                             driver::module*& mod, driver::kernel*& ker, size_t& shared_mem);
+// runs the same passes without emitting machine code, and returns the
+// estimated number of registers per thread
+unsigned estimate_registers(ir::module &ir, driver::device* dev, int num_warps, int num_stages, size_t& shared_mem);
 
 
 }
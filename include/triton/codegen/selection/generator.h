@@ -61,6 +61,9 @@ typedef llvm::Constant Constant;
 typedef llvm::ArrayType ArrayType;
 typedef llvm::Function Function;
 typedef std::vector<Value*> indices_t;
+// accumulators of a reduction, combined together
+typedef std::vector<Value*> reduce_acc_t;
+typedef std::function<reduce_acc_t(const reduce_acc_t&, const reduce_acc_t&)> reduce_fn_t;
 class target;
 
 }
@@ -131,12 +134,12 @@ public:
   void visit_getelementptr_inst(ir::getelementptr_inst*);
   void visit_icmp_inst(ir::icmp_inst*);
   void visit_fcmp_inst(ir::fcmp_inst*);
-  std::tuple<Value*, Value*, Value*, Value*> fp8x4_to_fp32x4(Value *in0, Value *in1, Value *in2, Value *in3);
-  std::tuple<Value*, Value*, Value*, Value*> fp32x4_to_fp8x4(Value *in0, Value *in1, Value *in2, Value *in3);
-  std::tuple<Value*, Value*, Value*, Value*> fp8x4_to_fp16x4(Value *in0, Value *in1, Value *in2, Value *in3);
-  std::tuple<Value*, Value*, Value*, Value*> fp16x4_to_fp8x4(Value *in0, Value *in1, Value *in2, Value *in3);
-  Value* bf16_to_fp32(Value *in0);
-  Value* fp32_to_bf16(Value *in0);
+  // conversions of whole vectors of packed fp8 (i8) and bf16 (i16)
+  Value* fp8_to_fp16(Value *in);
+  Value* fp16_to_fp8(Value *in);
+  Value* fp32_to_fp8(Value *in);
+  Value* bf16_to_fp32(Value *in);
+  Value* fp32_to_bf16(Value *in);
 
   void visit_cast_inst(ir::cast_inst*);
   void visit_return_inst(ir::return_inst*);
@@ -162,14 +165,24 @@ public:
   void visit_atomic_rmw_inst(ir::atomic_rmw_inst*);
   void visit_mma884(ir::dot_inst*, ir::value *A, ir::value *B, ir::value *D, unsigned NK);
   void visit_mma16816(ir::dot_inst*, ir::value *A, ir::value *B, ir::value *D, unsigned NK);
+  void visit_mma_b32(ir::dot_inst*, ir::value *A, ir::value *B, ir::value *D, unsigned NK);
   void visit_fmadot(ir::dot_inst*, ir::value *A, ir::value *B, ir::value *D, unsigned NK, Type *c_ty, Function *f_mul_add);
+  void visit_imadot(ir::dot_inst*, ir::value *A, ir::value *B, ir::value *D, unsigned NK, Type *c_ty);
   void visit_dot_inst(ir::dot_inst*);
   void visit_trans_inst(ir::trans_inst*);
   void visit_sqrt_inst(ir::sqrt_inst*);
+  Value* shfl(Value* acc, Value* i, const std::string& mode, int clamp);
   Value* shfl_sync(Value* acc, int32_t i);
-  void visit_reduce1d_inst(ir::reduce_inst*, std::function<Value*(Value*,Value*)>, Value*);
-  void visit_reducend_inst(ir::reduce_inst*, std::function<Value*(Value*,Value*)>, Value*);
+  std::vector<Value*> shfl_sync(const std::vector<Value*>& acc, int32_t i);
+  Value* shfl_up(Value* acc, int32_t i);
+  Value* shfl_idx(Value* acc, Value* lane);
+  void visit_reducend_inst(const std::vector<ir::reduce_inst*>&, const std::vector<reduce_fn_t>&);
+  reduce_fn_t get_reduce_fn(ir::reduce_inst*);
+  Value* fast_exp(Value *x);
+  Value* fast_log(Value *x);
   void visit_reduce_inst(ir::reduce_inst*);
+  void visit_scan_inst(ir::scan_inst*);
+  void visit_sort_inst(ir::sort_inst*);
   void visit_select_inst(ir::select_inst*);
   void visit_layout_convert(ir::value *out, ir::value *in);
   void visit_cvt_layout_inst(ir::cvt_layout_inst*);
@@ -0,0 +1,52 @@
+#ifndef TRITON_INCLUDE_IR_CODEGEN_GVN_H
+#define TRITON_INCLUDE_IR_CODEGEN_GVN_H
+
+#include <map>
+#include <vector>
+#include <tuple>
+#include <string>
+
+// forward declaration
+namespace triton {
+namespace ir {
+class module;
+class value;
+class type;
+class instruction;
+class basic_block;
+}
+} // namespace triton
+
+namespace triton {
+namespace codegen {
+namespace transform {
+
+// Dominator-based value numbering: a side-effect-free instruction is
+// replaced by an equivalent instruction that dominates it.
+class gvn {
+  // opcode, result type, repr (carries predicates/cast ops/...), operands, other attributes
+  typedef std::tuple<unsigned, ir::type*, std::string, std::vector<ir::value*>, std::vector<int>> key_t;
+  typedef std::map<key_t, ir::instruction*> table_t;
+  typedef std::map<ir::basic_block*, std::vector<ir::basic_block*>> dom_tree_t;
+
+private:
+  bool get_key(ir::instruction *i, key_t &key);
+  void visit(ir::basic_block *block, const dom_tree_t &children, table_t &table);
+
+public:
+  gvn() {}
+  void run(ir::module &mod);
+  // statistics of the last run
+  unsigned num_removed() const { return num_removed_; }
+  unsigned num_removed_elements() const { return num_removed_elements_; }
+
+private:
+  unsigned num_removed_;
+  unsigned num_removed_elements_;
+};
+
+} // namespace transform
+} // namespace codegen
+} // namespace triton
+
+#endif
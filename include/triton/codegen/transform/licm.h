@@ -0,0 +1,56 @@
+#ifndef TRITON_INCLUDE_IR_CODEGEN_LICM_H
+#define TRITON_INCLUDE_IR_CODEGEN_LICM_H
+
+#include <set>
+#include <vector>
+
+// forward declaration
+namespace triton {
+namespace ir {
+class module;
+class function;
+class value;
+class argument;
+class instruction;
+class basic_block;
+class builder;
+}
+} // namespace triton
+
+namespace triton {
+namespace codegen {
+namespace transform {
+
+// Hoists loop-invariant computations into loop pre-headers.
+// Loads are hoisted when they execute on every iteration and no store in
+// the loop may write to their memory; they are then predicated on the
+// loop-entry condition so that zero-trip loops do not access memory.
+class licm {
+  struct loop_t {
+    ir::basic_block *header;
+    ir::basic_block *preheader;
+    std::set<ir::basic_block*> blocks;
+  };
+
+private:
+  std::vector<loop_t> get_loops(ir::function *fn);
+  bool is_invariant(ir::instruction *i, const loop_t &loop);
+  bool can_hoist_load(ir::instruction *i, const loop_t &loop, ir::function *fn);
+  void hoist_load(ir::instruction *i, const loop_t &loop, ir::builder &builder);
+  void run(ir::function *fn, const loop_t &loop, ir::builder &builder);
+
+public:
+  licm() {}
+  void run(ir::module &mod);
+  // statistics of the last run
+  unsigned num_hoisted() const { return num_hoisted_; }
+
+private:
+  unsigned num_hoisted_;
+};
+
+} // namespace transform
+} // namespace codegen
+} // namespace triton
+
+#endif
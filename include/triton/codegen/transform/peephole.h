@@ -18,6 +18,7 @@ namespace ir {
 namespace codegen{
 namespace analysis{
 class layouts;
+class range;
 }
 
 namespace transform{
@@ -35,14 +36,21 @@ private:
   bool rewrite_select_masked_load(ir::instruction *value, ir::builder& builder);
   bool rewrite_load_to_shared(ir::instruction *value, ir::builder& builder);
   bool rewrite_cvt_layout(ir::instruction *value, ir::builder& builder);
+  bool rewrite_masked_load(ir::instruction *value, ir::builder& builder);
+  bool rewrite_masked_store(ir::instruction *value, ir::builder& builder);
 
 public:
-  peephole(target* tgt, analysis::layouts* layouts): tgt_(tgt), layouts_(layouts) {}
+  peephole(target* tgt, analysis::layouts* layouts, analysis::range* range)
+    : tgt_(tgt), layouts_(layouts), range_(range), num_masks_removed_(0) {}
   void run(ir::module &mod);
+  // number of masks proven to be constant so far
+  unsigned num_masks_removed() const { return num_masks_removed_; }
 
 private:
   target* tgt_;
   analysis::layouts* layouts_;
+  analysis::range* range_;
+  unsigned num_masks_removed_;
 };
 
 
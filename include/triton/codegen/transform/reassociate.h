@@ -0,0 +1,39 @@
+#ifndef TDL_INCLUDE_CODEGEN_REASSOCIATE_H
+#define TDL_INCLUDE_CODEGEN_REASSOCIATE_H
+
+namespace triton {
+
+namespace ir {
+  class module;
+  class value;
+  class builder;
+  class getelementptr_inst;
+}
+
+namespace codegen{
+namespace transform{
+
+// Reassociates the indices of block pointers so that the part that is the
+// same for all elements is computed once on scalars:
+//   gep(splat(ptr), splat(u) + v) -> gep(splat(gep(ptr, u)), v)
+class reassociate {
+private:
+  void classify(ir::value *x, bool &has_uniform, bool &has_varying);
+  void split(ir::value *x, ir::builder &builder, ir::value *&uniform, ir::value *&varying);
+  bool rewrite(ir::getelementptr_inst *x, ir::builder &builder);
+
+public:
+  reassociate() {}
+  void run(ir::module &mod);
+  // statistics of the last run
+  unsigned num_rewritten() const { return num_rewritten_; }
+
+private:
+  unsigned num_rewritten_;
+};
+
+}
+}
+}
+
+#endif
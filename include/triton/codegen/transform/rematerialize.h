@@ -0,0 +1,51 @@
+#ifndef TRITON_INCLUDE_IR_CODEGEN_REMATERIALIZE_H
+#define TRITON_INCLUDE_IR_CODEGEN_REMATERIALIZE_H
+
+#include <map>
+
+// forward declaration
+namespace triton {
+namespace ir {
+class module;
+class value;
+class instruction;
+class builder;
+}
+namespace codegen {
+namespace analysis {
+class pressure;
+}
+}
+} // namespace triton
+
+namespace triton {
+namespace codegen {
+namespace transform {
+
+// When the estimated register pressure exceeds what a thread can hold,
+// recomputes cheap blocks (ranges, splats, broadcasts and the address
+// tiles built from them) next to their uses instead of keeping them live.
+class rematerialize {
+private:
+  bool is_cheap(ir::value *v, unsigned &cost);
+  ir::value* clone(ir::value *v, ir::builder &builder, std::map<ir::value*, ir::value*> &clones);
+
+public:
+  rematerialize(analysis::pressure *pressure, int num_warps): pressure_(pressure), num_warps_(num_warps) {}
+  void run(ir::module &mod);
+  // registers available to each thread
+  unsigned max_registers() const;
+  // statistics of the last run
+  unsigned num_rematerialized() const { return num_rematerialized_; }
+
+private:
+  analysis::pressure *pressure_;
+  int num_warps_;
+  unsigned num_rematerialized_;
+};
+
+} // namespace transform
+} // namespace codegen
+} // namespace triton
+
+#endif
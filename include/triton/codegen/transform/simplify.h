@@ -0,0 +1,54 @@
+#ifndef TRITON_INCLUDE_IR_CODEGEN_SIMPLIFY_H
+#define TRITON_INCLUDE_IR_CODEGEN_SIMPLIFY_H
+
+#include <vector>
+
+// forward declaration
+namespace triton {
+namespace ir {
+class module;
+class value;
+class instruction;
+class builder;
+}
+} // namespace triton
+
+namespace triton {
+namespace codegen {
+namespace transform {
+
+// Constant folding and algebraic simplification. Each rule returns a value
+// equivalent to the instruction it is given, or nullptr if it does not apply.
+class simplify {
+  typedef ir::value* (simplify::*rule_t)(ir::instruction *i, ir::builder &builder);
+
+private:
+  // binary_operator
+  ir::value* fold_binop(ir::instruction *i, ir::builder &builder);
+  ir::value* splat_binop(ir::instruction *i, ir::builder &builder);
+  ir::value* simplify_binop(ir::instruction *i, ir::builder &builder);
+  // cast_inst
+  ir::value* fold_cast(ir::instruction *i, ir::builder &builder);
+  ir::value* splat_cast(ir::instruction *i, ir::builder &builder);
+  ir::value* simplify_cast(ir::instruction *i, ir::builder &builder);
+  // retile_inst
+  ir::value* simplify_retile(ir::instruction *i, ir::builder &builder);
+  // select_inst
+  ir::value* simplify_select(ir::instruction *i, ir::builder &builder);
+
+public:
+  simplify() {}
+  void run(ir::module &mod);
+  // statistics of the last run
+  unsigned num_simplified() const { return num_simplified_; }
+
+private:
+  static const std::vector<rule_t> rules_;
+  unsigned num_simplified_;
+};
+
+} // namespace transform
+} // namespace codegen
+} // namespace triton
+
+#endif
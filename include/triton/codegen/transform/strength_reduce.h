@@ -0,0 +1,44 @@
+#ifndef TRITON_INCLUDE_IR_CODEGEN_STRENGTH_REDUCE_H
+#define TRITON_INCLUDE_IR_CODEGEN_STRENGTH_REDUCE_H
+
+#include <map>
+
+// forward declaration
+namespace triton {
+namespace ir {
+class module;
+class phi_node;
+class basic_block;
+class builder;
+}
+} // namespace triton
+
+namespace triton {
+namespace codegen {
+namespace transform {
+
+// Rewrites block-pointer induction variables of the form
+//   P = phi(gep(splat(A), offs), gep(P, splat(step)))
+// into a scalar pointer induction variable and a loop-invariant offset tile
+//   p = phi(A, gep(p, step)) ; P = gep(splat(p), offs)
+// so that the loop only carries (and updates) one scalar pointer.
+class strength_reduce {
+private:
+  bool rewrite(ir::phi_node *phi, ir::builder &builder,
+               const std::map<ir::basic_block*, ir::basic_block*> &idom);
+
+public:
+  strength_reduce() {}
+  void run(ir::module &mod);
+  // statistics of the last run
+  unsigned num_rewritten() const { return num_rewritten_; }
+
+private:
+  unsigned num_rewritten_;
+};
+
+} // namespace transform
+} // namespace codegen
+} // namespace triton
+
+#endif
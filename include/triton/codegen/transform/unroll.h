@@ -0,0 +1,49 @@
+#ifndef TRITON_INCLUDE_IR_CODEGEN_UNROLL_H
+#define TRITON_INCLUDE_IR_CODEGEN_UNROLL_H
+
+#include <map>
+#include <cstdint>
+
+// forward declaration
+namespace triton {
+namespace ir {
+class module;
+class value;
+class basic_block;
+class cond_branch_inst;
+}
+} // namespace triton
+
+namespace triton {
+namespace codegen {
+namespace transform {
+
+// Unrolls single-block loops whose trip count is a compile-time constant.
+// Loops are fully unrolled when the result fits in `max_size` instructions,
+// and partially unrolled by the largest factor (up to `max_factor`) that
+// divides the trip count otherwise.
+class unroll {
+  typedef std::map<ir::value*, int64_t> env_t;
+
+private:
+  bool evaluate(ir::value *v, const env_t &env, int64_t &res);
+  int get_trip_count(ir::basic_block *block, ir::basic_block *header,
+                     ir::cond_branch_inst *br);
+  void do_unroll(ir::basic_block *block, ir::basic_block *header,
+                 ir::cond_branch_inst *br, unsigned factor, bool full);
+
+public:
+  unroll(unsigned max_size = 256, unsigned max_factor = 4)
+      : max_size_(max_size), max_factor_(max_factor) {}
+  void run(ir::module &mod);
+
+private:
+  unsigned max_size_;
+  unsigned max_factor_;
+};
+
+} // namespace transform
+} // namespace codegen
+} // namespace triton
+
+#endif
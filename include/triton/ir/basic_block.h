@@ -17,6 +17,8 @@ class instruction;
 
 /* Basic Block */
 class basic_block: public value{
+  friend class function;
+
 public:
   // instruction iterator types
   typedef std::list<instruction*>                inst_list_t;
@@ -64,6 +66,7 @@ public:
   const std::vector<basic_block*>& get_predecessors() const { return preds_; }
   const std::vector<basic_block*>& get_successors() const { return succs_; }
   void add_predecessor(basic_block* pred);
+  void remove_predecessor(basic_block* pred);
 
   // factory functions
   static basic_block* create(context &ctx, const std::string &name, function *parent);
@@ -72,6 +75,7 @@ public:
 
   // visitor
   void accept(visitor *v) { v->visit_basic_block(this); }
+  static bool classof(const value *v) { return v->get_id() == VALUE_BASIC_BLOCK; }
 
 private:
   context &ctx_;
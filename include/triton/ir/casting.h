@@ -0,0 +1,54 @@
+#pragma once
+
+#ifndef _TRITON_IR_CASTING_H_
+#define _TRITON_IR_CASTING_H_
+
+#include <cassert>
+#include <type_traits>
+
+namespace triton{
+namespace ir{
+
+//===----------------------------------------------------------------------===//
+//                        isa / cast / dyn_cast
+//===----------------------------------------------------------------------===//
+//
+// LLVM-style RTTI for Triton-IR values. Each class in the value hierarchy
+// provides a `static bool classof(const value*)` predicate that inspects
+// the value id, so that classification never goes through dynamic_cast.
+//
+
+template<class To, class From>
+inline bool isa(const From *v) {
+  assert(v && "isa<> used on a null pointer");
+  return To::classof(v);
+}
+
+template<class To, class From>
+inline bool isa_and_nonnull(const From *v) {
+  return v && To::classof(v);
+}
+
+template<class To, class From>
+inline typename std::conditional<std::is_const<From>::value, const To*, To*>::type
+cast(From *v) {
+  assert(isa<To>(v) && "cast<Ty>() argument of incompatible type!");
+  return static_cast<typename std::conditional<std::is_const<From>::value, const To*, To*>::type>(v);
+}
+
+template<class To, class From>
+inline typename std::conditional<std::is_const<From>::value, const To*, To*>::type
+dyn_cast(From *v) {
+  return isa<To>(v) ? cast<To>(v) : nullptr;
+}
+
+template<class To, class From>
+inline typename std::conditional<std::is_const<From>::value, const To*, To*>::type
+dyn_cast_or_null(From *v) {
+  return (v && isa<To>(v)) ? cast<To>(v) : nullptr;
+}
+
+}
+}
+
+#endif
@@ -23,6 +23,7 @@ public:
   static constant* get_all_ones_value(type *ty);
   static constant* get_null_value(type *ty);
   virtual std::string repr() const = 0;
+  static bool classof(const value *v) { return v->get_id() >= VALUE_UNDEF && v->get_id() <= VALUE_FUNCTION; }
 };
 
 /* Undef value */
@@ -34,6 +35,7 @@ public:
   static undef_value* get(type* ty);
   std::string repr() const { return "undef"; }
   void accept(visitor* vst) { vst->visit_undef_value(this); }
+  static bool classof(const value *v) { return v->get_id() == VALUE_UNDEF; }
 };
 
 
@@ -47,6 +49,7 @@ public:
   static constant_int *get(type *ty, uint64_t value);
   std::string repr() const { return std::to_string(value_); }
   void accept(visitor* vst) { vst->visit_constant_int(this); }
+  static bool classof(const value *v) { return v->get_id() == VALUE_CONSTANT_INT; }
 
 protected:
   uint64_t value_;
@@ -64,6 +67,7 @@ public:
   static constant* get(type *ty, double v);
   std::string repr() const { return std::to_string(value_); }
   void accept(visitor* vst) { vst->visit_constant_fp(this); }
+  static bool classof(const value *v) { return v->get_id() == VALUE_CONSTANT_FP; }
 
 private:
   double value_;
@@ -78,10 +82,12 @@ public:
   };
 
 public:
-  global_value(type *ty, unsigned num_ops,
+  global_value(type *ty, value_id_t id, unsigned num_ops,
                linkage_types_t linkage, const std::string &name,
                unsigned addr_space);
   std::string repr() const { return get_name(); }
+  linkage_types_t get_linkage() const { return linkage_; }
+  static bool classof(const value *v) { return v->get_id() == VALUE_ALLOC_CONST || v->get_id() == VALUE_FUNCTION; }
 
 private:
   linkage_types_t linkage_;
@@ -90,10 +96,11 @@ private:
 /* global object */
 class global_object: public global_value {
 public:
-  global_object(type *ty, unsigned num_ops,
+  global_object(type *ty, value_id_t id, unsigned num_ops,
                linkage_types_t linkage, const std::string &name,
                unsigned addr_space = 0);
   std::string repr() const { return get_name(); }
+  static bool classof(const value *v) { return v->get_id() == VALUE_ALLOC_CONST || v->get_id() == VALUE_FUNCTION; }
 };
 
 /* global variable */
@@ -103,6 +110,7 @@ public:
               const std::string &name = "");
   std::string repr() const { return get_name(); }
   void accept(visitor* vst) { vst->visit_alloc_const(this); }
+  static bool classof(const value *v) { return v->get_id() == VALUE_ALLOC_CONST; }
 
 
 };
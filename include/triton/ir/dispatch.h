@@ -67,8 +67,10 @@ struct dispatch{
   static ir::value *cast(ir::value *input, ir::type *type, ir::builder *builder);
 
   // memory operators
-  static ir::value *load(ir::value* ptr, ir::value* mask, ir::value* other, ir::builder *builder);
-  static ir::value *store(ir::value* ptr, ir::value *value, ir::value *mask, ir::builder *builder);
+  static ir::value *load(ir::value* ptr, ir::value* mask, ir::value* other, const std::string &cache_modifier,
+                         const std::string &eviction_policy, bool is_volatile, ir::builder *builder);
+  static ir::value *store(ir::value* ptr, ir::value *value, ir::value *mask, const std::string &cache_modifier,
+                          const std::string &eviction_policy, bool is_volatile, ir::builder *builder);
   static ir::value *atomic_cas(ir::value* ptr, ir::value *cmp, ir::value *val, ir::builder *builder);
   static ir::value *atomic_add(ir::value* ptr, ir::value *val, ir::value *msk, ir::builder *builder);
   static ir::value *atomic_max(ir::value* ptr, ir::value *val, ir::value *msk, ir::builder *builder);
@@ -79,7 +81,7 @@ struct dispatch{
   static ir::value *atomic_xchg(ir::value* ptr, ir::value *val, ir::value *msk, ir::builder *builder);
 
   // linear algebra
-  static ir::value *dot(ir::value *lhs, ir::value *rhs, ir::builder *builder);
+  static ir::value *dot(ir::value *lhs, ir::value *rhs, bool allow_tf32, ir::builder *builder);
 
   // indexing
   static ir::value *where(ir::value* condition, ir::value *x, ir::value *y, ir::builder *builder);
@@ -88,6 +90,19 @@ struct dispatch{
   static ir::value *min(ir::value *input, unsigned int axis, ir::builder *builder);
   static ir::value *max(ir::value *input, unsigned int axis, ir::builder *builder);
   static ir::value *sum(ir::value *input, unsigned int axis, ir::builder *builder);
+  static ir::value *argmin(ir::value *input, unsigned int axis, ir::builder *builder);
+  static ir::value *argmax(ir::value *input, unsigned int axis, ir::builder *builder);
+  static ir::value *logsumexp(ir::value *input, unsigned int axis, ir::builder *builder);
+
+  // scan
+  static ir::value *cumsum(ir::value *input, unsigned int axis, ir::builder *builder);
+  static ir::value *cumprod(ir::value *input, unsigned int axis, ir::builder *builder);
+  static ir::value *cummax(ir::value *input, unsigned int axis, ir::builder *builder);
+  static ir::value *cummin(ir::value *input, unsigned int axis, ir::builder *builder);
+
+  // sorting
+  static ir::value *sort(ir::value *input, unsigned int axis, bool descending, ir::builder *builder);
+  static ir::value *topk(ir::value *input, unsigned int k, unsigned int axis, ir::builder *builder);
 
   // math
   static ir::value *exp(ir::value *x, ir::builder *builder);
@@ -100,6 +115,10 @@ struct dispatch{
   static ir::value *multiple_of(ir::value *x, int value, ir::builder *builder);
   static ir::value *max_contiguous(ir::value *x, int value, ir::builder *builder);
   static ir::value *debug_barrier(ir::builder *builder);
+
+  // batched frontends: value-only operations, addressed by their index in `batched_ops`
+  static const std::vector<std::string> &batched_ops();
+  static ir::value *batched(unsigned opcode, const std::vector<ir::value*> &args, ir::builder *builder);
 };
 
 }
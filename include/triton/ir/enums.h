@@ -149,6 +149,8 @@ enum value_id_t: unsigned {
   // array arithmetic
   INST_TRANS,
   INST_REDUCE,
+  INST_SCAN,
+  INST_SORT,
   INST_DOT,
   // intrinsics
   INST_COPY_TO_SHARED,
@@ -163,6 +165,20 @@ enum value_id_t: unsigned {
   INST_MAKE_RANGE_STA,
   INST_MAKE_RANGE,
   INST_PREFETCH_S,
+  INST_END,
+  /* ------------ *
+       CONSTANTS
+   * ------------ */
+  VALUE_UNDEF,
+  VALUE_CONSTANT_INT,
+  VALUE_CONSTANT_FP,
+  VALUE_ALLOC_CONST,
+  VALUE_FUNCTION,
+  /* ------------ *
+        OTHERS
+   * ------------ */
+  VALUE_ARGUMENT,
+  VALUE_BASIC_BLOCK
 };
 
 
@@ -27,6 +27,7 @@ public:
   unsigned get_arg_no() const;
 
   void accept(visitor *v);
+  static bool classof(const value *v) { return v->get_id() == VALUE_ARGUMENT; }
 
 private:
   function *parent_;
@@ -111,6 +112,9 @@ public:
   // factory methods
   static function *create(function_type *ty, linkage_types_t linkage,
                           const std::string &name, module *mod);
+  // cloning
+  function *clone(module *parent, std::map<value*, value*> &vmap);
+  function *clone(module *parent);
   // blocks
   const blocks_t &blocks() { return blocks_; }
   const blocks_t &blocks() const { return blocks_; }
@@ -126,6 +130,7 @@ public:
 
   // visitor
   void accept(visitor *v) { v->visit_function(this); }
+  static bool classof(const value *v) { return v->get_id() == VALUE_FUNCTION; }
 
 private:
   module *parent_;
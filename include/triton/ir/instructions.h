@@ -61,6 +61,7 @@ public:
   void set_metadata(ir::metadata::kind_t kind,
                     unsigned value)                           { metadatas_[kind] = value;}
   unsigned get_metadata(ir::metadata::kind_t kind)            { return metadatas_[kind];}
+  void copy_metadata_from(const instruction *other)           { metadatas_ = other->metadatas_; }
   // cloning
   ir::instruction* clone() {
     ir::instruction* res = clone_impl();
@@ -70,15 +71,14 @@ public:
     res->users_.clear();
     return res;
   }
-  // instruction id
-  value_id_t get_id() const { return id_; }
-
   void print(std::ostream &os);
 
 private:
   basic_block *parent_;
   std::map<ir::metadata::kind_t, unsigned> metadatas_;
-  value_id_t id_;
+
+public:
+  static bool classof(const value *v) { return v->get_id() > INST_BEGIN && v->get_id() < INST_END; }
 };
 
 
@@ -112,6 +112,9 @@ public:
 private:
   unsigned num_reserved_;
   std::vector<basic_block*> blocks_;
+
+public:
+  static bool classof(const value *v) { return v->get_id() == INST_PHI; }
 };
 
 //===----------------------------------------------------------------------===//
@@ -163,6 +166,7 @@ public:
   binary_op_t op_;
   bool has_no_unsigned_wrap_;
   bool has_no_signed_wrap_;
+  static bool classof(const value *v) { return v->get_id() == INST_BINOP; }
 };
 
 
@@ -189,6 +193,9 @@ public:
 
 private:
   cmp_pred_t pred_;
+
+public:
+  static bool classof(const value *v) { return v->get_id() == INST_ICMP || v->get_id() == INST_FCMP; }
 };
 
 class icmp_inst: public cmp_inst {
@@ -200,6 +207,7 @@ public:
                     const std::string &name = "", instruction *next = nullptr);
   _TRITON_DEFINE_CLONE(icmp_inst)
   _TRITON_DEFINE_ACCEPT(icmp_inst)
+  static bool classof(const value *v) { return v->get_id() == INST_ICMP; }
 };
 
 class fcmp_inst: public cmp_inst {
@@ -211,6 +219,7 @@ public:
                     const std::string &name = "", instruction *next = nullptr);
   _TRITON_DEFINE_CLONE(fcmp_inst)
   _TRITON_DEFINE_ACCEPT(fcmp_inst)
+  static bool classof(const value *v) { return v->get_id() == INST_FCMP; }
 };
 
 //===----------------------------------------------------------------------===//
@@ -220,6 +229,17 @@ public:
 class unary_inst: public instruction {
 protected:
   unary_inst(type *ty, value_id_t id, value *v, const std::string &name, instruction *next);
+
+public:
+  static bool classof(const value *v) {
+    switch(v->get_id()){
+    case INST_RESHAPE: case INST_SPLAT: case INST_BROADCAST: case INST_DOWNCAST:
+    case INST_COPY_TO_SHARED: case INST_COPY_FROM_SHARED: case INST_CVT_LAYOUT:
+      return true;
+    default:
+      return v->get_id() >= INST_CAST_TRUNC && v->get_id() <= INST_CAST_ADDR_SPACE_CAST;
+    }
+  }
 };
 
 
@@ -252,6 +272,9 @@ public:
 
 private:
   cast_op_t op_;
+
+public:
+  static bool classof(const value *v) { return v->get_id() >= INST_CAST_TRUNC && v->get_id() <= INST_CAST_ADDR_SPACE_CAST; }
 };
 
 #define TRITON_IR_DECLARE_CAST_INST_SIMPL(name, id, op) \
@@ -260,6 +283,8 @@ class name : public cast_inst { \
   friend class cast_inst; \
   name(type *ty, value *v, const std::string &name, instruction *next) \
     : cast_inst(ty, id, v, name, next, op){ } \
+public: \
+  static bool classof(const value *v) { return v->get_id() == id; } \
 };
 
 TRITON_IR_DECLARE_CAST_INST_SIMPL(trunc_inst, INST_CAST_TRUNC, cast_op_t::Trunc)
@@ -282,6 +307,9 @@ TRITON_IR_DECLARE_CAST_INST_SIMPL(addr_space_cast_inst, INST_CAST_ADDR_SPACE_CAS
 
 class terminator_inst: public instruction{
   using instruction::instruction;
+
+public:
+  static bool classof(const value *v) { return v->get_id() >= INST_RETURN && v->get_id() <= INST_UNCOND_BRANCH; }
 };
 
 // return instruction
@@ -302,6 +330,7 @@ public:
 
   _TRITON_DEFINE_CLONE(return_inst)
   _TRITON_DEFINE_ACCEPT(return_inst)
+  static bool classof(const value *v) { return v->get_id() == INST_RETURN; }
 };
 
 // base branch instruction
@@ -317,6 +346,7 @@ public:
                              instruction *next = nullptr);
   static branch_inst* create(value *cond, basic_block *if_dest, basic_block *else_dest,
                              instruction *next = nullptr);
+  static bool classof(const value *v) { return v->get_id() == INST_COND_BRANCH || v->get_id() == INST_UNCOND_BRANCH; }
 };
 
 // conditional branch
@@ -331,6 +361,7 @@ public:
   value *get_cond()             { return get_operand(2); }
   _TRITON_DEFINE_CLONE(cond_branch_inst)
   _TRITON_DEFINE_ACCEPT(cond_branch_inst)
+  static bool classof(const value *v) { return v->get_id() == INST_COND_BRANCH; }
 };
 
 // unconditional branch
@@ -343,6 +374,7 @@ public:
   basic_block *get_dest()  { return (basic_block*)get_operand(0); }
   _TRITON_DEFINE_CLONE(uncond_branch_inst)
   _TRITON_DEFINE_ACCEPT(uncond_branch_inst)
+  static bool classof(const value *v) { return v->get_id() == INST_UNCOND_BRANCH; }
 };
 
 
@@ -376,6 +408,9 @@ public:
 private:
   type *source_elt_ty;
   type *res_elt_ty;
+
+public:
+  static bool classof(const value *v) { return v->get_id() == INST_GETELEMENTPTR; }
 };
 
 //===----------------------------------------------------------------------===//
@@ -383,6 +418,24 @@ private:
 //===----------------------------------------------------------------------===//
 
 class io_inst: public instruction {
+public:
+  // cache operators (PTX `ld.ca`/`ld.cg`/`ld.cs`/`ld.lu`/`ld.cv`, `st.wb`/`st.cg`/`st.cs`/`st.wt`)
+  enum CACHE_MODIFIER {
+    NONE = 0,
+    CA,
+    CG,
+    CS,
+    LU,
+    CV,
+    WB,
+    WT
+  };
+  enum EVICTION_POLICY {
+    NORMAL = 0,
+    EVICT_FIRST,
+    EVICT_LAST
+  };
+
 protected:
   io_inst(type *ty, value_id_t id, unsigned num_ops,
           const std::string &name = "", instruction *next = nullptr);
@@ -390,6 +443,17 @@ protected:
 public:
   // accessors
   value *get_pointer_operand() { return get_operand(0); }
+  // hints, carried as metadata
+  CACHE_MODIFIER get_cache_modifier()   { return (CACHE_MODIFIER)get_metadata(metadata::cache_modifier); }
+  EVICTION_POLICY get_eviction_policy() { return (EVICTION_POLICY)get_metadata(metadata::eviction_policy); }
+  bool get_is_volatile()                { return get_metadata(metadata::is_volatile); }
+  void set_cache_modifier(CACHE_MODIFIER x)   { set_metadata(metadata::cache_modifier, x); }
+  void set_eviction_policy(EVICTION_POLICY x) { set_metadata(metadata::eviction_policy, x); }
+  void set_is_volatile(bool x)                { set_metadata(metadata::is_volatile, x); }
+  static bool classof(const value *v) {
+    return (v->get_id() >= INST_UNMASKED_LOAD && v->get_id() <= INST_MASKED_STORE) ||
+           (v->get_id() >= INST_ATOMIC_CAS && v->get_id() <= INST_ATOMIC_RMW);
+  }
 };
 
 // load
@@ -400,6 +464,9 @@ protected:
 
 private:
   static type *get_pointee_type(type *ty);
+
+public:
+  static bool classof(const value *v) { return v->get_id() >= INST_UNMASKED_LOAD && v->get_id() <= INST_MASKED_LOAD_ASYNC; }
 };
 
 // unmasked load
@@ -414,6 +481,7 @@ public:
                                     instruction *next = nullptr);
   _TRITON_DEFINE_CLONE(unmasked_load_inst)
   _TRITON_DEFINE_ACCEPT(unmasked_load_inst)
+  static bool classof(const value *v) { return v->get_id() == INST_UNMASKED_LOAD; }
 };
 
 // masked load
@@ -433,6 +501,7 @@ public:
                                   instruction *next = nullptr);
   _TRITON_DEFINE_CLONE(masked_load_inst)
   _TRITON_DEFINE_ACCEPT(masked_load_inst)
+  static bool classof(const value *v) { return v->get_id() == INST_MASKED_LOAD; }
 };
 
 // masked load async
@@ -452,6 +521,7 @@ public:
                                   instruction *next = nullptr);
   _TRITON_DEFINE_CLONE(masked_load_async_inst)
   _TRITON_DEFINE_ACCEPT(masked_load_async_inst)
+  static bool classof(const value *v) { return v->get_id() == INST_MASKED_LOAD_ASYNC; }
 };
 
 
@@ -464,6 +534,7 @@ protected:
 
 public:
   value *get_value_operand() { return get_operand(1); }
+  static bool classof(const value *v) { return v->get_id() == INST_UNMASKED_STORE || v->get_id() == INST_MASKED_STORE; }
 };
 
 // unmasked_store
@@ -479,6 +550,7 @@ public:
                                     instruction *next = nullptr);
   _TRITON_DEFINE_CLONE(unmasked_store_inst)
   _TRITON_DEFINE_ACCEPT(unmasked_store_inst)
+  static bool classof(const value *v) { return v->get_id() == INST_UNMASKED_STORE; }
 };
 
 class masked_store_inst: public store_inst{
@@ -496,6 +568,7 @@ public:
                                    instruction *next = nullptr);
   _TRITON_DEFINE_CLONE(masked_store_inst)
   _TRITON_DEFINE_ACCEPT(masked_store_inst)
+  static bool classof(const value *v) { return v->get_id() == INST_MASKED_STORE; }
 };
 
 //===----------------------------------------------------------------------===//
@@ -507,6 +580,9 @@ public:
 class retile_inst: public unary_inst {
 protected:
   retile_inst(value *arg, value_id_t id, const type::block_shapes_t &shapes, const std::string &name, instruction *next);
+
+public:
+  static bool classof(const value *v) { return v->get_id() >= INST_RESHAPE && v->get_id() <= INST_BROADCAST; }
 };
 
 // reshape
@@ -521,6 +597,7 @@ public:
                       const std::string &name = "", instruction *next = nullptr);
   _TRITON_DEFINE_CLONE(reshape_inst)
   _TRITON_DEFINE_ACCEPT(reshape_inst)
+  static bool classof(const value *v) { return v->get_id() == INST_RESHAPE; }
 };
 
 // splat
@@ -535,6 +612,7 @@ public:
                       const std::string &name = "", instruction *next = nullptr);
   _TRITON_DEFINE_CLONE(splat_inst)
   _TRITON_DEFINE_ACCEPT(splat_inst)
+  static bool classof(const value *v) { return v->get_id() == INST_SPLAT; }
 };
 
 // broadcast
@@ -549,6 +627,7 @@ public:
                       const std::string &name = "", instruction *next = nullptr);
   _TRITON_DEFINE_CLONE(broadcast_inst)
   _TRITON_DEFINE_ACCEPT(broadcast_inst)
+  static bool classof(const value *v) { return v->get_id() == INST_BROADCAST; }
 };
 
 
@@ -563,6 +642,7 @@ public:
   static instruction* create(value *arg, const std::string &name = "", instruction *next = nullptr);
   _TRITON_DEFINE_CLONE(downcast_inst)
   _TRITON_DEFINE_ACCEPT(downcast_inst)
+  static bool classof(const value *v) { return v->get_id() == INST_DOWNCAST; }
 };
 
 //===----------------------------------------------------------------------===//
@@ -572,6 +652,19 @@ public:
 class builtin_inst: public instruction{
 protected:
   using instruction::instruction;
+
+public:
+  static bool classof(const value *v) {
+    switch(v->get_id()){
+    case INST_GET_PROGRAM_ID: case INST_GET_NUM_PROGRAMS:
+    case INST_EXP: case INST_COS: case INST_SIN: case INST_LOG:
+    case INST_TRANS: case INST_REDUCE: case INST_SCAN: case INST_SORT: case INST_DOT:
+    case INST_SQRT: case INST_SELECT:
+      return true;
+    default:
+      return false;
+    }
+  }
 };
 
 class get_program_id_inst: public builtin_inst {
@@ -587,6 +680,9 @@ public:
 
 private:
   unsigned axis_;
+
+public:
+  static bool classof(const value *v) { return v->get_id() == INST_GET_PROGRAM_ID; }
 };
 
 class get_num_programs_inst: public builtin_inst {
@@ -602,12 +698,16 @@ public:
 
 private:
   unsigned axis_;
+
+public:
+  static bool classof(const value *v) { return v->get_id() == INST_GET_NUM_PROGRAMS; }
 };
 
 
 class atomic_inst: public io_inst {
 public:
   using io_inst::io_inst;
+  static bool classof(const value *v) { return v->get_id() >= INST_ATOMIC_CAS && v->get_id() <= INST_ATOMIC_RMW; }
 };
 
 class atomic_rmw_inst: public atomic_inst {
@@ -623,6 +723,9 @@ public:
 
 private:
   atomic_rmw_op_t op_;
+
+public:
+  static bool classof(const value *v) { return v->get_id() == INST_ATOMIC_RMW; }
 };
 
 class atomic_cas_inst: public atomic_inst {
@@ -634,6 +737,7 @@ private:
 
 public:
   static instruction* create(value *ptr, value *cmp, value *val, const std::string &name = "", instruction *next = nullptr);
+  static bool classof(const value *v) { return v->get_id() == INST_ATOMIC_CAS; }
 };
 
 class exp_inst: public builtin_inst {
@@ -645,6 +749,7 @@ private:
 
 public:
   static instruction* create(value *val, const std::string &name = "", instruction *next = nullptr);
+  static bool classof(const value *v) { return v->get_id() == INST_EXP; }
 };
 
 class cos_inst: public builtin_inst {
@@ -656,6 +761,7 @@ private:
 
 public:
   static instruction* create(value *val, const std::string &name = "", instruction *next = nullptr);
+  static bool classof(const value *v) { return v->get_id() == INST_COS; }
 };
 
 class sin_inst: public builtin_inst {
@@ -667,6 +773,7 @@ private:
 
 public:
   static instruction* create(value *val, const std::string &name = "", instruction *next = nullptr);
+  static bool classof(const value *v) { return v->get_id() == INST_SIN; }
 };
 
 class log_inst: public builtin_inst {
@@ -678,6 +785,7 @@ private:
 
 public:
   static instruction* create(value *val, const std::string &name = "", instruction *next = nullptr);
+  static bool classof(const value *v) { return v->get_id() == INST_LOG; }
 };
 
 
@@ -686,22 +794,26 @@ public:
   enum TransT { NoTrans, Trans };
 
 private:
-  dot_inst(value *A, value *B, value *C, TransT AT, TransT BT, const std::string &name, instruction *next);
+  dot_inst(value *A, value *B, value *C, TransT AT, TransT BT, bool allow_tf32, const std::string &name, instruction *next);
   std::string repr_impl() const { return "dot"; }
 
   bool is_prefetched_ = false;
+  bool allow_tf32_ = false;
 public:
   bool is_prefetched() const { return is_prefetched_; }
   void set_prefetched(bool is_prefetched) { is_prefetched_ = is_prefetched; }
+  // fp32 operands may be rounded to tf32 to use tensor cores
+  bool allow_tf32() const { return allow_tf32_; }
 
 public:
-  static instruction *create(value *A, value *B, value *C, bool AT, bool BT, const std::string &name = "", instruction *next = nullptr);
-  static instruction* create_nn(value *A, value *B, value *C, const std::string &name = "", instruction *next = nullptr);
-  static instruction* create_nt(value *A, value *B, value *C, const std::string &name = "", instruction *next = nullptr);
-  static instruction* create_tn(value *A, value *B, value *C, const std::string &name = "", instruction *next = nullptr);
-  static instruction* create_tt(value *A, value *B, value *C, const std::string &name = "", instruction *next = nullptr);
+  static instruction *create(value *A, value *B, value *C, bool AT, bool BT, bool allow_tf32, const std::string &name = "", instruction *next = nullptr);
+  static instruction* create_nn(value *A, value *B, value *C, bool allow_tf32, const std::string &name = "", instruction *next = nullptr);
+  static instruction* create_nt(value *A, value *B, value *C, bool allow_tf32, const std::string &name = "", instruction *next = nullptr);
+  static instruction* create_tn(value *A, value *B, value *C, bool allow_tf32, const std::string &name = "", instruction *next = nullptr);
+  static instruction* create_tt(value *A, value *B, value *C, bool allow_tf32, const std::string &name = "", instruction *next = nullptr);
   _TRITON_DEFINE_CLONE(dot_inst)
   _TRITON_DEFINE_ACCEPT(dot_inst)
+  static bool classof(const value *v) { return v->get_id() == INST_DOT; }
 };
 
 //class outer_inst: public builtin_inst {
@@ -728,6 +840,9 @@ public:
 
 private:
   std::vector<int> perm_;
+
+public:
+  static bool classof(const value *v) { return v->get_id() == INST_TRANS; }
 };
 
 class sqrt_inst: public builtin_inst {
@@ -738,17 +853,22 @@ public:
   static instruction* create(value *arg, const std::string &name = "", instruction *next = nullptr);
   _TRITON_DEFINE_CLONE(sqrt_inst)
   _TRITON_DEFINE_ACCEPT(sqrt_inst)
+  static bool classof(const value *v) { return v->get_id() == INST_SQRT; }
 };
 
 class reduce_inst: public builtin_inst {
 public:
   enum op_t{
     ADD, SUB, MAX, MIN,
-    FADD, FSUB, FMAX, FMIN
+    FADD, FSUB, FMAX, FMIN,
+    // log of the sum of exponentials, accumulated as (max, scaled sum) pairs
+    FLOGSUMEXP,
+    // index of the first extremum
+    ARGMAX, ARGMIN, ARGFMAX, ARGFMIN
   };
 
 private:
-  static type* get_res_type(value *arg, unsigned axis);
+  static type* get_res_type(value *arg, op_t op, unsigned axis);
   static std::string to_str(op_t op);
 
 private:
@@ -761,10 +881,69 @@ public:
   static instruction* create(value *arg, op_t op, unsigned axis, const std::string &name = "", instruction *next = nullptr);
   unsigned get_axis() const { return axis_; }
   op_t get_op() const { return op_; }
+  static bool is_arg_op(op_t op) { return op >= ARGMAX; }
+  bool is_arg_op() const { return is_arg_op(op_); }
+  // the accumulator is a pair of values rather than the result itself
+  bool has_pair_acc() const { return is_arg_op() || op_ == FLOGSUMEXP; }
 
 private:
   unsigned axis_;
   op_t op_;
+
+public:
+  static bool classof(const value *v) { return v->get_id() == INST_REDUCE; }
+};
+
+class scan_inst: public builtin_inst {
+public:
+  enum op_t{
+    ADD, MUL, MAX, MIN,
+    FADD, FMUL, FMAX, FMIN
+  };
+
+private:
+  scan_inst(value* arg, op_t op, unsigned axis, const std::string& name, instruction* next);
+  std::string repr_impl() const { return "scan"; }
+  _TRITON_DEFINE_CLONE(scan_inst)
+  _TRITON_DEFINE_ACCEPT(scan_inst)
+
+public:
+  static instruction* create(value *arg, op_t op, unsigned axis, const std::string &name = "", instruction *next = nullptr);
+  unsigned get_axis() const { return axis_; }
+  op_t get_op() const { return op_; }
+
+private:
+  unsigned axis_;
+  op_t op_;
+
+public:
+  static bool classof(const value *v) { return v->get_id() == INST_SCAN; }
+};
+
+class sort_inst: public builtin_inst {
+private:
+  static type* get_res_type(value *arg, unsigned axis, unsigned k);
+  sort_inst(value* arg, unsigned axis, unsigned k, bool descending, const std::string& name, instruction* next);
+  std::string repr_impl() const { return "sort"; }
+  _TRITON_DEFINE_CLONE(sort_inst)
+  _TRITON_DEFINE_ACCEPT(sort_inst)
+
+public:
+  static instruction* create(value *arg, unsigned axis, unsigned k, bool descending,
+                             const std::string &name = "", instruction *next = nullptr);
+  unsigned get_axis() const { return axis_; }
+  unsigned get_k() const { return k_; }
+  bool is_descending() const { return descending_; }
+  // only the first k elements along the axis are kept
+  bool is_topk() const { return k_ < get_operand(0)->get_type()->get_block_shapes()[axis_]; }
+
+private:
+  unsigned axis_;
+  unsigned k_;
+  bool descending_;
+
+public:
+  static bool classof(const value *v) { return v->get_id() == INST_SORT; }
 };
 
 class select_inst: public builtin_inst {
@@ -779,6 +958,7 @@ public:
   value* get_pred_op() { return get_operand(0); }
   value* get_if_value_op() { return get_operand(1); }
   value* get_else_value_op() { return get_operand(2); }
+  static bool classof(const value *v) { return v->get_id() == INST_SELECT; }
 };
 
 //===----------------------------------------------------------------------===//
@@ -795,6 +975,7 @@ public:
                                      instruction *next = nullptr);
   _TRITON_DEFINE_CLONE(copy_to_shared_inst)
   _TRITON_DEFINE_ACCEPT(copy_to_shared_inst)
+  static bool classof(const value *v) { return v->get_id() == INST_COPY_TO_SHARED; }
 };
 
 class copy_from_shared_inst: public unary_inst{
@@ -807,6 +988,7 @@ public:
                                      instruction *next = nullptr);
   _TRITON_DEFINE_CLONE(copy_from_shared_inst)
   _TRITON_DEFINE_ACCEPT(copy_from_shared_inst)
+  static bool classof(const value *v) { return v->get_id() == INST_COPY_FROM_SHARED; }
 };
 
 class cvt_layout_inst: public unary_inst {
@@ -818,6 +1000,7 @@ public:
   static cvt_layout_inst* create(value *arg, const std::string &name = "", instruction *next = nullptr);
   _TRITON_DEFINE_CLONE(cvt_layout_inst)
   _TRITON_DEFINE_ACCEPT(cvt_layout_inst)
+  static bool classof(const value *v) { return v->get_id() == INST_CVT_LAYOUT; }
 };
 
 class barrier_inst: public instruction{
@@ -830,6 +1013,7 @@ private:
 public:
   static barrier_inst* create(context &ctx, const std::string &name = "",
                                             instruction *next = nullptr);
+  static bool classof(const value *v) { return v->get_id() == INST_BARRIER; }
 };
 
 class async_wait_inst: public instruction{
@@ -847,6 +1031,9 @@ public:
 
 private:
   int N_;
+
+public:
+  static bool classof(const value *v) { return v->get_id() == INST_ASYNC_WAIT; }
 };
 
 class prefetch_s_inst : public instruction {
@@ -864,6 +1051,7 @@ public:
   int get_inc() const { return inc_; }
   static prefetch_s_inst *create(context &ctx, value *arg, int inc, const std::string &name = "",
    instruction *next=nullptr);
+  static bool classof(const value *v) { return v->get_id() == INST_PREFETCH_S; }
 };
 
 //// On NVIDIA, implementation is such that
@@ -910,6 +1098,9 @@ public:
 private:
   constant_int* first_;
   constant_int* last_;
+
+public:
+  static bool classof(const value *v) { return v->get_id() == INST_MAKE_RANGE; }
 };
 
 
@@ -12,7 +12,11 @@ class metadata{
 public:
   enum kind_t{
     multiple_of,
-    max_contiguous
+    max_contiguous,
+    // memory access hints (see io_inst)
+    cache_modifier,
+    eviction_policy,
+    is_volatile
   };
 
 private:
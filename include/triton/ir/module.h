@@ -59,6 +59,8 @@ private:
 public:
   module(const std::string &name, builder& builder);
   builder& get_builder();
+  // Deep copy of all functions; shares the builder and context
+  module *clone();
   // Setters
   void set_value(const std::string& name, basic_block* block, value *x);
   void set_value(const std::string& name, value* x);
@@ -78,6 +80,11 @@ public:
   const functions_list_t &get_function_list() const { return functions_; }
   functions_list_t &get_function_list()             { return functions_; }
   function *get_or_insert_function(const std::string &name, function_type *ty);
+  // Clones the body of `callee` (which must end with a single `ret`) at the
+  // builder's insertion point, binding its arguments to `args`, and returns
+  // the clones of `rets`. The insertion point is left at the exit block.
+  std::vector<value*> inline_function(function *callee, const std::vector<value*> &args,
+                                      const std::vector<value*> &rets);
   // Const allocation
   void add_alloc(ir::alloc_const* x)                          { allocs_.push_back(x); }
   const std::vector<ir::alloc_const*>& allocs()               { return allocs_; }
@@ -3,6 +3,7 @@
 #ifndef _TRITON_IR_CFG_H_
 #define _TRITON_IR_CFG_H_
 
+#include <map>
 #include <vector>
 #include <functional>
 
@@ -19,6 +20,10 @@ class cfg {
 public:
   static std::vector<basic_block *> post_order(function* fn);
   static std::vector<basic_block *> reverse_post_order(function* fn);
+  // immediate dominator of each reachable block (nullptr for entry blocks)
+  static std::map<basic_block*, basic_block*> immediate_dominators(function* fn);
+  static bool dominates(const std::map<basic_block*, basic_block*> &idom,
+                        basic_block* a, basic_block* b);
 };
 
 void for_each_instruction(ir::module& mod, const std::function<void(triton::ir::instruction*)> &fn);
@@ -6,6 +6,8 @@
 #include <string>
 #include <vector>
 #include <set>
+#include "enums.h"
+#include "casting.h"
 
 namespace triton{
 namespace ir{
@@ -25,7 +27,7 @@ public:
 
 public:
   // constructor
-  value(type *ty, const std::string &name = "");
+  value(type *ty, value_id_t id, const std::string &name = "");
   virtual ~value(){ }
   // uses
   void add_use(user* arg);
@@ -37,11 +39,14 @@ public:
   const std::string &get_name() const { return name_; }
   bool has_name() const { return !name_.empty(); }
   type* get_type() const { return ty_; }
+  // value id
+  value_id_t get_id() const { return id_; }
   // visitor
   virtual void accept(visitor *v) = 0;
 
 private:
   std::string name_;
+  value_id_t id_;
 
 protected:
   type *ty_;
@@ -64,10 +69,12 @@ protected:
 
 public:
   // Constructor
-  user(type *ty, unsigned num_ops, const std::string &name = "")
-      : value(ty, name), ops_(num_ops), num_ops_(num_ops), num_hidden_(0){
+  user(type *ty, value_id_t id, unsigned num_ops, const std::string &name = "")
+      : value(ty, id, name), ops_(num_ops), num_ops_(num_ops), num_hidden_(0){
   }
   virtual ~user() { }
+  static bool classof(const value *v) { return v->get_id() != VALUE_ARGUMENT &&
+                                               v->get_id() != VALUE_BASIC_BLOCK; }
 
   // Operands
   const ops_t& ops() { return ops_; }
@@ -62,6 +62,8 @@ class dot_inst;
 class trans_inst;
 class sqrt_inst;
 class reduce_inst;
+class scan_inst;
+class sort_inst;
 class select_inst;
 
 class cvt_layout_inst;
@@ -140,6 +142,8 @@ public:
   virtual void visit_trans_inst(trans_inst*) = 0;
   virtual void visit_sqrt_inst(sqrt_inst*) = 0;
   virtual void visit_reduce_inst(reduce_inst*) = 0;
+  virtual void visit_scan_inst(scan_inst*) = 0;
+  virtual void visit_sort_inst(sort_inst*) = 0;
   virtual void visit_select_inst(select_inst*) = 0;
 
   virtual void visit_cvt_layout_inst(cvt_layout_inst*) = 0;
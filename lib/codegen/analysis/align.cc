@@ -163,6 +163,13 @@ std::vector<align::cst_info> align::populate_is_constant_gep(ir::getelementptr_i
   return add_to_cache(x, result, is_constant_);
 }
 
+std::vector<align::cst_info> align::populate_is_constant_cast(ir::cast_inst* x) {
+  std::vector<cst_info> result;
+  for(cst_info ax: populate_is_constant(x->get_operand(0)))
+    result.push_back({ax.num_cst, 0});
+  return add_to_cache(x, result, is_constant_);
+}
+
 std::vector<align::cst_info> align::populate_is_constant_default(ir::value *v) {
   auto shapes = get_shapes(v);
   std::vector<cst_info> result(shapes.size(), {1, 0});
@@ -172,20 +179,22 @@ std::vector<align::cst_info> align::populate_is_constant_default(ir::value *v) {
 std::vector<align::cst_info> align::populate_is_constant(ir::value *v) {
   if(is_constant_.find(v) != is_constant_.end())
     return is_constant_.at(v);
-  if(auto *x = dynamic_cast<ir::constant_int*>(v))
+  if(auto *x = ir::dyn_cast<ir::constant_int>(v))
     return add_to_cache(v, {cst_info{true, std::min<unsigned>(x->get_value(), 128)}}, is_constant_);
-  if(auto *x = dynamic_cast<ir::phi_node*>(v))
+  if(auto *x = ir::dyn_cast<ir::phi_node>(v))
     return populate_is_constant_phi(x);
-  if(auto *x = dynamic_cast<ir::splat_inst*>(v))
+  if(auto *x = ir::dyn_cast<ir::splat_inst>(v))
     return populate_is_constant_splat(x);
-  if(auto *x = dynamic_cast<ir::reshape_inst*>(v))
+  if(auto *x = ir::dyn_cast<ir::reshape_inst>(v))
     return populate_is_constant_reshape(x);
-  if(auto *x = dynamic_cast<ir::broadcast_inst*>(v))
+  if(auto *x = ir::dyn_cast<ir::broadcast_inst>(v))
     return populate_is_constant_broadcast(x);
-  if(auto *x = dynamic_cast<ir::binary_operator*>(v))
+  if(auto *x = ir::dyn_cast<ir::binary_operator>(v))
     return populate_is_constant_binop(x);
-  if(auto *x = dynamic_cast<ir::getelementptr_inst*>(v))
+  if(auto *x = ir::dyn_cast<ir::getelementptr_inst>(v))
     return populate_is_constant_gep(x);
+  if(auto *x = ir::dyn_cast<ir::cast_inst>(v))
+    return populate_is_constant_cast(x);
   return populate_is_constant_default(v);
 }
 
@@ -318,7 +327,7 @@ std::vector<unsigned> align::populate_max_contiguous_default(ir::value* v) {
   if(!v->get_type()->is_block_ty())
     return add_to_cache(v, {1}, max_contiguous_);
   auto shapes = v->get_type()->get_block_shapes();
-  if(dynamic_cast<ir::make_range*>(v))
+  if(ir::isa<ir::make_range>(v))
     return add_to_cache(v, {shapes[0]}, max_contiguous_);
   return add_to_cache(v, std::vector<unsigned>(shapes.size(), 1), max_contiguous_);
 }
@@ -331,24 +340,24 @@ std::vector<unsigned> align::populate_max_contiguous_cast(ir::cast_inst* v){
 std::vector<unsigned> align::populate_max_contiguous(ir::value *v){
   if(max_contiguous_.find(v) != max_contiguous_.end())
     return max_contiguous_.at(v);
-  if(auto *x = dynamic_cast<ir::instruction*>(v)){
+  if(auto *x = ir::dyn_cast<ir::instruction>(v)){
     unsigned max_contiguous = x->get_metadata(ir::metadata::max_contiguous);
     if(max_contiguous > 0)
       return add_to_cache(x, {max_contiguous}, max_contiguous_);
   }
-  if(auto *x = dynamic_cast<ir::cast_inst*>(v))
+  if(auto *x = ir::dyn_cast<ir::cast_inst>(v))
     return populate_max_contiguous_cast(x);
-  if(auto *x = dynamic_cast<ir::splat_inst*>(v))
+  if(auto *x = ir::dyn_cast<ir::splat_inst>(v))
     return populate_max_contiguous_splat(x);
-  if(auto *x = dynamic_cast<ir::reshape_inst*>(v))
+  if(auto *x = ir::dyn_cast<ir::reshape_inst>(v))
     return populate_max_contiguous_reshape(x);
-  if(auto *x = dynamic_cast<ir::broadcast_inst*>(v))
+  if(auto *x = ir::dyn_cast<ir::broadcast_inst>(v))
     return populate_max_contiguous_broadcast(x);
-  if(auto *x = dynamic_cast<ir::binary_operator*>(v))
+  if(auto *x = ir::dyn_cast<ir::binary_operator>(v))
     return populate_max_contiguous_binop(x);
-  if(auto *x = dynamic_cast<ir::getelementptr_inst*>(v))
+  if(auto *x = ir::dyn_cast<ir::getelementptr_inst>(v))
     return populate_max_contiguous_gep(x);
-  if(auto *x = dynamic_cast<ir::phi_node*>(v))
+  if(auto *x = ir::dyn_cast<ir::phi_node>(v))
     return populate_max_contiguous_phi(x);
   return populate_max_contiguous_default(v);
 }
@@ -454,7 +463,7 @@ std::vector<unsigned> align::populate_starting_multiple_default(ir::value* v) {
   if(ty->is_block_ty()) {
     return add_to_cache(v, ty->get_block_shapes(), starting_multiple_);
   }
-  if(auto *x = dynamic_cast<ir::argument*>(v)){
+  if(auto *x = ir::dyn_cast<ir::argument>(v)){
     std::set<ir::attribute> attributes = x->get_parent()->get_attributes(x);
     for(auto attr: attributes){
       if(attr.get_kind() == ir::multiple_of){
@@ -474,28 +483,28 @@ std::vector<unsigned> align::populate_starting_multiple_default(ir::value* v) {
 std::vector<unsigned> align::populate_starting_multiple(ir::value *v){
   if(starting_multiple_.find(v) != starting_multiple_.end())
     return starting_multiple_.at(v);
-  if(auto *x = dynamic_cast<ir::instruction*>(v)){
+  if(auto *x = ir::dyn_cast<ir::instruction>(v)){
     unsigned multiple_of = x->get_metadata(ir::metadata::multiple_of);
     if(multiple_of > 0)
       return add_to_cache(x, {multiple_of}, starting_multiple_);
   }
-  if(auto *x = dynamic_cast<ir::cast_inst*>(v))
+  if(auto *x = ir::dyn_cast<ir::cast_inst>(v))
     return populate_starting_multiple_cast(x);
-  if(auto *x = dynamic_cast<ir::binary_operator*>(v))
+  if(auto *x = ir::dyn_cast<ir::binary_operator>(v))
     return populate_starting_multiple_binop(x);
-  if(auto *x = dynamic_cast<ir::constant_int*>(v))
+  if(auto *x = ir::dyn_cast<ir::constant_int>(v))
     return add_to_cache(x, {std::min<unsigned>(x->get_value(), 128)}, starting_multiple_);
-  if(auto *x = dynamic_cast<ir::make_range*>(v))
+  if(auto *x = ir::dyn_cast<ir::make_range>(v))
     return add_to_cache(x, {(unsigned)x->get_first()->get_value()}, starting_multiple_);
-  if(auto *x = dynamic_cast<ir::getelementptr_inst*>(v))
+  if(auto *x = ir::dyn_cast<ir::getelementptr_inst>(v))
     return populate_starting_multiple_gep(x);
-  if(auto *x = dynamic_cast<ir::splat_inst*>(v))
+  if(auto *x = ir::dyn_cast<ir::splat_inst>(v))
     return populate_starting_multiple_splat(x);
-  if(auto *x = dynamic_cast<ir::reshape_inst*>(v))
+  if(auto *x = ir::dyn_cast<ir::reshape_inst>(v))
     return populate_starting_multiple_reshape(x);
-  if(auto *x = dynamic_cast<ir::broadcast_inst*>(v))
+  if(auto *x = ir::dyn_cast<ir::broadcast_inst>(v))
     return populate_starting_multiple_broadcast(x);
-  if(auto *x = dynamic_cast<ir::phi_node*>(v))
+  if(auto *x = ir::dyn_cast<ir::phi_node>(v))
     return populate_starting_multiple_phi(x);
   return populate_starting_multiple_default(v);
 }
@@ -511,6 +520,13 @@ std::vector<unsigned> align::contiguous(ir::value* v) const {
   return max_contiguous_.at(v);
 }
 
+std::vector<unsigned> align::num_constant(ir::value* v) const {
+  std::vector<unsigned> result;
+  for(const cst_info& x: is_constant_.at(v))
+    result.push_back(x.num_cst);
+  return result;
+}
+
 
 void align::populate(ir::value *v) {
   populate_is_constant(v);
@@ -522,7 +538,7 @@ void align::populate(ir::value *v) {
 void align::run(ir::module &mod) {
   ir::for_each_value(mod, [this](ir::value* v) { populate(v); } );
 //  ir::for_each_value(mod, [this](ir::value* v) {
-//      if(dynamic_cast<ir::cast_inst*>(v) || dynamic_cast<ir::getelementptr_inst*>(v))
+//      if(ir::isa<ir::cast_inst>(v) || ir::isa<ir::getelementptr_inst>(v))
 //        std::cout << "ALIGN: " << v->get_name() << " " << max_contiguous_.at(v)[0] << " " << max_contiguous_.at(v)[1] << std::endl;
 //  });
 }
@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <climits>
+#include <cstdint>
 #include "triton/codegen/analysis/layout.h"
 #include "triton/codegen/analysis/allocation.h"
 #include "triton/codegen/analysis/liveness.h"
@@ -10,7 +11,9 @@ namespace codegen{
 namespace analysis{
 
 
-void allocation::run(ir::module &mod) {
+/// previous allocator: greedy interval placement followed by first-fit
+/// coloring of the interference graph. Only its size is kept.
+static size_t legacy_allocate(liveness *liveness_) {
   using std::max;
   using std::min;
   typedef std::multimap<unsigned, segment> triples_map_type;
@@ -84,16 +87,151 @@ void allocation::run(ir::module &mod) {
     colors[x] = std::distance(available.begin(), It);
   }
   // Finalize allocation
+  size_t allocated_size = 0;
   for(shared_layout* x: V){
     unsigned Adj = 0;
     for(shared_layout* y: interferences[x])
       Adj = std::max<unsigned>(Adj, starts[y] + y->get_size());
-    offsets_[x] = starts[x] + colors[x] * Adj;
+    allocated_size = std::max<size_t>(allocated_size, starts[x] + colors[x] * Adj + x->get_size());
   }
-  // Save maximum size of induced memory space
-  allocated_size_ = 0;
-  for(shared_layout* x: V)
-    allocated_size_ = std::max<size_t>(allocated_size_, starts[x] + x->get_size());
+  return allocated_size;
+}
+
+
+// instances with at most this many buffers are refined by branch-and-bound
+static const size_t max_exact_buffers = 12;
+// maximum number of partial placements explored by branch-and-bound
+static const size_t max_search_nodes = 100000;
+
+/// natural alignment of a buffer, up to 16 bytes (the widest shared memory access)
+static unsigned get_alignment(unsigned size) {
+  unsigned align = 1;
+  while(align < 16 && size % (2*align) == 0)
+    align *= 2;
+  return align;
+}
+
+/// placement of buffers whose live ranges overlap at non-overlapping offsets
+struct packing {
+  std::vector<unsigned> sizes;
+  std::vector<unsigned> aligns;
+  std::vector<std::vector<size_t>> interferences;
+  std::vector<unsigned> offsets;
+  std::vector<bool> placed;
+
+  bool fits(size_t k, unsigned off) const {
+    for(size_t j: interferences[k])
+      if(placed[j] && off < offsets[j] + sizes[j] && offsets[j] < off + sizes[k])
+        return false;
+    return true;
+  }
+
+  /// lowest offsets at which `k` can be placed: 0 or right above an interfering buffer
+  std::vector<unsigned> candidates(size_t k) const {
+    std::vector<unsigned> res = {0};
+    for(size_t j: interferences[k])
+      if(placed[j]){
+        unsigned off = offsets[j] + sizes[j];
+        res.push_back((off + aligns[k] - 1) / aligns[k] * aligns[k]);
+      }
+    std::sort(res.begin(), res.end());
+    res.erase(std::unique(res.begin(), res.end()), res.end());
+    res.erase(std::remove_if(res.begin(), res.end(), [&](unsigned off) { return !fits(k, off); }), res.end());
+    return res;
+  }
+};
+
+/// depth-first search over the placements of `order[k:]`
+static void search(packing &p, const std::vector<size_t> &order, size_t k, size_t peak, size_t lower_bound,
+                   size_t &best, std::vector<unsigned> &best_offsets, size_t &num_nodes) {
+  if(best == lower_bound || num_nodes++ >= max_search_nodes)
+    return;
+  if(k == order.size()){
+    best = peak;
+    best_offsets = p.offsets;
+    return;
+  }
+  size_t x = order[k];
+  for(unsigned off: p.candidates(x)){
+    size_t new_peak = std::max<size_t>(peak, off + p.sizes[x]);
+    if(new_peak >= best)
+      continue;
+    p.offsets[x] = off;
+    p.placed[x] = true;
+    search(p, order, k + 1, new_peak, lower_bound, best, best_offsets, num_nodes);
+    p.placed[x] = false;
+  }
+}
+
+void allocation::run(ir::module &mod) {
+  offsets_.clear();
+  std::vector<shared_layout*> V;
+  std::vector<segment> live;
+  for(auto x: liveness_->get()){
+    V.push_back(x.first);
+    live.push_back(x.second);
+  }
+  size_t n = V.size();
+  packing p;
+  p.interferences.resize(n);
+  p.offsets.resize(n);
+  p.placed.resize(n);
+  for(size_t i = 0; i < n; i++){
+    p.sizes.push_back(V[i]->get_size());
+    p.aligns.push_back(get_alignment(V[i]->get_size()));
+    for(size_t j = 0; j < n; j++)
+      if(i != j && live[i].intersect(live[j]))
+        p.interferences[i].push_back(j);
+  }
+  // no allocation can be smaller than the memory live at any point
+  live_size_ = 0;
+  for(size_t i = 0; i < n; i++){
+    size_t size = 0;
+    for(size_t j = 0; j < n; j++)
+      if(live[j].contains(live[i].start))
+        size += p.sizes[j];
+    live_size_ = std::max(live_size_, size);
+  }
+  // best-fit decreasing: place large, long-lived buffers first,
+  // each where it least increases the peak
+  std::vector<size_t> order(n);
+  for(size_t i = 0; i < n; i++)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    if(p.sizes[a] != p.sizes[b])
+      return p.sizes[a] > p.sizes[b];
+    return live[a].end - live[a].start > live[b].end - live[b].start;
+  });
+  size_t peak = 0;
+  for(size_t x: order){
+    unsigned best_off = 0;
+    size_t best_peak = SIZE_MAX;
+    for(unsigned off: p.candidates(x)){
+      size_t new_peak = std::max<size_t>(peak, off + p.sizes[x]);
+      if(new_peak < best_peak){
+        best_peak = new_peak;
+        best_off = off;
+      }
+    }
+    p.offsets[x] = best_off;
+    p.placed[x] = true;
+    peak = best_peak;
+  }
+  // refine small instances with branch-and-bound
+  if(n <= max_exact_buffers && peak > live_size_){
+    std::vector<unsigned> best_offsets = p.offsets;
+    size_t num_nodes = 0;
+    std::fill(p.placed.begin(), p.placed.end(), false);
+    search(p, order, 0, 0, live_size_, peak, best_offsets, num_nodes);
+    p.offsets = best_offsets;
+  }
+  for(size_t i = 0; i < n; i++)
+    offsets_[V[i]] = p.offsets[i];
+  allocated_size_ = n ? peak : 0;
+}
+
+unsigned allocation::legacy_allocated_size() const {
+  return legacy_allocate(liveness_);
 }
 
 }
@@ -24,6 +24,14 @@ void axes::update_graph_reduce(ir::instruction *i) {
   }
 }
 
+void axes::update_graph_sort(ir::instruction *i) {
+  auto* sort = static_cast<ir::sort_inst*>(i);
+  // top-k results are distributed independently of their operand
+  if(sort->is_topk())
+    return update_graph_no_edge(i);
+  return update_graph_elementwise(i);
+}
+
 void axes::update_graph_reshape(ir::instruction *i) {
   auto* reshape = static_cast<ir::reshape_inst*>(i);
   // operands
@@ -106,6 +114,7 @@ void axes::update_graph_no_edge(ir::instruction *i) {
 void axes::update_graph(ir::instruction *i) {
   switch (i->get_id()) {
     case ir::INST_REDUCE:            return update_graph_reduce(i);
+    case ir::INST_SORT:              return update_graph_sort(i);
     case ir::INST_RESHAPE:           return update_graph_reshape(i);
     case ir::INST_SPLAT:             return update_graph_no_edge(i);;
     case ir::INST_TRANS:             return update_graph_trans(i);
@@ -1,10 +1,12 @@
 #include <algorithm>
+#include <functional>
 #include <numeric>
 #include <iostream>
 #include "triton/codegen/analysis/axes.h"
 #include "triton/codegen/analysis/align.h"
 #include "triton/codegen/analysis/layout.h"
 #include "triton/ir/function.h"
+#include "triton/ir/instructions.h"
 #include "triton/ir/module.h"
 #include "triton/ir/utils.h"
 // #include "triton/ir/type.h"
@@ -23,22 +25,34 @@ inline unsigned clamp(unsigned x, unsigned a, unsigned b) {
   return std::min(std::max(x, lo), hi);
 }
 
-inline bool is_hmma_c(ir::value *v){
+inline bool is_hmma_c(ir::value *v, target *tgt){
   bool result = false;
-  if(auto *x = dynamic_cast<ir::dot_inst*>(v)){
+  if(auto *x = ir::dyn_cast<ir::dot_inst>(v)){
     ir::value *a = x->get_operand(0);
     ir::type *a_ty = a->get_type();
     ir::value *b = x->get_operand(1);
     ir::type *b_ty = b->get_type();
-    result = a_ty->get_scalar_ty()->is_fp16_ty() &&
-             b_ty->get_scalar_ty()->is_fp16_ty();
+    ir::type *a_sca_ty = a_ty->get_scalar_ty();
+    ir::type *b_sca_ty = b_ty->get_scalar_ty();
+    int sm = tgt->as_nvidia() ? tgt->as_nvidia()->sm() : 0;
+    result = a_sca_ty->is_fp16_ty() && b_sca_ty->is_fp16_ty();
+    // int8 tensor cores (IMMA) are available from Turing onwards and
+    // consume 32 elements of the reduction axis at a time
+    if(a_sca_ty->is_integer_ty(8) && b_sca_ty->is_integer_ty(8))
+      result = sm >= 75 && a_ty->get_block_shapes()[1] % 32 == 0;
+    // bf16 and tf32 tensor cores are available from Ampere onwards;
+    // fp32 operands only use them when the dot allows rounding to tf32
+    if(a_sca_ty->is_bf16_ty() && b_sca_ty->is_bf16_ty())
+      result = sm >= 80;
+    if(a_sca_ty->is_fp32_ty() && b_sca_ty->is_fp32_ty())
+      result = sm >= 80 && x->allow_tf32() && a_ty->get_block_shapes()[1] % 8 == 0;
   }
   return result;
 }
 
 inline void extract_io_use(ir::value *v, std::set<ir::value*>& result) {
   for(ir::user* u: v->get_users()){
-    auto i = dynamic_cast<ir::io_inst*>(u);
+    auto i = ir::dyn_cast<ir::io_inst>(u);
     if(i && i->get_pointer_operand() == v)
       result.insert(v);
   }
@@ -46,26 +60,26 @@ inline void extract_io_use(ir::value *v, std::set<ir::value*>& result) {
 
 inline void extract_dot_use(ir::value *v, ir::value*& result, size_t n) {
   for(ir::user* u: v->get_users()){
-    auto i = dynamic_cast<ir::dot_inst*>(u);
+    auto i = ir::dyn_cast<ir::dot_inst>(u);
     if(i && i->get_operand(n) == v)
       result = v;
   }
 }
 
-inline void extract_hmma_dot_use(ir::value *v, ir::value*& result, size_t n) {
+inline void extract_hmma_dot_use(ir::value *v, ir::value*& result, size_t n, target *tgt) {
   for(ir::user* u: v->get_users()){
-    auto i = dynamic_cast<ir::dot_inst*>(u);
-    if(i && is_hmma_c(i) && i->get_operand(n) == v)
+    auto i = ir::dyn_cast<ir::dot_inst>(u);
+    if(i && is_hmma_c(i, tgt) && i->get_operand(n) == v)
       result = i;
   }
 }
 
 
 inline bool is_trans(ir::value *v) {
-  if(dynamic_cast<ir::trans_inst *>(v)) {
+  if(ir::isa<ir::trans_inst>(v)) {
     return true;
   }
-  if(auto *phi = dynamic_cast<ir::instruction *>(v)) {
+  if(auto *phi = ir::dyn_cast<ir::instruction>(v)) {
     bool result = true;
     for(ir::value *op: phi->ops())
       result = result && is_trans(op);
@@ -145,7 +159,9 @@ mma_layout::mma_layout(size_t num_warps,
                        shared_layout *layout_a, shared_layout *layout_b): distributed_layout(MMA, axes, shape, values, align) {
   /* fragments per warp */
   // try to make things as square as possible to maximize data re-use
-  if(tgt->as_nvidia()->sm() < 80){
+  // only fp16 operands use the m8n8k4 fragments of pre-Ampere GPUs
+  bool is_fp16 = layout_a->get_type()->is_fp16_ty();
+  if(tgt->as_nvidia()->sm() < 80 && is_fp16){
     fpw_ = {2, 2, 1};
     auto ord_a = layout_a->get_order();
     auto ord_b = layout_b->get_order();
@@ -196,12 +212,12 @@ scanline_layout::scanline_layout(size_t num_warps,
   nts_.resize(shape_.size());
   mts_.resize(shape_.size());
   bool is_dot = std::any_of(values.begin(), values.end(),
-                            [&](ir::value* v) { return dynamic_cast<ir::dot_inst*>(v); });
+                            [&](ir::value* v) { return ir::isa<ir::dot_inst>(v); });
 
   ir::value *ptr = nullptr;
   for(ir::value *v: values)
     for(ir::user *usr: v->get_users())
-      if(auto *io = dynamic_cast<ir::io_inst*>(usr)){
+      if(auto *io = ir::dyn_cast<ir::io_inst>(usr)){
         if(!ptr || ptr->get_type()->get_tile_rank() < io->get_pointer_operand()->get_type()->get_tile_rank())
         ptr = io->get_pointer_operand();
       }
@@ -233,6 +249,21 @@ scanline_layout::scanline_layout(size_t num_warps,
 }
 
 
+int scanline_layout::lane_stride(size_t k) {
+  int stride = 1;
+  for(int d: order_){
+    if(d == (int)k)
+      break;
+    stride *= mts_[d];
+  }
+  return stride;
+}
+
+int scanline_layout::mts_per_warp(size_t k) {
+  return std::max(1, std::min(32 / lane_stride(k), mts_[k]));
+}
+
+
 /* -------------------------------- *
  *          Shared Layout           *
  * -------------------------------- */
@@ -240,10 +271,10 @@ scanline_layout::scanline_layout(size_t num_warps,
 bool shared_layout::is_loop_latch(ir::phi_node *phi, ir::instruction *terminator){
   if(phi->get_parent() != terminator->get_parent())
     return false;
-  if(auto *br = dynamic_cast<ir::cond_branch_inst*>(terminator))
+  if(auto *br = ir::dyn_cast<ir::cond_branch_inst>(terminator))
     return br->get_true_dest() == phi->get_parent()
            || br->get_false_dest() == phi->get_parent();
-  else if(dynamic_cast<ir::uncond_branch_inst*>(terminator))
+  else if(ir::isa<ir::uncond_branch_inst>(terminator))
     return false;
   else
     throw std::runtime_error("unreachable");
@@ -251,7 +282,7 @@ bool shared_layout::is_loop_latch(ir::phi_node *phi, ir::instruction *terminator
 
 
 void shared_layout::extract_double_bufferable(ir::value *v, std::shared_ptr<double_buffer_info_t>& res) {
-  auto* phi = dynamic_cast<ir::phi_node*>(v);
+  auto* phi = ir::dyn_cast<ir::phi_node>(v);
   if(!phi || phi->get_num_incoming() != 2)
     return;
   ir::basic_block *block_0 = phi->get_incoming_block(0);
@@ -262,11 +293,11 @@ void shared_layout::extract_double_bufferable(ir::value *v, std::shared_ptr<doub
   bool is_latch_1 = is_loop_latch(phi, terminator_1);
   ir::value *value_0 = phi->get_incoming_value(0);
   ir::value *value_1 = phi->get_incoming_value(1);
-  ir::instruction *i_0 = dynamic_cast<ir::instruction*>(value_0);
-  ir::instruction *i_1 = dynamic_cast<ir::instruction*>(value_1);
+  ir::instruction *i_0 = ir::dyn_cast<ir::instruction>(value_0);
+  ir::instruction *i_1 = ir::dyn_cast<ir::instruction>(value_1);
   if(!(i_0 && !i_1) &&
-     !(dynamic_cast<ir::copy_to_shared_inst*>(i_0) && dynamic_cast<ir::copy_to_shared_inst*>(i_1)) &&
-     !(dynamic_cast<ir::masked_load_async_inst*>(i_0) && dynamic_cast<ir::masked_load_async_inst*>(i_1)))
+     !(ir::isa_and_nonnull<ir::copy_to_shared_inst>(i_0) && ir::isa_and_nonnull<ir::copy_to_shared_inst>(i_1)) &&
+     !(ir::isa_and_nonnull<ir::masked_load_async_inst>(i_0) && ir::isa_and_nonnull<ir::masked_load_async_inst>(i_1)))
     return;
   if(is_latch_1)
     res.reset(new double_buffer_info_t{value_0, value_1, phi});
@@ -275,8 +306,8 @@ void shared_layout::extract_double_bufferable(ir::value *v, std::shared_ptr<doub
 }
 
 static bool is_smem(ir::value* v) {
-  if (dynamic_cast<ir::copy_to_shared_inst*>(v) ||
-      dynamic_cast<ir::masked_load_async_inst*>(v))
+  if (ir::isa<ir::copy_to_shared_inst>(v) ||
+      ir::isa<ir::masked_load_async_inst>(v))
     return true;
   else
     return false;
@@ -287,7 +318,7 @@ static bool is_smem(ir::value* v) {
 static bool is_multistage_pipe_phi(ir::phi_node* phi, ir::basic_block* bb0, ir::basic_block* bb1, 
     std::vector<ir::value*>& values_0, ir::value*& value_1) {
   ir::value* next = phi;
-  while (auto cphi = dynamic_cast<ir::phi_node*>(next)) {
+  while (auto cphi = ir::dyn_cast<ir::phi_node>(next)) {
     // smem from previous bb & phi/smem from current bb
     ir::value* c0 = cphi->get_incoming_value(0);
     ir::value* c1 = cphi->get_incoming_value(1);
@@ -297,7 +328,7 @@ static bool is_multistage_pipe_phi(ir::phi_node* phi, ir::basic_block* bb0, ir::
     if (is_smem(c0)) {
       assert(cbb0 == bb0);
       values_0.push_back(c0);
-      if (auto phi1 = dynamic_cast<ir::phi_node*>(c1)) {
+      if (auto phi1 = ir::dyn_cast<ir::phi_node>(c1)) {
         next = phi1;
         continue;
       } else {
@@ -316,7 +347,7 @@ static bool is_multistage_pipe_phi(ir::phi_node* phi, ir::basic_block* bb0, ir::
 }
 
 void shared_layout::extract_N_bufferable(ir::value *v, std::shared_ptr<N_buffer_info_t> &res, int &prev_stages) {
-  auto* phi = dynamic_cast<ir::phi_node*>(v);
+  auto* phi = ir::dyn_cast<ir::phi_node>(v);
   // if the phi node is nested
   if (!phi)
     return;
@@ -356,7 +387,7 @@ shared_layout::shared_layout(data_layout *arg,
                                  const std::vector<unsigned>& shape,
                                  const std::vector<ir::value *> &values,
                                  ir::type *ty,
-                                 analysis::align* align): data_layout(SHARED, axes, shape, values, align), ty_(ty) {
+                                 analysis::align* align, target *tgt): data_layout(SHARED, axes, shape, values, align), ty_(ty) {
 
   size_ = 0;
   arg_layout_ = arg;
@@ -382,8 +413,8 @@ shared_layout::shared_layout(data_layout *arg,
   for(ir::value* v: values){
     extract_dot_use(v, dot_a, 0);
     extract_dot_use(v, dot_b, 1);
-    extract_hmma_dot_use(v, hmma_dot_a, 0);
-    extract_hmma_dot_use(v, hmma_dot_b, 1);
+    extract_hmma_dot_use(v, hmma_dot_a, 0, tgt);
+    extract_hmma_dot_use(v, hmma_dot_b, 1, tgt);
   }
   hmma_dot_a_ = hmma_dot_a;
   hmma_dot_b_ = hmma_dot_b;
@@ -451,20 +482,20 @@ void layouts::make_graph(ir::instruction *i) {
 void layouts::create(size_t id, const std::vector<ir::value*>& values) {
 //  if(layouts_.find(id) != layouts_.end())
 //    return;
-  auto it_hmma_c = std::find_if(values.begin(), values.end(), &is_hmma_c);
+  auto it_hmma_c = std::find_if(values.begin(), values.end(), [&](ir::value* v) { return is_hmma_c(v, tgt_); });
   auto cmp = [](ir::value* x, ir::value *y) {
     std::pair<int, int> xx = {x->get_type()->get_tile_rank(), x->get_type()->get_tile_num_elements()};
     std::pair<int, int> yy = {y->get_type()->get_tile_rank(), y->get_type()->get_tile_num_elements()};
     return xx < yy;
   };
   std::vector<ir::value*> lvalue = values;
-  std::remove_if(lvalue.begin(), lvalue.end(), [&](ir::value* v) { return dynamic_cast<ir::trans_inst*>(v); });
+  std::remove_if(lvalue.begin(), lvalue.end(), [&](ir::value* v) { return ir::isa<ir::trans_inst>(v); });
   ir::value *largest = *std::max_element(lvalue.begin(), lvalue.end(), cmp);
   const auto& axes = axes_->get(largest);
   const auto& shapes = largest->get_type()->get_block_shapes();
   auto it_cts = std::find_if(values.begin(), values.end(), [](ir::value* v) {
-      return dynamic_cast<ir::copy_to_shared_inst*>(v) ||
-             dynamic_cast<ir::masked_load_async_inst*>(v);
+      return ir::isa<ir::copy_to_shared_inst>(v) ||
+             ir::isa<ir::masked_load_async_inst>(v);
   });
   // type
   if(it_hmma_c != values.end()){
@@ -479,13 +510,80 @@ void layouts::create(size_t id, const std::vector<ir::value*>& values) {
     ir::instruction *cts = (ir::instruction*)*it_cts;
     ir::value *arg = cts->get_operand(0);
     create(groups_.at(arg), values_.at(groups_.at(arg)));
-    layouts_[id] = new shared_layout(get(arg), axes, shapes, values, largest->get_type()->get_scalar_ty(), align_);
+    layouts_[id] = new shared_layout(get(arg), axes, shapes, values, largest->get_type()->get_scalar_ty(), align_, tgt_);
   }
   else{
     layouts_[id] = new scanline_layout(num_warps_, axes, shapes, values, align_, tgt_);
   }
 }
 
+/* -------------------------------- *
+ *       Fusion of reductions       *
+ * -------------------------------- */
+
+// element-wise instructions that can be computed earlier in their block
+static bool is_hoistable(ir::instruction *i) {
+  return ir::isa<ir::binary_operator>(i) || ir::isa<ir::cmp_inst>(i) ||
+         ir::isa<ir::cast_inst>(i) || ir::isa<ir::getelementptr_inst>(i) ||
+         ir::isa<ir::splat_inst>(i) || ir::isa<ir::broadcast_inst>(i) ||
+         ir::isa<ir::select_inst>(i) || ir::isa<ir::make_range>(i) ||
+         ir::isa<ir::exp_inst>(i) || ir::isa<ir::log_inst>(i) ||
+         ir::isa<ir::cos_inst>(i) || ir::isa<ir::sin_inst>(i) ||
+         ir::isa<ir::sqrt_inst>(i);
+}
+
+// Reductions along the same axes are lowered in a single tree when the
+// operands of the later ones can be computed at the first one, so that
+// they share their shuffles and their round of shared memory.
+void layouts::fuse_reductions(ir::module &mod) {
+  fused_.clear();
+  for(ir::function *fn: mod.get_function_list())
+  for(ir::basic_block *block: fn->blocks()){
+    std::map<ir::instruction*, size_t> position;
+    std::vector<std::vector<ir::reduce_inst*>> groups;
+    // operands shared by several paths of the DAG are only walked once
+    std::map<std::pair<ir::value*, ir::instruction*>, bool> is_available;
+    for(ir::instruction *i: block->get_inst_list()){
+      size_t current = position.size();
+      position[i] = current;
+      auto *red = ir::dyn_cast<ir::reduce_inst>(i);
+      if(!red)
+        continue;
+      ir::value *arg = red->get_operand(0);
+      // `v` only depends on values computed before `first`, possibly
+      // through element-wise instructions in distributed layouts
+      std::function<bool(ir::value*, ir::instruction*)> available = [&](ir::value *v, ir::instruction *first) {
+        auto *i = ir::dyn_cast<ir::instruction>(v);
+        if(!i || i->get_parent() != block || position.at(i) < position.at(first))
+          return true;
+        auto it = is_available.find({v, first});
+        if(it != is_available.end())
+          return it->second;
+        bool res = is_hoistable(i) && !(i->get_type()->is_block_ty() && get(i)->to_shared());
+        for(ir::value *op: i->ops())
+          res = res && available(op, first);
+        is_available[{v, first}] = res;
+        return res;
+      };
+      auto it = std::find_if(groups.begin(), groups.end(), [&](const std::vector<ir::reduce_inst*>& group) {
+        ir::reduce_inst *first = group.front();
+        ir::value *first_arg = first->get_operand(0);
+        return available(arg, first) &&
+               first->get_axis() == red->get_axis() &&
+               layout_of(first_arg) == layout_of(arg) &&
+               axes_->get(first_arg) == axes_->get(arg);
+      });
+      if(it == groups.end())
+        groups.push_back({red});
+      else
+        it->push_back(red);
+    }
+    for(const std::vector<ir::reduce_inst*>& group: groups)
+    for(ir::reduce_inst *red: group)
+      fused_[red] = group;
+  }
+}
+
 void layouts::run(ir::module &mod) {
   // make graph
   graph_.clear();
@@ -503,22 +601,74 @@ void layouts::run(ir::module &mod) {
   for(const auto& x: values_)
     create(x.first, x.second);
 
+  // group reductions
+  fuse_reductions(mod);
+
   // create temporaries
   size_t id = values_.size();
   ir::for_each_instruction(mod, [this, &id](ir::instruction* i) {
-    if(auto *red = dynamic_cast<ir::reduce_inst*>(i)) {
-      id++;
+    auto *red = ir::dyn_cast<ir::reduce_inst>(i);
+    if(red && fused_.at(red).front() == red) {
+      const std::vector<ir::reduce_inst*>& group = fused_.at(red);
       ir::value *arg = red->get_operand(0);
       unsigned axis = red->get_axis();
       // shape
       auto shapes = arg->get_type()->get_block_shapes();
       scanline_layout *layout = get(arg)->to_scanline();
-      shapes[axis] = layout->mts(axis);
-      // create layout
-      layouts_[id] = new shared_layout(layout, axes_->get(arg), shapes, {red}, red->get_type()->get_scalar_ty(), align_);
-      tmp_[red] = id;
+      // threads that share a warp combine their partial results with
+      // shuffles; only the per-warp partials go through shared memory
+      int num_warps = layout->mts(axis) / layout->mts_per_warp(axis);
+      if(num_warps > 1){
+        id++;
+        // bytes of partials per warp, for all the reductions of the group
+        unsigned bytes = 0;
+        for(ir::reduce_inst *x: group){
+          bytes += x->get_operand(0)->get_type()->get_scalar_ty()->get_primitive_size_in_bits() / 8;
+          // indices of arg reductions, scaled sums of logsumexp
+          if(x->has_pair_acc())
+            bytes += 4;
+        }
+        shapes[axis] = num_warps * bytes;
+        // create layout
+        std::vector<ir::value*> values(group.begin(), group.end());
+        layouts_[id] = new shared_layout(layout, axes_->get(arg), shapes, values, ir::type::get_int8_ty(red->get_type()->get_context()), align_, tgt_);
+        for(ir::reduce_inst *x: group)
+          tmp_[x] = id;
+      }
+    }
+    if(auto *scan = ir::dyn_cast<ir::scan_inst>(i)) {
+      ir::value *arg = scan->get_operand(0);
+      unsigned axis = scan->get_axis();
+      scanline_layout *layout = get(arg)->to_scanline();
+      // threads along `axis` that share a warp exchange their partial
+      // sums with shuffles; only the per-warp totals go through shared
+      // memory, so nothing is needed when one warp covers the axis
+      int num_warps = layout->mts(axis) / layout->mts_per_warp(axis);
+      if(num_warps > 1){
+        id++;
+        auto shapes = arg->get_type()->get_block_shapes();
+        shapes[axis] = num_warps * shapes[axis] / layout->shape_per_cta(axis);
+        layouts_[id] = new shared_layout(layout, axes_->get(arg), shapes, {scan}, scan->get_type()->get_scalar_ty(), align_, tgt_);
+        tmp_[scan] = id;
+      }
+    }
+    if(auto *sort = ir::dyn_cast<ir::sort_inst>(i)) {
+      ir::value *arg = sort->get_operand(0);
+      unsigned axis = sort->get_axis();
+      scanline_layout *layout = get(arg)->to_scanline();
+      // compare-exchange stages whose partners live in another warp go
+      // through shared memory, and so does the redistribution of the
+      // first `k` elements of a top-k into the layout of its result.
+      // CPU targets hold the whole axis in one thread and need neither
+      int num_warps = layout->mts(axis) / layout->mts_per_warp(axis);
+      if(tgt_->is_gpu() && (num_warps > 1 || sort->is_topk())){
+        id++;
+        auto shapes = arg->get_type()->get_block_shapes();
+        layouts_[id] = new shared_layout(layout, axes_->get(arg), shapes, {sort}, arg->get_type()->get_scalar_ty(), align_, tgt_);
+        tmp_[sort] = id;
+      }
     }
-    if(auto *val = dynamic_cast<ir::cvt_layout_inst*>(i)){
+    if(auto *val = ir::dyn_cast<ir::cvt_layout_inst>(i)){
       distributed_layout* out_layout = dynamic_cast<distributed_layout*>(get(val));
       distributed_layout* in_layout = dynamic_cast<distributed_layout*>(get(i->get_operand(0)));
       id++;
@@ -528,12 +678,12 @@ void layouts::run(ir::module &mod) {
         shape[k] = std::max(in_layout->shape_per_cta(k),
                             out_layout->shape_per_cta(k));
       }
-      layouts_[id] = new shared_layout(out_layout, axes_->get(val), shape, {val}, val->get_type()->get_scalar_ty(), align_);
+      layouts_[id] = new shared_layout(out_layout, axes_->get(val), shape, {val}, val->get_type()->get_scalar_ty(), align_, tgt_);
       tmp_[val] = id;
     }
-    if(auto *atom = dynamic_cast<ir::atomic_inst*>(i)){
+    if(auto *atom = ir::dyn_cast<ir::atomic_inst>(i)){
       id++;
-      layouts_[id] = new shared_layout(nullptr, {}, {1}, {atom}, atom->get_type()->get_scalar_ty(), align_);
+      layouts_[id] = new shared_layout(nullptr, {}, {1}, {atom}, atom->get_type()->get_scalar_ty(), align_, tgt_);
       tmp_[atom] = id;
     }
   });
@@ -2,7 +2,9 @@
 #include <iostream>
 #include "triton/codegen/analysis/liveness.h"
 #include "triton/codegen/analysis/layout.h"
+#include "triton/ir/basic_block.h"
 #include "triton/ir/function.h"
+#include "triton/ir/instructions.h"
 #include "triton/ir/module.h"
 #include "triton/ir/utils.h"
 
@@ -11,17 +13,102 @@ namespace codegen{
 namespace analysis{
 
 
+// Backward dataflow over the CFG. A value used by a phi node is live out of
+// the corresponding predecessor, so values used across a back-edge stay live
+// over the whole loop body.
 void liveness::run(ir::module &mod) {
   intervals_.clear();
 
-  // Assigns index to each instruction
-  std::map<ir::value*, slot_index> indices;
+  // values to track
+  std::set<ir::value*> tracked;
+  for(auto &x: layouts_->get_all())
+    if(shared_layout* layout = x.second->to_shared())
+      for(ir::value *v: layout->get_values())
+        tracked.insert(v);
+
+  std::map<ir::value*, segment> value_intervals;
   for(ir::function *fn: mod.get_function_list()){
+    // Assigns index to each instruction, in reverse post-order so
+    // that definitions come before their uses outside of loops
+    std::vector<ir::basic_block*> rpo = ir::cfg::reverse_post_order(fn);
+    std::map<ir::value*, slot_index> indices;
+    std::map<ir::basic_block*, segment> ranges;
     slot_index index = 0;
-    for(ir::basic_block *block: fn->blocks())
+    for(ir::basic_block *block: rpo){
+      slot_index first = index + 1;
+      for(ir::instruction *instr: block->get_inst_list()){
+        index += 1;
+        indices.insert({instr, index});
+      }
+      ranges[block] = segment{first, index + 1};
+    }
+    // local uses and definitions
+    std::map<ir::basic_block*, std::set<ir::value*>> use, def, phi_use, live_in, live_out;
+    for(ir::basic_block *block: rpo)
     for(ir::instruction *instr: block->get_inst_list()){
-      index += 1;
-      indices.insert({instr, index});
+      if(auto *phi = ir::dyn_cast<ir::phi_node>(instr)){
+        for(unsigned n = 0; n < phi->get_num_incoming(); n++)
+          if(tracked.count(phi->get_incoming_value(n)))
+            phi_use[phi->get_incoming_block(n)].insert(phi->get_incoming_value(n));
+      }
+      else {
+        for(ir::value *op: instr->ops())
+          if(tracked.count(op) && !def[block].count(op))
+            use[block].insert(op);
+      }
+      if(tracked.count(instr))
+        def[block].insert(instr);
+    }
+    // solve
+    bool changed = true;
+    while(changed){
+      changed = false;
+      for(auto it = rpo.rbegin(); it != rpo.rend(); ++it){
+        ir::basic_block *block = *it;
+        std::set<ir::value*> out = phi_use[block];
+        for(ir::basic_block *succ: block->get_successors())
+          out.insert(live_in[succ].begin(), live_in[succ].end());
+        std::set<ir::value*> in = use[block];
+        for(ir::value *v: out)
+          if(!def[block].count(v))
+            in.insert(v);
+        if(in != live_in[block] || out != live_out[block]){
+          live_in[block] = in;
+          live_out[block] = out;
+          changed = true;
+        }
+      }
+    }
+    // live range of each value within each block
+    auto extend = [&](ir::value *v, slot_index start, slot_index end) {
+      auto it = value_intervals.find(v);
+      if(it == value_intervals.end())
+        value_intervals[v] = segment{start, end};
+      else {
+        it->second.start = std::min(it->second.start, start);
+        it->second.end = std::max(it->second.end, end);
+      }
+    };
+    for(ir::basic_block *block: rpo){
+      segment range = ranges.at(block);
+      std::map<ir::value*, slot_index> starts, ends;
+      for(ir::value *v: live_in[block])
+        starts[v] = range.start;
+      for(ir::instruction *instr: block->get_inst_list()){
+        slot_index idx = indices.at(instr);
+        if(!ir::isa<ir::phi_node>(instr))
+          for(ir::value *op: instr->ops())
+            if(tracked.count(op))
+              ends[op] = idx;
+        if(tracked.count(instr)){
+          starts[instr] = idx;
+          ends[instr] = idx;
+        }
+      }
+      for(ir::value *v: live_out[block])
+        ends[v] = range.end;
+      for(auto &x: starts)
+        extend(x.first, x.second, std::max(x.second, ends[x.first]));
     }
   }
 
@@ -30,28 +117,19 @@ void liveness::run(ir::module &mod) {
     shared_layout* layout = x.second->to_shared();
     if(!layout)
       continue;
-    // users
-    std::set<ir::user*> users;
-    for(ir::value *v: layout->get_values()){
-      for(ir::user *u: v->get_users())
-        users.insert(u);
-    }
-    // compute intervals
     unsigned start = INT32_MAX;
-    for(ir::value *v: layout->get_values())
-      if(indices.find(v) != indices.end())
-        start = std::min(start, indices.at(v));
     unsigned end = 0;
-    for(ir::user *u: users)
-      if(indices.find(u) != indices.end())
-        end = std::max(end, indices.at(u));
-    if(end == 0)
+    for(ir::value *v: layout->get_values()){
+      auto it = value_intervals.find(v);
+      if(it == value_intervals.end())
+        continue;
+      start = std::min(start, it->second.start);
+      end = std::max(end, it->second.end);
+    }
+    if(end <= start)
       end = start + 1;
     intervals_[layout] = segment{start, end};
   }
-
-
-
 }
 
 }
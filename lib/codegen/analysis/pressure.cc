@@ -0,0 +1,121 @@
+#include <algorithm>
+#include "triton/codegen/analysis/pressure.h"
+#include "triton/codegen/analysis/layout.h"
+#include "triton/ir/basic_block.h"
+#include "triton/ir/function.h"
+#include "triton/ir/instructions.h"
+#include "triton/ir/module.h"
+#include "triton/ir/type.h"
+#include "triton/ir/utils.h"
+
+namespace triton{
+namespace codegen{
+namespace analysis{
+
+unsigned pressure::get(ir::value *v) {
+  auto it = registers_.find(v);
+  if(it != registers_.end())
+    return it->second;
+  // splat and broadcast repeat the registers of their operand
+  if(auto *i = ir::dyn_cast<ir::instruction>(v))
+    if(i->get_id() == ir::INST_SPLAT || i->get_id() == ir::INST_BROADCAST)
+      return registers_[v] = get(i->get_operand(0));
+  ir::type *ty = v->get_type();
+  ir::type *scalar_ty = ty->get_scalar_ty();
+  unsigned bits = scalar_ty->is_pointer_ty() ? 64 : scalar_ty->get_primitive_size_in_bits();
+  // elements held by each thread
+  unsigned elements = 1;
+  if(ty->is_block_ty()){
+    data_layout *layout = layouts_->has(v) ? layouts_->get(v) : nullptr;
+    if(!layout || layout->to_shared())
+      elements = 0;
+    else if(scanline_layout *scanline = layout->to_scanline()){
+      for(size_t k = 0; k < scanline->get_rank(); k++)
+        elements *= scanline->nts(k) * std::max(1, scanline->rep_per_cta(k));
+    }
+    else
+      elements = std::max<unsigned>(1, ty->get_tile_num_elements() / (num_warps_ * 32));
+  }
+  // narrow elements are packed
+  unsigned res = (elements * bits + 31) / 32;
+  registers_[v] = res;
+  return res;
+}
+
+void pressure::run(ir::function *fn) {
+  std::vector<ir::basic_block*> rpo = ir::cfg::reverse_post_order(fn);
+  // local uses and definitions
+  std::map<ir::basic_block*, std::set<ir::value*>> use, def, phi_use, live_in, live_out;
+  for(ir::basic_block *block: rpo)
+  for(ir::instruction *instr: block->get_inst_list()){
+    if(auto *phi = ir::dyn_cast<ir::phi_node>(instr)){
+      for(unsigned n = 0; n < phi->get_num_incoming(); n++)
+        if(ir::isa<ir::instruction>(phi->get_incoming_value(n)))
+          phi_use[phi->get_incoming_block(n)].insert(phi->get_incoming_value(n));
+    }
+    else {
+      for(ir::value *op: instr->ops())
+        if(ir::isa<ir::instruction>(op) && !def[block].count(op))
+          use[block].insert(op);
+    }
+    def[block].insert(instr);
+  }
+  // solve
+  bool changed = true;
+  while(changed){
+    changed = false;
+    for(auto it = rpo.rbegin(); it != rpo.rend(); ++it){
+      ir::basic_block *block = *it;
+      std::set<ir::value*> out = phi_use[block];
+      for(ir::basic_block *succ: block->get_successors())
+        out.insert(live_in[succ].begin(), live_in[succ].end());
+      std::set<ir::value*> in = use[block];
+      for(ir::value *v: out)
+        if(!def[block].count(v))
+          in.insert(v);
+      if(in != live_in[block] || out != live_out[block]){
+        live_in[block] = in;
+        live_out[block] = out;
+        changed = true;
+      }
+    }
+  }
+  // walk each block backward from its live-out set
+  for(ir::basic_block *block: rpo){
+    std::set<ir::value*> live = live_out[block];
+    unsigned num_live = 0;
+    for(ir::value *v: live)
+      num_live += get(v);
+    auto update = [&]() {
+      if(num_live > max_live_){
+        max_live_ = num_live;
+        peak_ = live;
+      }
+    };
+    update();
+    auto &insts = block->get_inst_list();
+    for(auto it = insts.rbegin(); it != insts.rend(); ++it){
+      ir::instruction *instr = *it;
+      if(live.erase(instr))
+        num_live -= get(instr);
+      if(ir::isa<ir::phi_node>(instr))
+        continue;
+      for(ir::value *op: instr->ops())
+        if(ir::isa<ir::instruction>(op) && live.insert(op).second)
+          num_live += get(op);
+      update();
+    }
+  }
+}
+
+void pressure::run(ir::module &mod) {
+  registers_.clear();
+  peak_.clear();
+  max_live_ = 0;
+  for(ir::function *fn: mod.get_function_list())
+    run(fn);
+}
+
+}
+}
+}
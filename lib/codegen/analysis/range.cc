@@ -0,0 +1,370 @@
+#include <algorithm>
+#include <limits>
+#include "triton/codegen/analysis/range.h"
+#include "triton/ir/utils.h"
+#include "triton/ir/module.h"
+#include "triton/ir/function.h"
+#include "triton/ir/basic_block.h"
+#include "triton/ir/instructions.h"
+#include "triton/ir/constant.h"
+#include "triton/ir/type.h"
+
+namespace triton {
+namespace codegen{
+namespace analysis{
+
+// number of fixed-point iterations before loop-carried values are widened
+static const int max_iterations = 8;
+
+static const int64_t i64_min = std::numeric_limits<int64_t>::min();
+static const int64_t i64_max = std::numeric_limits<int64_t>::max();
+
+typedef range::interval interval;
+
+static interval join(const interval &a, const interval &b) {
+  return {std::min(a.lo, b.lo), std::max(a.hi, b.hi)};
+}
+
+static bool is_singleton(const interval &a) {
+  return a.lo == a.hi;
+}
+
+/// smallest 2^k - 1 greater or equal to `x`
+static int64_t fill_ones(int64_t x) {
+  int64_t res = 0;
+  while(res < x)
+    res = (res << 1) | 1;
+  return res;
+}
+
+static unsigned get_bitwidth(ir::type *ty) {
+  return ty->get_scalar_ty()->get_integer_bitwidth();
+}
+
+/// bounds of `op` applied to all corners of `a` and `b`;
+/// returns false on overflow
+template<class F>
+static bool apply_corners(const interval &a, const interval &b, F op, interval &res) {
+  int64_t corners[4];
+  if(op(a.lo, b.lo, corners[0]) || op(a.lo, b.hi, corners[1]) ||
+     op(a.hi, b.lo, corners[2]) || op(a.hi, b.hi, corners[3]))
+    return false;
+  res = {*std::min_element(corners, corners + 4), *std::max_element(corners, corners + 4)};
+  return true;
+}
+
+interval range::get_full(ir::type *ty) {
+  ir::type *scalar_ty = ty->get_scalar_ty();
+  if(!scalar_ty->is_integer_ty())
+    return {i64_min, i64_max};
+  unsigned bits = scalar_ty->get_integer_bitwidth();
+  if(bits == 1)
+    return {0, 1};
+  if(bits >= 64)
+    return {i64_min, i64_max};
+  return {-(int64_t(1) << (bits - 1)), (int64_t(1) << (bits - 1)) - 1};
+}
+
+/// values outside of the range of `ty` wrap around
+interval range::fit(interval x, ir::type *ty) {
+  interval full = get_full(ty);
+  if(x.lo < full.lo || x.hi > full.hi)
+    return full;
+  return x;
+}
+
+/*
+ * transfer functions
+ */
+
+interval range::populate_phi(ir::phi_node *x) {
+  interval res = {i64_max, i64_min};
+  for(unsigned n = 0; n < x->get_num_incoming(); n++){
+    ir::value *inc = x->get_incoming_value(n);
+    // back-edges not visited yet
+    if(ir::isa<ir::instruction>(inc) && ranges_.find(inc) == ranges_.end())
+      continue;
+    res = join(res, get(inc));
+  }
+  if(res.lo > res.hi)
+    return get_full(x->get_type());
+  return res;
+}
+
+interval range::populate_binop(ir::binary_operator *x) {
+  ir::type *ty = x->get_type();
+  interval full = get_full(ty);
+  unsigned bits = get_bitwidth(ty);
+  interval lhs = get(x->get_operand(0));
+  interval rhs = get(x->get_operand(1));
+  interval res = full;
+  switch(x->get_op()){
+    case ir::binary_op_t::Add:
+      if(!apply_corners(lhs, rhs, [](int64_t a, int64_t b, int64_t &c) { return __builtin_add_overflow(a, b, &c); }, res))
+        return full;
+      break;
+    case ir::binary_op_t::Sub:
+      if(!apply_corners(lhs, rhs, [](int64_t a, int64_t b, int64_t &c) { return __builtin_sub_overflow(a, b, &c); }, res))
+        return full;
+      break;
+    case ir::binary_op_t::Mul:
+      if(!apply_corners(lhs, rhs, [](int64_t a, int64_t b, int64_t &c) { return __builtin_mul_overflow(a, b, &c); }, res))
+        return full;
+      break;
+    case ir::binary_op_t::Shl:
+      if(!is_singleton(rhs) || rhs.lo < 0 || rhs.lo >= std::min<int64_t>(bits, 63))
+        return full;
+      if(!apply_corners(lhs, {int64_t(1) << rhs.lo, int64_t(1) << rhs.lo},
+                        [](int64_t a, int64_t b, int64_t &c) { return __builtin_mul_overflow(a, b, &c); }, res))
+        return full;
+      break;
+    case ir::binary_op_t::SDiv:
+    case ir::binary_op_t::UDiv:
+      if(x->get_op() == ir::binary_op_t::UDiv && (lhs.lo < 0 || rhs.lo < 0))
+        return full;
+      // division by zero or INT_MIN / -1
+      if((rhs.lo <= 0 && rhs.hi >= 0) || (lhs.lo == full.lo && rhs.lo <= -1 && rhs.hi >= -1))
+        return full;
+      apply_corners(lhs, rhs, [](int64_t a, int64_t b, int64_t &c) { c = a / b; return false; }, res);
+      break;
+    case ir::binary_op_t::SRem:
+    case ir::binary_op_t::URem: {
+      if(x->get_op() == ir::binary_op_t::URem && lhs.lo < 0)
+        return full;
+      if(rhs.lo <= 0)
+        return full;
+      // the result has the sign of the dividend
+      int64_t max_abs = rhs.hi - 1;
+      res.lo = lhs.lo >= 0 ? 0 : std::max(lhs.lo, -max_abs);
+      res.hi = lhs.hi <= 0 ? 0 : std::min(lhs.hi, max_abs);
+      break;
+    }
+    case ir::binary_op_t::AShr:
+    case ir::binary_op_t::LShr:
+      if(lhs.lo < 0 || rhs.lo < 0 || rhs.hi >= bits)
+        return full;
+      res = {lhs.lo >> rhs.hi, lhs.hi >> rhs.lo};
+      break;
+    case ir::binary_op_t::And:
+      if(bits == 1)
+        res = {lhs.lo & rhs.lo, lhs.hi & rhs.hi};
+      else if(lhs.lo >= 0 && rhs.lo >= 0)
+        res = {0, std::min(lhs.hi, rhs.hi)};
+      else if(lhs.lo >= 0 || rhs.lo >= 0)
+        res = {0, lhs.lo >= 0 ? lhs.hi : rhs.hi};
+      break;
+    case ir::binary_op_t::Or:
+      if(bits == 1)
+        res = {lhs.lo | rhs.lo, lhs.hi | rhs.hi};
+      else if(lhs.lo >= 0 && rhs.lo >= 0)
+        res = {std::max(lhs.lo, rhs.lo), fill_ones(std::max(lhs.hi, rhs.hi))};
+      break;
+    case ir::binary_op_t::Xor:
+      if(is_singleton(lhs) && is_singleton(rhs))
+        res = {lhs.lo ^ rhs.lo, lhs.lo ^ rhs.lo};
+      else if(lhs.lo >= 0 && rhs.lo >= 0)
+        res = {0, fill_ones(std::max(lhs.hi, rhs.hi))};
+      break;
+    default:
+      break;
+  }
+  return fit(res, ty);
+}
+
+interval range::populate_icmp(ir::icmp_inst *x) {
+  ir::cmp_pred_t pred = x->get_pred();
+  interval lhs = get(x->get_operand(0));
+  interval rhs = get(x->get_operand(1));
+  interval unknown = {0, 1};
+  bool is_signed = pred >= ir::ICMP_SGT && pred <= ir::ICMP_SLE;
+  bool is_unsigned = pred >= ir::ICMP_UGT && pred <= ir::ICMP_ULE;
+  // booleans are represented as 0/1, and negative values as signed
+  if(is_signed && get_bitwidth(x->get_operand(0)->get_type()) == 1)
+    return unknown;
+  if(is_unsigned && (lhs.lo < 0 || rhs.lo < 0))
+    return unknown;
+  bool is_true, is_false;
+  switch(pred){
+    case ir::ICMP_EQ:
+    case ir::ICMP_NE:
+      is_true = is_singleton(lhs) && lhs == rhs;
+      is_false = lhs.hi < rhs.lo || rhs.hi < lhs.lo;
+      if(pred == ir::ICMP_NE)
+        std::swap(is_true, is_false);
+      break;
+    case ir::ICMP_SLT:
+    case ir::ICMP_ULT:
+      is_true = lhs.hi < rhs.lo;
+      is_false = lhs.lo >= rhs.hi;
+      break;
+    case ir::ICMP_SLE:
+    case ir::ICMP_ULE:
+      is_true = lhs.hi <= rhs.lo;
+      is_false = lhs.lo > rhs.hi;
+      break;
+    case ir::ICMP_SGT:
+    case ir::ICMP_UGT:
+      is_true = lhs.lo > rhs.hi;
+      is_false = lhs.hi <= rhs.lo;
+      break;
+    case ir::ICMP_SGE:
+    case ir::ICMP_UGE:
+      is_true = lhs.lo >= rhs.hi;
+      is_false = lhs.hi < rhs.lo;
+      break;
+    default:
+      return unknown;
+  }
+  if(is_true)
+    return {1, 1};
+  if(is_false)
+    return {0, 0};
+  return unknown;
+}
+
+interval range::populate_cast(ir::cast_inst *x) {
+  ir::value *arg = x->get_operand(0);
+  ir::type *ty = x->get_type();
+  if(!arg->get_type()->get_scalar_ty()->is_integer_ty())
+    return get_full(ty);
+  unsigned src_bits = get_bitwidth(arg->get_type());
+  interval src = get(arg);
+  switch(x->get_op()){
+    case ir::cast_op_t::ZExt:
+      if(src.lo >= 0)
+        return src;
+      return src_bits < 64 ? interval{0, (int64_t(1) << src_bits) - 1} : get_full(ty);
+    case ir::cast_op_t::SExt:
+      // true is all ones
+      if(src_bits == 1)
+        return {-src.hi, -src.lo};
+      return src;
+    case ir::cast_op_t::Trunc:
+      return fit(src, ty);
+    default:
+      return get_full(ty);
+  }
+}
+
+interval range::populate(ir::instruction *i) {
+  switch(i->get_id()){
+    case ir::INST_PHI:
+      return populate_phi((ir::phi_node*)i);
+    case ir::INST_BINOP:
+      return populate_binop((ir::binary_operator*)i);
+    case ir::INST_ICMP:
+      return populate_icmp((ir::icmp_inst*)i);
+    case ir::INST_SPLAT:
+    case ir::INST_BROADCAST:
+    case ir::INST_RESHAPE:
+    case ir::INST_DOWNCAST:
+    case ir::INST_TRANS:
+      return get(i->get_operand(0));
+    case ir::INST_MAKE_RANGE: {
+      auto *x = (ir::make_range*)i;
+      return {(int64_t)x->get_first()->get_value(), (int64_t)x->get_last()->get_value() - 1};
+    }
+    // limits of the CUDA grid
+    case ir::INST_GET_PROGRAM_ID:
+      if(((ir::get_program_id_inst*)i)->get_axis() == 0)
+        return {0, (int64_t(1) << 31) - 2};
+      return {0, 65534};
+    case ir::INST_GET_NUM_PROGRAMS:
+      if(((ir::get_num_programs_inst*)i)->get_axis() == 0)
+        return {1, (int64_t(1) << 31) - 1};
+      return {1, 65535};
+    case ir::INST_SELECT: {
+      auto *x = (ir::select_inst*)i;
+      interval pred = get(x->get_pred_op());
+      if(pred.lo == 1)
+        return get(x->get_if_value_op());
+      if(pred.hi == 0)
+        return get(x->get_else_value_op());
+      return join(get(x->get_if_value_op()), get(x->get_else_value_op()));
+    }
+    case ir::INST_REDUCE: {
+      auto *x = (ir::reduce_inst*)i;
+      if(x->get_op() == ir::reduce_inst::MAX || x->get_op() == ir::reduce_inst::MIN)
+        return get(x->get_operand(0));
+      if(x->is_arg_op())
+        return interval{0, x->get_operand(0)->get_type()->get_block_shapes()[x->get_axis()] - 1};
+      return get_full(i->get_type());
+    }
+    case ir::INST_SORT:
+      return get(i->get_operand(0));
+    case ir::INST_SCAN: {
+      auto *x = (ir::scan_inst*)i;
+      if(x->get_op() == ir::scan_inst::MAX || x->get_op() == ir::scan_inst::MIN)
+        return get(x->get_operand(0));
+      return get_full(i->get_type());
+    }
+    default:
+      if(auto *x = ir::dyn_cast<ir::cast_inst>(i))
+        return populate_cast(x);
+      return get_full(i->get_type());
+  }
+}
+
+/*
+ * query
+ */
+
+interval range::get(ir::value *v) {
+  auto it = ranges_.find(v);
+  if(it != ranges_.end())
+    return it->second;
+  ir::type *ty = v->get_type();
+  if(auto *x = ir::dyn_cast<ir::constant_int>(v)){
+    unsigned bits = get_bitwidth(ty);
+    uint64_t value = x->get_value();
+    if(bits == 1)
+      value &= 1;
+    else if(bits < 64)
+      value = ((value & ((uint64_t(1) << bits) - 1)) ^ (uint64_t(1) << (bits - 1))) - (uint64_t(1) << (bits - 1));
+    return {(int64_t)value, (int64_t)value};
+  }
+  return get_full(ty);
+}
+
+bool range::is_true(ir::value *v) {
+  return get_bitwidth(v->get_type()) == 1 && get(v).lo == 1;
+}
+
+bool range::is_false(ir::value *v) {
+  return get_bitwidth(v->get_type()) == 1 && get(v).hi == 0;
+}
+
+void range::run(ir::module &mod) {
+  ranges_.clear();
+  for(ir::function *fn: mod.get_function_list()){
+    std::vector<ir::basic_block*> rpo = ir::cfg::reverse_post_order(fn);
+    // iterate to a fixed point
+    bool changed = true;
+    for(int iter = 0; changed; iter++){
+      changed = false;
+      for(ir::basic_block *block: rpo)
+      for(ir::instruction *i: block->get_inst_list()){
+        ir::type *ty = i->get_type();
+        if(!ty->get_scalar_ty()->is_integer_ty())
+          continue;
+        interval x = populate(i);
+        auto it = ranges_.find(i);
+        if(it != ranges_.end()){
+          if(it->second == x)
+            continue;
+          // loop-carried values that keep changing are widened
+          if(iter >= max_iterations)
+            x = join(it->second, x) == it->second ? it->second : get_full(ty);
+          if(it->second == x)
+            continue;
+        }
+        ranges_[i] = x;
+        changed = true;
+      }
+    }
+  }
+}
+
+}
+}
+}
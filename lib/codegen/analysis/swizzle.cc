@@ -14,7 +14,7 @@ void swizzle::run(ir::module &) {
     max_phase_.clear();
 
     for(auto &x: layouts_->get_all()){
-      shared_layout* layout = dynamic_cast<shared_layout*>(x.second);
+      shared_layout* layout = x.second->to_shared();
       if(!layout)
         continue;
       ir::value* mma_dot_a = layout->hmma_dot_a();
@@ -30,7 +30,7 @@ void swizzle::run(ir::module &) {
       if(!in_layout)
         continue;
       int dtsize = layout->get_type()->get_scalar_ty()->get_primitive_size_in_bits() / 8;
-      if(tgt_->as_nvidia()->sm() < 80){
+      if(tgt_->as_nvidia()->sm() < 80 && layout->get_type()->is_fp16_ty()){
         int inner = mma_dot_a ? 0 : 1;
         per_phase_[layout] = std::max<int>(128 / (in_layout->mts(ord[0])*in_layout->nts(ord[0])*dtsize), 1);
         max_phase_[layout] = (ord[inner] == 1 ? 8 : 4) / per_phase_[layout];
@@ -42,7 +42,7 @@ void swizzle::run(ir::module &) {
       else{
         per_phase_[layout] = std::max<int>(128 / (in_layout->mts(ord[0])*in_layout->nts(ord[0])*dtsize), 1);
         max_phase_[layout] = 8 / per_phase_[layout];
-        vec_[layout]       = 8;
+        vec_[layout]       = 16 / dtsize;
       }
     }
 }
@@ -3,69 +3,115 @@
 #include "triton/codegen/analysis/allocation.h"
 #include "triton/codegen/analysis/axes.h"
 #include "triton/codegen/analysis/liveness.h"
+#include "triton/codegen/analysis/pressure.h"
+#include "triton/codegen/analysis/range.h"
 #include "triton/codegen/analysis/swizzle.h"
 #include "triton/codegen/selection/generator.h"
 #include "triton/codegen/transform/coalesce.h"
 #include "triton/codegen/transform/cts.h"
 #include "triton/codegen/transform/dce.h"
 #include "triton/codegen/transform/disassociate.h"
+#include "triton/codegen/transform/gvn.h"
+#include "triton/codegen/transform/licm.h"
 #include "triton/codegen/transform/membar.h"
 #include "triton/codegen/transform/peephole.h"
 #include "triton/codegen/transform/pipeline.h"
 #include "triton/codegen/transform/prefetch.h"
+#include "triton/codegen/transform/reassociate.h"
+#include "triton/codegen/transform/rematerialize.h"
+#include "triton/codegen/transform/simplify.h"
+#include "triton/codegen/transform/strength_reduce.h"
+#include "triton/codegen/transform/unroll.h"
 #include "triton/driver/device.h"
 #include "triton/driver/kernel.h"
 #include "triton/driver/module.h"
 #include "triton/ir/function.h"
 #include "triton/ir/module.h"
 #include "triton/ir/print.h"
+#include "triton/tools/sys/getenv.hpp"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/raw_ostream.h"
+#include <iostream>
 
 namespace triton {
 namespace codegen {
 
-// TODO:
-// There should be a proper pass manager there!
-void add_passes_to_emit_bin(ir::module &ir, driver::device *dev, int num_warps, int num_stages, bool force_nc_cache,
-                            driver::module *&mod, driver::kernel *&ker, size_t &shared_mem) {
-  // generate llvm code
-  llvm::LLVMContext ctx;
-  std::string name = ir.get_function_list()[0]->get_name();
-  std::unique_ptr<llvm::Module> llvm(new llvm::Module(name, ctx));
-  // optimizations
-  std::unique_ptr<codegen::target> target = dev->make_target();
-  bool cts_use_async = target->as_nvidia()->sm() >= 80;
-  // create passes
+struct lowering::passes {
+  passes(codegen::target *target, int num_warps, int num_stages, bool force_nc_cache)
+    : tgt(target),
+      cts_use_async(target->as_nvidia()->sm() >= 80),
+      cts(cts_use_async),
+      pipeline(cts_use_async, num_stages),
+      layouts(&axes, &align, num_warps, target),
+      liveness(&layouts),
+      swizzle(&layouts, target),
+      allocation(&liveness),
+      pressure(&layouts, num_warps),
+      peephole(target, &layouts, &range),
+      rematerialize(&pressure, num_warps),
+      coalesce(&align, &layouts),
+      prefetch_s(target),
+      barriers(&liveness, &layouts, &allocation, &prefetch_s, target),
+      isel(&axes, &layouts, &align, &allocation, &swizzle, target, num_warps, force_nc_cache) { }
+  void run(ir::module &ir);
+
+  codegen::target *tgt;
+  bool cts_use_async;
   codegen::analysis::align align;
+  codegen::analysis::range range;
   codegen::analysis::axes axes;
-  codegen::transform::cts cts(cts_use_async);
-  codegen::transform::pipeline pipeline(cts_use_async, num_stages);
+  codegen::transform::cts cts;
+  codegen::transform::unroll unroll;
+  codegen::transform::simplify simplify;
+  codegen::transform::gvn gvn;
+  codegen::transform::licm licm;
+  codegen::transform::pipeline pipeline;
+  codegen::transform::strength_reduce strength_reduce;
   codegen::transform::disassociate disassociate;
-  codegen::analysis::layouts layouts(&axes, &align, num_warps, target.get());
-  codegen::analysis::liveness liveness(&layouts);
-  codegen::analysis::swizzle swizzle(&layouts, target.get());
-  codegen::analysis::allocation allocation(&liveness);
+  codegen::analysis::layouts layouts;
+  codegen::analysis::liveness liveness;
+  codegen::analysis::swizzle swizzle;
+  codegen::analysis::allocation allocation;
+  codegen::analysis::pressure pressure;
   codegen::transform::dce dce;
-  codegen::transform::peephole peephole(target.get(), &layouts);
-//  codegen::transform::reassociate reassociate;
-  codegen::transform::coalesce coalesce(&align, &layouts);
-  codegen::transform::prefetch prefetch_s(target.get());
-  codegen::transform::membar barriers(&liveness, &layouts, &allocation, &prefetch_s, target.get());
-  codegen::generator isel(&axes, &layouts, &align, &allocation, &swizzle, target.get(), num_warps, force_nc_cache);
+  codegen::transform::peephole peephole;
+  codegen::transform::reassociate reassociate;
+  codegen::transform::rematerialize rematerialize;
+  codegen::transform::coalesce coalesce;
+  codegen::transform::prefetch prefetch_s;
+  codegen::transform::membar barriers;
+  codegen::generator isel;
+};
+
+// TODO:
+// There should be a proper pass manager there!
+void lowering::passes::run(ir::module &ir) {
+  std::string name = ir.get_function_list()[0]->get_name();
   // run passes
   dce.run(ir);
+  range.run(ir);
   peephole.run(ir);
   dce.run(ir);
+  unroll.run(ir);
+  simplify.run(ir);
+  reassociate.run(ir);
+  gvn.run(ir);
+  licm.run(ir);
+  dce.run(ir);
   pipeline.run(ir);
   dce.run(ir);
+  // after pipelining, which matches pointer phis
+  strength_reduce.run(ir);
+  dce.run(ir);
   disassociate.run(ir);
   dce.run(ir);
   align.run(ir);
   axes.run(ir);
   layouts.run(ir);
+  range.run(ir);
   peephole.run(ir);
   dce.run(ir);
-  if (target->is_gpu())
+  if (tgt->is_gpu())
     cts.run(ir);
   align.run(ir);
   axes.run(ir);
@@ -76,28 +122,89 @@ void add_passes_to_emit_bin(ir::module &ir, driver::device *dev, int num_warps,
 
   align.run(ir);
   dce.run(ir);
-  if (target->is_gpu())
+  if (tgt->is_gpu())
     cts.run(ir);
   dce.run(ir);
   align.run(ir);
 //  ir::print(ir, std::cout);
   axes.run(ir);
   layouts.run(ir);
+  range.run(ir);
   peephole.run(ir);
   dce.run(ir);
   align.run(ir);
   axes.run(ir);
   layouts.run(ir);
+  pressure.run(ir);
+  rematerialize.run(ir);
+  dce.run(ir);
+  align.run(ir);
+  axes.run(ir);
+  layouts.run(ir);
+  pressure.run(ir);
   swizzle.run(ir);
   liveness.run(ir);
   allocation.run(ir);
   prefetch_s.run(ir);
   barriers.run(ir);
   // ir.print(std::cout);
-  isel.visit(ir, *llvm);
-  mod = driver::module::create(dev, std::move(llvm));
+  if (tools::getenv("TRITON_PASS_STATS") == "1") {
+    std::cerr << name << ": simplify removed " << simplify.num_simplified() << " instructions" << std::endl;
+    std::cerr << name << ": reassociate rewrote " << reassociate.num_rewritten() << " pointers" << std::endl;
+    std::cerr << name << ": gvn removed " << gvn.num_removed() << " instructions ("
+              << gvn.num_removed_elements() << " block elements)" << std::endl;
+    std::cerr << name << ": licm hoisted " << licm.num_hoisted() << " instructions" << std::endl;
+    std::cerr << name << ": strength_reduce rewrote " << strength_reduce.num_rewritten() << " pointer induction variables" << std::endl;
+    std::cerr << name << ": peephole removed " << peephole.num_masks_removed() << " masks" << std::endl;
+    std::cerr << name << ": rematerialize recomputed " << rematerialize.num_rematerialized() << " values, "
+              << pressure.max_live() << " registers per thread estimated" << std::endl;
+    std::cerr << name << ": allocation used " << allocation.allocated_size() << " bytes of shared memory ("
+              << allocation.wasted_size() << " wasted, legacy allocator: " << allocation.legacy_allocated_size() << ")" << std::endl;
+  }
+}
+
+lowering::lowering(ir::module &ir, driver::device *dev, int num_warps, int num_stages, bool force_nc_cache)
+  : ir_(ir), dev_(dev), target_(dev->make_target()),
+    passes_(new passes(target_.get(), num_warps, num_stages, force_nc_cache)) {
+  passes_->run(ir_);
+  shared_mem_ = passes_->allocation.allocated_size();
+  num_registers_ = passes_->pressure.max_live();
+}
+
+lowering::~lowering() { }
+
+void lowering::emit_bin(driver::module *&mod, driver::kernel *&ker) {
+  // generate llvm code
+  llvm::LLVMContext ctx;
+  std::string name = ir_.get_function_list()[0]->get_name();
+  std::unique_ptr<llvm::Module> llvm(new llvm::Module(name, ctx));
+  passes_->isel.visit(ir_, *llvm);
+  mod = driver::module::create(dev_, std::move(llvm));
   ker = driver::kernel::create(&*mod, name.c_str());
-  shared_mem = allocation.allocated_size();
+}
+
+std::string lowering::llir() {
+  llvm::LLVMContext ctx;
+  std::string name = ir_.get_function_list()[0]->get_name();
+  llvm::Module llvm(name, ctx);
+  passes_->isel.visit(ir_, llvm);
+  std::string ret;
+  llvm::raw_string_ostream os(ret);
+  llvm.print(os, nullptr);
+  return os.str();
+}
+
+void add_passes_to_emit_bin(ir::module &ir, driver::device *dev, int num_warps, int num_stages, bool force_nc_cache,
+                            driver::module *&mod, driver::kernel *&ker, size_t &shared_mem) {
+  lowering lowered(ir, dev, num_warps, num_stages, force_nc_cache);
+  lowered.emit_bin(mod, ker);
+  shared_mem = lowered.shared_mem();
+}
+
+unsigned estimate_registers(ir::module &ir, driver::device *dev, int num_warps, int num_stages, size_t &shared_mem) {
+  lowering lowered(ir, dev, num_warps, num_stages, false);
+  shared_mem = lowered.shared_mem();
+  return lowered.num_registers();
 }
 
 } // namespace codegen
@@ -251,20 +251,20 @@ void generator::visit_value(ir::value* v) {
   }
   // visit operands
   BasicBlock *current = builder_->GetInsertBlock();
-  auto *inst = dynamic_cast<ir::instruction*>(v);
+  auto *inst = ir::dyn_cast<ir::instruction>(v);
   if(inst)
     for(ir::value *op: inst->ops()){
-      if(dynamic_cast<ir::constant*>(op) || !dynamic_cast<ir::phi_node*>(v))
+      if(ir::isa<ir::constant>(op) || !ir::isa<ir::phi_node>(v))
         visit_value(op);
     }
   init_idx(v);
   // change insert point for phi node
   builder_->SetInsertPoint(current);
-  auto *phi = dynamic_cast<ir::phi_node*>(v);
+  auto *phi = ir::dyn_cast<ir::phi_node>(v);
   if(phi && !current->empty() && current->getFirstNonPHI())
     builder_->SetInsertPoint(&*current->getFirstNonPHI());
   // visit user
-  if(auto *usr = dynamic_cast<ir::user*>(v)){
+  if(auto *usr = ir::dyn_cast<ir::user>(v)){
     usr->accept(this);
   }
   // revert insert point
@@ -405,28 +405,22 @@ void generator::visit_fcmp_inst(ir::fcmp_inst* x) {
 }
 
 
-std::tuple<Value*, Value*, Value*, Value*> generator::fp32x4_to_fp8x4(Value *in0, Value *in1, Value *in2, Value *in3){
-    auto cvt = [this](Value *v){
-      if(ConstantFP* ci = dyn_cast<ConstantFP>(v))
-      if(ci->getValue().convertToFloat() == 0)
-          return builder_->getInt8(0);
-      throw std::runtime_error("unsupported cast");
-    };
-    return std::make_tuple(cvt(in0), cvt(in1), cvt(in2), cvt(in3));
-}
-
-std::tuple<Value*, Value*, Value*, Value*> generator::fp8x4_to_fp32x4(Value *in0, Value *in1, Value *in2, Value *in3){
-   Value *ret0, *ret1, *ret2, *ret3;
-   std::tie(ret0, ret1, ret2, ret3) = fp8x4_to_fp16x4(in0, in1, in2, in3);
-   ret0 = cast(llvm::Instruction::FPExt, ret0, f32_ty);
-   ret1 = cast(llvm::Instruction::FPExt, ret1, f32_ty);
-   ret2 = cast(llvm::Instruction::FPExt, ret2, f32_ty);
-   ret3 = cast(llvm::Instruction::FPExt, ret3, f32_ty);
-   return std::make_tuple(ret0, ret1, ret2, ret3);
-}
-
-
-std::tuple<Value*, Value*, Value*, Value*> generator::fp8x4_to_fp16x4(Value *in0, Value *in1, Value *in2, Value *in3){
+/**
+ * \brief fp8 -> fp16 on a vector of fp8 stored as i8
+ *
+ * fp8 values are the sign, exponent and top mantissa bits of an fp16, so
+ * the conversion only moves bits: prmt + lop3 on four values at a time on
+ * NVIDIA GPUs, plain vector integer operations elsewhere.
+ */
+Value* generator::fp8_to_fp16(Value *in){
+  unsigned n = llvm::cast<llvm::FixedVectorType>(in->getType())->getNumElements();
+  if(!tgt_->as_nvidia()){
+    Type *i16x_ty = vec_ty(builder_->getInt16Ty(), n);
+    Value *x = builder_->CreateZExt(in, i16x_ty);
+    Value *sign = shl(and_(x, splat(n, builder_->getInt16(0x80))), splat(n, builder_->getInt16(8)));
+    Value *mag = shl(and_(x, splat(n, builder_->getInt16(0x7f))), splat(n, builder_->getInt16(7)));
+    return bit_cast(builder_->CreateOr(sign, mag), vec_ty(f16_ty, n));
+  }
   Type *ret_ty = StructType::get(*ctx_, {vec_ty(f16_ty, 2), vec_ty(f16_ty, 2)});
   InlineAsm *ptx = InlineAsm::get(FunctionType::get(ret_ty, {i32_ty}, false),
   "{"
@@ -440,36 +434,100 @@ std::tuple<Value*, Value*, Value*, Value*> generator::fp8x4_to_fp16x4(Value *in0
   "lop3.b32 $0, b0, 0x80008000, a0, 0xf8; \n\t" // restore sign
   "lop3.b32 $1, b1, 0x80008000, a1, 0xf8; \n\t"
   "}", "=r,=r,r", false);
-  Value *packed_in = UndefValue::get(vec_ty(i8_ty, 4));
-  packed_in = insert_elt(packed_in, in0, (int)0);
-  packed_in = insert_elt(packed_in, in1, (int)1);
-  packed_in = insert_elt(packed_in, in2, (int)2);
-  packed_in = insert_elt(packed_in, in3, (int)3);
-  Value *in = bit_cast(packed_in, i32_ty);
-  Value *ret = call(ptx, {in});
-  Value *packed_ret0 = extract_val(ret, {0});
-  Value *packed_ret1 = extract_val(ret, {1});
-  Value *ret0 = extract_elt(packed_ret0, (int)0);
-  Value *ret1 = extract_elt(packed_ret0, (int)1);
-  Value *ret2 = extract_elt(packed_ret1, (int)0);
-  Value *ret3 = extract_elt(packed_ret1, (int)1);
-  return std::make_tuple(ret0, ret1, ret2, ret3);
-}
-
-Value* generator::bf16_to_fp32(Value *in0){
-  Value *ret = UndefValue::get(vec_ty(builder_->getInt16Ty(), 2));
-  ret = insert_elt(ret, in0, (uint64_t)1);
-  ret = insert_elt(ret, builder_->getInt16(0), (uint64_t)0);
-  return bit_cast(ret, builder_->getFloatTy());
-}
-
-Value* generator::fp32_to_bf16(Value *in0){
-  if(tgt_->as_nvidia()->sm() >= 80){
-    InlineAsm *ptx = InlineAsm::get(FunctionType::get(builder_->getInt16Ty(), {builder_->getFloatTy()}, false),
-                                    "cvt.rn.bf16.f32 $0, $1;", "=h,r", false);
-    return call(ptx, {in0});
-  }
-  return extract_elt(bit_cast(in0, vec_ty(builder_->getInt16Ty(), 2)), (uint64_t)1);
+  Value *ret = UndefValue::get(vec_ty(f16_ty, n));
+  for(unsigned i = 0; i < n; i += 4){
+    Value *packed_in = ConstantAggregateZero::get(vec_ty(i8_ty, 4));
+    for(unsigned j = 0; j < 4 && i + j < n; j++)
+      packed_in = insert_elt(packed_in, extract_elt(in, i + j), j);
+    Value *packed_ret = call(ptx, {bit_cast(packed_in, i32_ty)});
+    for(unsigned j = 0; j < 4 && i + j < n; j++)
+      ret = insert_elt(ret, extract_elt(extract_val(packed_ret, {j / 2}), j % 2), i + j);
+  }
+  return ret;
+}
+
+/**
+ * \brief fp16 -> fp8 on a vector, rounding to nearest even
+ *
+ * Magnitudes beyond the largest fp8 value (and NaNs) saturate to it.
+ */
+Value* generator::fp16_to_fp8(Value *in){
+  unsigned n = llvm::cast<llvm::FixedVectorType>(in->getType())->getNumElements();
+  auto cst = [&](uint16_t v) { return splat(n, builder_->getInt16(v)); };
+  Value *x = bit_cast(in, vec_ty(builder_->getInt16Ty(), n));
+  Value *sign = lshr(and_(x, cst(0x8000)), cst(8));
+  Value *mag = and_(x, cst(0x7fff));
+  Value *odd = and_(lshr(mag, cst(7)), cst(1));
+  Value *rounded = lshr(add(add(mag, cst(0x3f)), odd), cst(7));
+  rounded = select(icmp_ult(mag, cst(0x3fc0)), rounded, cst(0x7f));
+  return builder_->CreateTrunc(builder_->CreateOr(sign, rounded), vec_ty(i8_ty, n));
+}
+
+/**
+ * \brief fp32 (or fp64) -> fp8 on a vector, rounding to nearest even
+ *
+ * Rounding to fp16 first and then to fp8 would round twice: a value just
+ * above an fp8 halfway point can round to the halfway point itself in fp16
+ * and then tie to even. The value is instead rounded to fp16 with round to
+ * odd (nearest, then stepped to the odd neighbour when inexact and even);
+ * fp16 keeps seven more mantissa bits than fp8, so rounding that to nearest
+ * even gives the correctly rounded result.
+ */
+Value* generator::fp32_to_fp8(Value *in){
+  unsigned n = llvm::cast<llvm::FixedVectorType>(in->getType())->getNumElements();
+  auto cst = [&](uint16_t v) { return splat(n, builder_->getInt16(v)); };
+  Value *h = fpcast(in, vec_ty(f16_ty, n));
+  Value *ext = fpcast(h, in->getType());
+  Value *bits = bit_cast(h, vec_ty(builder_->getInt16Ty(), n));
+  Value *inexact = fcmp(llvm::CmpInst::FCMP_UNE, ext, in);
+  Value *even = icmp_eq(and_(bits, cst(1)), cst(0));
+  // step away from zero, unless `h` was rounded away from zero
+  Value *positive = fcmp(llvm::CmpInst::FCMP_OGT, in, Constant::getNullValue(in->getType()));
+  Value *away = select(positive, fcmp(llvm::CmpInst::FCMP_OGT, ext, in), fcmp(llvm::CmpInst::FCMP_OLT, ext, in));
+  Value *odd = add(bits, select(away, cst(0xffff), cst(1)));
+  bits = select(builder_->CreateAnd(inexact, even), odd, bits);
+  return fp16_to_fp8(bit_cast(bits, vec_ty(f16_ty, n)));
+}
+
+/**
+ * \brief bf16 -> fp32 on a vector of bf16 stored as i16
+ */
+Value* generator::bf16_to_fp32(Value *in){
+  unsigned n = llvm::cast<llvm::FixedVectorType>(in->getType())->getNumElements();
+  Value *x = builder_->CreateZExt(in, vec_ty(i32_ty, n));
+  return bit_cast(shl(x, splat(n, i32(16))), vec_ty(f32_ty, n));
+}
+
+/**
+ * \brief fp32 -> bf16 on a vector, rounding to nearest even
+ *
+ * sm_80 converts pairs with cvt.rn.bf16x2.f32. Other targets round the
+ * bits of the whole vector, keeping NaNs quiet.
+ */
+Value* generator::fp32_to_bf16(Value *in){
+  unsigned n = llvm::cast<llvm::FixedVectorType>(in->getType())->getNumElements();
+  Type *i16_ty = builder_->getInt16Ty();
+  if(tgt_->as_nvidia() && tgt_->as_nvidia()->sm() >= 80){
+    // the first operand goes to the upper half of the result
+    InlineAsm *ptx = InlineAsm::get(FunctionType::get(i32_ty, {f32_ty, f32_ty}, false),
+                                    "cvt.rn.bf16x2.f32 $0, $1, $2;", "=r,r,r", false);
+    Value *ret = UndefValue::get(vec_ty(i16_ty, n));
+    for(unsigned i = 0; i < n; i += 2){
+      Value *lo = extract_elt(in, i);
+      Value *hi = i + 1 < n ? extract_elt(in, i + 1) : ConstantFP::get(f32_ty, 0);
+      Value *packed = bit_cast(call(ptx, {hi, lo}), vec_ty(i16_ty, 2));
+      for(unsigned j = 0; j < 2 && i + j < n; j++)
+        ret = insert_elt(ret, extract_elt(packed, j), i + j);
+    }
+    return ret;
+  }
+  auto cst = [&](uint32_t v) { return splat(n, i32(v)); };
+  Value *x = bit_cast(in, vec_ty(i32_ty, n));
+  Value *odd = and_(lshr(x, cst(16)), cst(1));
+  Value *rounded = lshr(add(add(x, cst(0x7fff)), odd), cst(16));
+  Value *nan = builder_->CreateOr(lshr(x, cst(16)), cst(0x40));
+  Value *is_nan = fcmp(llvm::CmpInst::FCMP_UNO, in, in);
+  return builder_->CreateTrunc(select(is_nan, nan, rounded), vec_ty(i16_ty, n));
 }
 
 /**
@@ -482,47 +540,37 @@ void generator::visit_cast_inst(ir::cast_inst* x) {
   auto x_idxs = idxs_.at(x);
   auto op_idxs = idxs_.at(op);
 
-  // <> FP8
-  if(ret_sca_ty->is_fp8_ty() || op_sca_ty->is_fp8_ty()){
-    // ensure that conversions can be vectorized
-    int ld = layouts_->get(x)->get_order(0);
-    int contiguous = layouts_->get(x)->to_scanline()->nts(ld);
-    if(contiguous % 4 != 0)
-        throw std::runtime_error("unsupported fp32 -> fp8 conversion");
-
-    // run the conversion
-    auto cvt = [&](Value* a, Value* b, Value* c, Value* d){
-      if(op_sca_ty->is_fp32_ty() && ret_sca_ty->is_fp8_ty())
-        return fp32x4_to_fp8x4(a, b, c, d);
-      if(op_sca_ty->is_fp8_ty() && ret_sca_ty->is_fp16_ty())
-        return fp8x4_to_fp16x4(a, b, c, d);
+  // <> FP8, <> BF16
+  // converted eight elements at a time, through fp16 for fp8 and fp32 for bf16
+  if(ret_sca_ty->is_fp8_ty() || op_sca_ty->is_fp8_ty() ||
+     ret_sca_ty->is_bf16_ty() || op_sca_ty->is_bf16_ty()){
+    if(!ret_sca_ty->is_floating_point_ty() || !op_sca_ty->is_floating_point_ty())
       throw std::runtime_error("unsupported conversion");
-    };
-    for(size_t i = 0; i < x_idxs.size(); i+=4){
-        std::tie(vals_[x][x_idxs[i+0]],
-                 vals_[x][x_idxs[i+1]],
-                 vals_[x][x_idxs[i+2]],
-                 vals_[x][x_idxs[i+3]]) = cvt(vals_[op][op_idxs[i+0]],
-                                              vals_[op][op_idxs[i+1]],
-                                              vals_[op][op_idxs[i+2]],
-                                              vals_[op][op_idxs[i+3]]);
+    const size_t vec = 8;
+    for(size_t i = 0; i < x_idxs.size(); i += vec){
+      unsigned n = std::min(vec, x_idxs.size() - i);
+      Value *in = UndefValue::get(vec_ty(cvt(op_sca_ty), n));
+      for(unsigned j = 0; j < n; j++)
+        in = insert_elt(in, vals_[op][op_idxs[i + j]], j);
+      if(op_sca_ty->is_fp8_ty())
+        in = fp8_to_fp16(in);
+      if(op_sca_ty->is_bf16_ty())
+        in = bf16_to_fp32(in);
+      Value *out;
+      if(ret_sca_ty->is_fp8_ty() && in->getType()->getScalarType()->isHalfTy())
+        out = fp16_to_fp8(in);
+      else if(ret_sca_ty->is_fp8_ty())
+        out = fp32_to_fp8(in);
+      else if(ret_sca_ty->is_bf16_ty())
+        out = fp32_to_bf16(fpcast(in, vec_ty(f32_ty, n)));
+      else
+        out = fpcast(in, vec_ty(cvt(ret_sca_ty), n));
+      for(unsigned j = 0; j < n; j++)
+        vals_[x][x_idxs[i + j]] = extract_elt(out, j);
     }
     return;
   }
 
-  // <> BF16
-  if(ret_sca_ty->is_bf16_ty() || op_sca_ty->is_bf16_ty()){
-    // FP32 -> BF16
-    if(op_sca_ty->is_fp32_ty())
-    for(size_t i = 0; i < x_idxs.size(); i++)
-      vals_[x][x_idxs[i + 0]] = fp32_to_bf16(vals_[op][op_idxs[i + 0]]);
-    // BF16 -> FP32
-    if(ret_sca_ty->is_fp32_ty())
-    for(size_t i = 0; i < x_idxs.size(); i++)
-      vals_[x][x_idxs[i + 0]] = bf16_to_fp32(vals_[op][op_idxs[i + 0]]);
-    return;
-  }
-
 
   Type *ty = cvt(x->get_type()->get_scalar_ty());
   auto cvt = [](ir::cast_op_t op){
@@ -577,12 +625,36 @@ void generator::visit_uncond_branch_inst(ir::uncond_branch_inst* br) {
   br(dest);
 }
 
+/**
+ * \brief PTX cache operator of a memory access. Eviction priorities
+ * need PTX 7.4, so the closest cache operator is used instead
+ */
+static std::string get_cache_op(ir::io_inst* x, bool is_load) {
+  switch(x->get_cache_modifier()){
+    case ir::io_inst::CA: return ".ca";
+    case ir::io_inst::CG: return ".cg";
+    case ir::io_inst::CS: return ".cs";
+    case ir::io_inst::LU: return ".lu";
+    case ir::io_inst::CV: return ".cv";
+    case ir::io_inst::WB: return ".wb";
+    case ir::io_inst::WT: return ".wt";
+    default: break;
+  }
+  if(x->get_is_volatile())
+    return "";
+  if(x->get_eviction_policy() == ir::io_inst::EVICT_FIRST)
+    return ".cs";
+  if(is_load && x->get_eviction_policy() == ir::io_inst::EVICT_LAST)
+    return ".ca";
+  return "";
+}
+
 /**
  * \brief Code Generation for a (synchronous) `load`
  */
 void generator::visit_load_inst(ir::load_inst* x){
   ir::value *op = x->get_pointer_operand();
-  ir::masked_load_inst *mx = dynamic_cast<ir::masked_load_inst*>(x);
+  ir::masked_load_inst *mx = ir::dyn_cast<ir::masked_load_inst>(x);
   Type* ty  = cvt(op->get_type()->get_scalar_ty()->get_pointer_element_ty());
   // compute vector width
   size_t vec = 1;
@@ -597,6 +669,47 @@ void generator::visit_load_inst(ir::load_inst* x){
   }
   // code generation
   auto idxs = idxs_.at(x);
+  // CPU targets use (predicated) LLVM loads. evict_last is lowered to
+  // prefetches of the whole tile ahead of the demand loads, and streaming
+  // loads get !nontemporal metadata
+  if(!tgt_->is_gpu()){
+    bool non_temporal = x->get_cache_modifier() == ir::io_inst::CS ||
+                        x->get_eviction_policy() == ir::io_inst::EVICT_FIRST;
+    if(x->get_eviction_policy() == ir::io_inst::EVICT_LAST)
+    for(size_t i = 0; i < idxs.size(); i += vec){
+      Value *ptr = vals_[op][idxs[i]];
+      Value *i8_ptr = bit_cast(ptr, builder_->getInt8PtrTy(ptr->getType()->getPointerAddressSpace()));
+      intrinsic(Intrinsic::prefetch, {i8_ptr->getType()}, {i8_ptr, i32(0), i32(3), i32(1)});
+    }
+    for(indices_t idx: idxs){
+      Value *ptr = vals_[op][idx];
+      auto emit_load = [&]() -> Value* {
+        LoadInst *ld = load(ptr, x->get_is_volatile());
+        if(non_temporal)
+          ld->setMetadata(LLVMContext::MD_nontemporal, MDNode::get(*ctx_, ConstantAsMetadata::get(i32(1))));
+        return ld;
+      };
+      if(!mx){
+        vals_[x][idx] = emit_load();
+        continue;
+      }
+      // masked-out elements do not touch memory
+      Instruction *no_op = intrinsic(Intrinsic::donothing, {}, {});
+      builder_->SetInsertPoint(no_op->getParent());
+      Instruction* dummy = builder_->CreateRet(nullptr);
+      Instruction *term = llvm::SplitBlockAndInsertIfThen(vals_[mx->get_mask_operand()][idx], no_op, false);
+      dummy->removeFromParent();
+      BasicBlock *head = term->getParent()->getSinglePredecessor();
+      builder_->SetInsertPoint(term);
+      Value *ret = emit_load();
+      builder_->SetInsertPoint(no_op);
+      PHINode *res = phi(ty, 2);
+      res->addIncoming(ret, term->getParent());
+      res->addIncoming(vals_[mx->get_false_value_operand()][idx], head);
+      vals_[x][idx] = res;
+    }
+    return;
+  }
   for(size_t i = 0; i < idxs.size(); i += vec){
     indices_t idx = idxs[i];
     // pointer value
@@ -629,10 +742,10 @@ void generator::visit_load_inst(ir::load_inst* x){
     // -----
     std::ostringstream asm_oss;
     asm_oss << "@$" << n_words; // predicate
-//    if(force_nc_cache_)
-      asm_oss << " ld.global";
-//    else
-//      asm_oss << " ld.global.cg";
+    asm_oss << " ld";
+    if(x->get_is_volatile())
+      asm_oss << ".volatile";
+    asm_oss << ".global" << get_cache_op(x, true);
     if(n_words > 1)
       asm_oss << ".v" << n_words; // vector width
     asm_oss << ".b" << width; // word size
@@ -730,7 +843,7 @@ void generator::visit_masked_load_inst(ir::masked_load_inst* x) {
  */
 
 void generator::visit_store_inst(ir::store_inst * x){
-  ir::masked_store_inst *mx = dynamic_cast<ir::masked_store_inst*>(x);
+  ir::masked_store_inst *mx = ir::dyn_cast<ir::masked_store_inst>(x);
   // operands
   ir::value *ptr_op = x->get_pointer_operand();
   ir::value *val_op = x->get_value_operand();
@@ -753,6 +866,43 @@ void generator::visit_store_inst(ir::store_inst * x){
     Value* val = UndefValue::get(vec_ty(ty, vec));
     for(size_t ii = 0; ii < vec; ii++)
       val = insert_elt(val, vals_.at(val_op)[idxs[i + ii]], ii);
+    // stores with a cache operator are emitted as inline PTX
+    std::string cache_op = get_cache_op(x, false);
+    if(tgt_->is_gpu() && !cache_op.empty()){
+      Value *pred = mx ? vals_[mx->get_mask_operand()][idx] : builder_->getTrue();
+      // pack sub-words (< 32/64bits) into words
+      int nbits = ty->getPrimitiveSizeInBits();
+      int tot_width = nbits*vec;
+      int width = std::min<int>(tot_width, std::max<int>(32, nbits));
+      int n_words = std::max(1, tot_width / width);
+      Value *words = bit_cast(val, vec_ty(IntegerType::get(*ctx_, width), n_words));
+      std::ostringstream asm_oss;
+      asm_oss << "@$0 st.global" << cache_op;
+      if(n_words > 1)
+        asm_oss << ".v" << n_words;
+      asm_oss << ".b" << width << " [ $1 + 0], {";
+      std::string asm_cstrt = "b,l";
+      std::vector<Type*> arg_tys = {pred->getType(), ptr->getType()};
+      std::vector<Value*> args = {pred, ptr};
+      for(int ii = 0; ii < n_words; ii++){
+        asm_oss << (ii > 0 ? ", " : "") << "$" << ii + 2;
+        asm_cstrt += (width == 64) ? ",l" : ((width == 32) ? ",r" : ((width == 16) ? ",h" : ",c"));
+        args.push_back(extract_elt(words, ii));
+        arg_tys.push_back(args.back()->getType());
+      }
+      asm_oss << "};";
+      FunctionType *asm_ty = FunctionType::get(void_ty, arg_tys, false);
+      call(InlineAsm::get(asm_ty, asm_oss.str(), asm_cstrt, true), args);
+      continue;
+    }
+    // non-temporal stores on CPUs
+    bool non_temporal = !tgt_->is_gpu() && (x->get_cache_modifier() == ir::io_inst::CS ||
+                                            x->get_eviction_policy() == ir::io_inst::EVICT_FIRST);
+    auto emit_store = [&]() {
+      StoreInst *st = store(val, ptr, x->get_is_volatile());
+      if(non_temporal)
+        st->setMetadata(LLVMContext::MD_nontemporal, MDNode::get(*ctx_, ConstantAsMetadata::get(i32(1))));
+    };
     if(mx){
       Value *msk = vals_[mx->get_mask_operand()][idx];
       Instruction *no_op = intrinsic(Intrinsic::donothing, {}, {});
@@ -761,11 +911,11 @@ void generator::visit_store_inst(ir::store_inst * x){
       Instruction *term = llvm::SplitBlockAndInsertIfThen(msk, no_op, false);
       dummy->removeFromParent();
       builder_->SetInsertPoint(term);
-      store(val, ptr);
+      emit_store();
       builder_->SetInsertPoint(no_op);
     }
     else
-      store(val, ptr);
+      emit_store();
   }
 }
 void generator::visit_unmasked_store_inst(ir::unmasked_store_inst* x) {
@@ -837,17 +987,30 @@ void generator::visit_get_num_programs_inst(ir::get_num_programs_inst* np) {
 }
 
 /**
- * \brief Code Generation for `exp`
+ * \brief fp32 exp and log through ex2/lg2.approx
  */
-void generator::visit_exp_inst(ir::exp_inst* x){
+Value* generator::fast_exp(Value *x){
   Constant *log2e = ConstantFP::get(f32_ty, 1.4426950408889634);
   std::vector<llvm::Type*> tys = {f32_ty};
   FunctionType *fn_ty = FunctionType::get(f32_ty, tys, false);
   InlineAsm *ex2 = InlineAsm::get(fn_ty, "ex2.approx.f32 $0, $0;", "=f,0", false);
-  for(auto idx: idxs_.at(x)){
-    Value *ex2arg = fmul(vals_[x->get_operand(0)][idx], log2e);
-    vals_[x][idx] = call(ex2, std::vector<llvm::Value*>{ex2arg});
-  }
+  return call(ex2, std::vector<llvm::Value*>{fmul(x, log2e)});
+}
+
+Value* generator::fast_log(Value *x){
+  Constant *rcplog2e = ConstantFP::get(f32_ty, 0.6931471805599453);
+  std::vector<llvm::Type*> tys = {f32_ty};
+  FunctionType *fn_ty = FunctionType::get(f32_ty, tys, false);
+  InlineAsm *lg2 = InlineAsm::get(fn_ty, "lg2.approx.f32 $0, $1;", "=f,f", false);
+  return fmul(call(lg2, std::vector<llvm::Value*>{x}), rcplog2e);
+}
+
+/**
+ * \brief Code Generation for `exp`
+ */
+void generator::visit_exp_inst(ir::exp_inst* x){
+  for(auto idx: idxs_.at(x))
+    vals_[x][idx] = fast_exp(vals_[x->get_operand(0)][idx]);
 }
 
 /**
@@ -878,14 +1041,8 @@ void generator::visit_sin_inst(ir::sin_inst* x){
  * \brief Code Generation for `log`
  */
 void generator::visit_log_inst(ir::log_inst* x){
-  Constant *rcplog2e = ConstantFP::get(f32_ty, 0.6931471805599453);
-  std::vector<llvm::Type*> tys = {f32_ty};
-  FunctionType *fn_ty = FunctionType::get(f32_ty, tys, false);
-  InlineAsm *lg2 = InlineAsm::get(fn_ty, "lg2.approx.f32 $0, $1;", "=f,f", false);
-  for(auto idx: idxs_.at(x)){
-    Value *lg2arg = call(lg2, std::vector<llvm::Value*>{vals_[x->get_operand(0)][idx]});
-    vals_[x][idx] = fmul(lg2arg, rcplog2e);
-  }
+  for(auto idx: idxs_.at(x))
+    vals_[x][idx] = fast_log(vals_[x->get_operand(0)][idx]);
 }
 
 /**
@@ -928,32 +1085,163 @@ void generator::visit_atomic_cas_inst(ir::atomic_cas_inst* cas) {
 
 /**
  * \brief Code Generation for `atomic_rmw`
+ *
+ * When the result of a block atomic is unused and its pointers are equal
+ * along some axes, the values along these axes are first combined within
+ * threads and then across lanes with butterfly shuffles, so that each warp
+ * issues a single atomic per destination. CPU targets lower atomics to
+ * LLVM `atomicrmw`.
  */
 void generator::visit_atomic_rmw_inst(ir::atomic_rmw_inst *atom) {
   ir::value* ptr = atom->get_operand(0);
   ir::value* val = atom->get_operand(1);
   ir::value* msk = atom->get_operand(2);
+  using tt = ir::atomic_rmw_op_t;
+  tt op = atom->get_op();
+  bool is_block = atom->get_type()->is_block_ty();
 
   // vector size
   int vec = 1;
-  if(atom->get_type()->is_block_ty()){
+  if(is_block && tgt_->is_gpu()){
     int ld = ords_.at(ptr)[0];
     unsigned alignment = alignment_->get(ptr, ld);
     vec = std::min<int>(layouts_->get(ptr)->to_scanline()->nts(ld), alignment);
     vec = std::min(vec, val->get_type()->get_tile_element_ty()->is_fp16_ty() ? 2 : 1);
   }
 
+  // axes along which all pointers are equal
+  std::vector<int> agg_axes;
+  if(is_block && atom->get_users().empty() && op != tt::Xchg){
+    auto shapes = ptr->get_type()->get_block_shapes();
+    std::vector<unsigned> num_cst = alignment_->num_constant(ptr);
+    for(size_t d = 0; d < shapes.size(); d++)
+      if(shapes[d] > 1 && num_cst[d] >= shapes[d])
+        agg_axes.push_back(d);
+    // packed atomics would write one destination to consecutive addresses
+    if(std::find(agg_axes.begin(), agg_axes.end(), ords_.at(ptr)[0]) != agg_axes.end())
+      vec = 1;
+  }
+  auto agg_key = [&](indices_t idx) {
+    for(int d: agg_axes)
+      idx[d] = i32(0);
+    return idx;
+  };
+
+  // aggregated (value, mask) of each destination
+  std::map<indices_t, std::pair<Value*, Value*>> aggs;
+  if(!agg_axes.empty()){
+    Type *ty = vals_[val][idxs_.at(val)[0]]->getType();
+    unsigned nbits = ty->getScalarSizeInBits();
+    Value *neutral;
+    switch(op){
+      case tt::Add: case tt::Or: case tt::Xor: case tt::UMax: neutral = ConstantInt::get(ty, 0); break;
+      case tt::And: case tt::UMin: neutral = Constant::getAllOnesValue(ty); break;
+      case tt::Min: neutral = ConstantInt::get(ty, APInt::getSignedMaxValue(nbits)); break;
+      case tt::Max: neutral = ConstantInt::get(ty, APInt::getSignedMinValue(nbits)); break;
+      case tt::FAdd: neutral = ConstantFP::getNegativeZero(ty); break;
+      default: throw std::runtime_error("unreachable");
+    }
+    auto do_acc = [&](Value *x, Value *y) -> Value* {
+      switch(op){
+        case tt::Add: return add(x, y);
+        case tt::FAdd: return fadd(x, y);
+        case tt::And: return and_(x, y);
+        case tt::Or: return builder_->CreateOr(x, y);
+        case tt::Xor: return xor_(x, y);
+        case tt::Min: return select(icmp_sle(x, y), x, y);
+        case tt::Max: return select(icmp_sge(x, y), x, y);
+        case tt::UMin: return select(icmp(llvm::CmpInst::ICMP_ULE, x, y), x, y);
+        case tt::UMax: return select(icmp(llvm::CmpInst::ICMP_UGE, x, y), x, y);
+        default: throw std::runtime_error("unreachable");
+      }
+    };
+    // combine within thread; masked-out elements contribute the neutral element
+    for(indices_t idx: idxs_.at(val)){
+      Value *m = vals_[msk][idx];
+      Value *v = select(m, vals_[val][idx], neutral);
+      indices_t key = agg_key(idx);
+      auto it = aggs.find(key);
+      if(it == aggs.end())
+        aggs[key] = {v, m};
+      else
+        it->second = {do_acc(it->second.first, v), builder_->CreateOr(it->second.second, m)};
+    }
+    // combine within warp; the first lane along these axes issues the atomic
+    if(tgt_->is_gpu()){
+      analysis::scanline_layout* layout = layouts_->get(ptr)->to_scanline();
+      Value *is_first = builder_->getTrue();
+      for(int d: agg_axes){
+        int stride = layout->lane_stride(d);
+        int per_warp = layout->mts_per_warp(d);
+        for(auto& x: aggs){
+          Value *m = builder_->CreateZExt(x.second.second, i32_ty);
+          for(int i = per_warp/2; i > 0; i >>= 1){
+            x.second.first = do_acc(x.second.first, shfl_sync(x.second.first, i*stride));
+            m = builder_->CreateOr(m, shfl_sync(m, i*stride));
+          }
+          x.second.second = builder_->CreateTrunc(m, builder_->getInt1Ty());
+        }
+        Value *tid = axes_.at(a_axes_->get(ptr, d)).thread_id;
+        is_first = builder_->CreateAnd(is_first, icmp_eq(urem(tid, i32(per_warp)), i32(0)));
+      }
+      for(auto& x: aggs)
+        x.second.second = builder_->CreateAnd(x.second.second, is_first);
+    }
+  }
+
+  std::set<indices_t> done;
   for(int i = 0; i < idxs_.at(val).size(); i += vec){
     auto idx = idxs_[val][i];
     Value *rmw_val = UndefValue::get(vec_ty(vals_[val][idx]->getType(), vec));
-    for(int ii = 0; ii < vec; ii++)
-      rmw_val = insert_elt(rmw_val, vals_[val][idxs_[val][i+ii]], ii);
-    Value *rmw_ptr = vals_[ptr][idx];
     Value *rmw_msk = vals_[msk][idx];
+    if(agg_axes.empty()){
+      for(int ii = 0; ii < vec; ii++)
+        rmw_val = insert_elt(rmw_val, vals_[val][idxs_[val][i+ii]], ii);
+    }
+    else{
+      // one atomic per destination
+      if(!done.insert(agg_key(idx)).second)
+        continue;
+      for(int ii = 0; ii < vec; ii++)
+        rmw_val = insert_elt(rmw_val, aggs.at(agg_key(idxs_[val][i+ii])).first, ii);
+      rmw_msk = aggs.at(agg_key(idx)).second;
+    }
+    Value *rmw_ptr = vals_[ptr][idx];
     if(vec == 1)
       rmw_val = extract_elt(rmw_val, i32(0));
     Type* ty = rmw_val->getType();
     size_t nbits = ty->getScalarSizeInBits();
+    // atomics of CPU targets
+    if(!tgt_->is_gpu()){
+      AtomicRMWInst::BinOp bin_op;
+      switch(op){
+        case tt::Or: bin_op = AtomicRMWInst::Or; break;
+        case tt::And: bin_op = AtomicRMWInst::And; break;
+        case tt::Xor: bin_op = AtomicRMWInst::Xor; break;
+        case tt::Add: bin_op = AtomicRMWInst::Add; break;
+        case tt::Min: bin_op = AtomicRMWInst::Min; break;
+        case tt::Max: bin_op = AtomicRMWInst::Max; break;
+        case tt::UMin: bin_op = AtomicRMWInst::UMin; break;
+        case tt::UMax: bin_op = AtomicRMWInst::UMax; break;
+        case tt::FAdd: bin_op = AtomicRMWInst::FAdd; break;
+        case tt::Xchg: bin_op = AtomicRMWInst::Xchg; break;
+      }
+      // masked-out elements do not touch memory
+      Instruction *no_op = intrinsic(Intrinsic::donothing, {}, {});
+      builder_->SetInsertPoint(no_op->getParent());
+      Instruction* dummy = builder_->CreateRet(nullptr);
+      Instruction *term = llvm::SplitBlockAndInsertIfThen(rmw_msk, no_op, false);
+      dummy->removeFromParent();
+      BasicBlock *head = term->getParent()->getSinglePredecessor();
+      builder_->SetInsertPoint(term);
+      Value *old = atomic_rmw(bin_op, rmw_ptr, rmw_val, AtomicOrdering::Monotonic);
+      builder_->SetInsertPoint(no_op);
+      PHINode *ret = phi(ty, 2);
+      ret->addIncoming(old, term->getParent());
+      ret->addIncoming(UndefValue::get(ty), head);
+      vals_[atom][idx] = ret;
+      continue;
+    }
     // extract pointer offset
     std::string offset = "";
     if(GetElementPtrInst *gep = dyn_cast<GetElementPtrInst>(rmw_ptr))
@@ -971,8 +1259,7 @@ void generator::visit_atomic_rmw_inst(ir::atomic_rmw_inst *atom) {
     std::string s_nbits = std::to_string(nbits);
     std::string name;
     std::string s_ty;
-    using tt = ir::atomic_rmw_op_t;
-    switch(atom->get_op()){
+    switch(op){
       case tt::Or: name = "or"; s_ty = "b"; break;
       case tt::And: name = "and"; s_ty = "b"; break;
       case tt::Xor: name = "xor", s_ty = "b"; break;
@@ -993,7 +1280,7 @@ void generator::visit_atomic_rmw_inst(ir::atomic_rmw_inst *atom) {
     // create inline asm
     InlineAsm *iasm = InlineAsm::get(fn_ty, asm_str, constraint, true);
     // call asm
-    if(atom->get_type()->is_block_ty())
+    if(is_block)
       vals_[atom][idx] = call(iasm, (ArrayRef<Value*>{rmw_msk, rmw_ptr, rmw_val}));
     else{
       Module *mod = builder_->GetInsertBlock()->getModule();
@@ -1144,8 +1431,8 @@ void generator::visit_mma884(ir::dot_inst* C, ir::value *A, ir::value *B, ir::va
       acc[idx[i]] = extract_val(nc, {i});
   };
 
-  ir::phi_node* phiA = dynamic_cast<ir::phi_node*>(A);
-  ir::phi_node* phiB = dynamic_cast<ir::phi_node*>(B);
+  ir::phi_node* phiA = ir::dyn_cast<ir::phi_node>(A);
+  ir::phi_node* phiB = ir::dyn_cast<ir::phi_node>(B);
 
   // Cache lds value. If values are prefetched, create phi node
   // @param inc: incoming block (0 = header, 1 = loop)
@@ -1384,17 +1671,18 @@ void generator::visit_mma16816(ir::dot_inst* C, ir::value *A, ir::value *B, ir::
   }
 
   builder_->SetInsertPoint(CurrBB);
-  // A pointer
+  // A pointer (bf16 is stored as i16 and read through the same ldmatrix)
   std::vector<Value*> ptrs_a(num_ptr_a);
   for(int i = 0; i < num_ptr_a; i++)
-    ptrs_a[i] = gep(shmems_[A], {off_a[i]});
+    ptrs_a[i] = bit_cast(gep(shmems_[A], {off_a[i]}), ptr_ty(f16_ty, 3));
   // B pointer
   std::vector<Value*> ptrs_b(num_ptr_b);
   for(int i = 0; i < num_ptr_b; i++)
-    ptrs_b[i] = gep(shmems_[B], {off_b[i]});
+    ptrs_b[i] = bit_cast(gep(shmems_[B], {off_b[i]}), ptr_ty(f16_ty, 3));
 
+  std::string ab_ty = A->get_type()->get_scalar_ty()->is_bf16_ty() ? "bf16" : "f16";
   FunctionType *mma_ty = FunctionType::get(fp32_pack4_ty, std::vector<llvm::Type*>{fp16x2_ty, fp16x2_ty, fp16x2_ty, fp16x2_ty, fp16x2_ty, fp16x2_ty, fp32_ty, fp32_ty, fp32_ty, fp32_ty}, false);
-  InlineAsm *mma_fn = InlineAsm::get(mma_ty, "mma.sync.aligned.m16n8k16.row.col.f32.f16.f16.f32 "
+  InlineAsm *mma_fn = InlineAsm::get(mma_ty, "mma.sync.aligned.m16n8k16.row.col.f32." + ab_ty + "." + ab_ty + ".f32 "
                                              "{$0, $1, $2, $3}, "
                                              "{$4, $5, $6, $7}, "
                                              "{$8, $9}, "
@@ -1422,8 +1710,8 @@ void generator::visit_mma16816(ir::dot_inst* C, ir::value *A, ir::value *B, ir::
       fc[idx[3]] = extract_val(nc, std::vector<unsigned>{3});
   };
 
-  ir::phi_node* phiA = dynamic_cast<ir::phi_node*>(A);
-  ir::phi_node* phiB = dynamic_cast<ir::phi_node*>(B);
+  ir::phi_node* phiA = ir::dyn_cast<ir::phi_node>(A);
+  ir::phi_node* phiB = ir::dyn_cast<ir::phi_node>(B);
 
   auto register_lds =
     [&](decltype(ha)& vals, int m, int K, int inc, Value* val0, Value *val1, bool is_prefetch) {
@@ -1562,6 +1850,145 @@ void generator::visit_mma16816(ir::dot_inst* C, ir::value *A, ir::value *B, ir::
   };
 }
 
+/**
+ * \brief Code Generation for tensor-core `dot` on 32-bit fragments (int8, tf32)
+ *
+ * Every register of an A or B fragment packs the consecutive elements
+ * of the reduction axis that fit in 32 bits: four int8 for m16n8k32, one
+ * tf32 for m16n8k8. They are read with a single 32-bit shared load when
+ * that axis is contiguous in shared memory, and gathered element by
+ * element otherwise, since ldmatrix can only transpose 16-bit data.
+ * sm_75 has no m16n8k32 instruction and issues four m8n8k16 instead.
+ */
+void generator::visit_mma_b32(ir::dot_inst* C, ir::value *A, ir::value *B, ir::value *D, unsigned NK) {
+  const std::vector<unsigned>& shapes = C->get_type()->get_block_shapes();
+  std::map<std::vector<Value*>, std::vector<Value*>> fcs;
+  for(indices_t idx: idxs_.at(C)){
+    std::vector<Value*> key(idx.size() - 2);
+    std::copy(idx.begin() + 2, idx.end(), key.begin());
+    fcs[key].push_back(vals_[D][idx]);
+  };
+  analysis::mma_layout* layout = layouts_->get(C)->to_mma();
+  analysis::shared_layout* layout_a = layouts_->get(A)->to_shared();
+  analysis::shared_layout* layout_b = layouts_->get(B)->to_shared();
+  std::vector<Value *>& fc = fcs.begin()->second;
+  ir::type *sca_ty = A->get_type()->get_scalar_ty();
+  bool is_int8 = sca_ty->is_integer_ty(8);
+  // elements of the reduction axis per register, and per instruction
+  int per_reg = 32 / sca_ty->get_primitive_size_in_bits();
+  int k_width = 8 * per_reg;
+
+  Value* thread = tgt_->get_local_id(mod_, *builder_, 0);
+  Value *lane   = urem(thread, i32(32));
+  Value *warp   = udiv(thread, i32(32));
+  Value *warp0  = urem(warp, i32(layout->wpt(0)));
+  Value *warp1  = urem(udiv(warp, i32(layout->wpt(0))), i32(layout->wpt(1)));
+  Value *group  = udiv(lane, i32(4));
+  Value *off_k  = mul(urem(lane, i32(4)), i32(per_reg));
+  Value *off_m  = add(mul(warp0, i32(16)), group);
+  Value *off_n  = add(mul(warp1, i32(8)), group);
+
+  // packs x[r][K + i] (A, axis_k = 1) or x[K + i][r] (B, axis_k = 0)
+  auto load_frag = [&](ir::value *x, analysis::shared_layout *shared, int axis_k, Value *r, unsigned K) -> Value* {
+    auto shape = shared->get_shape();
+    auto order = shared->get_order();
+    int per_phase = swizzle_->get_per_phase(shared);
+    int max_phase = swizzle_->get_max_phase(shared);
+    int vec = swizzle_->get_vec(shared);
+    auto ptr = [&](int i) {
+      std::vector<Value*> idx(2);
+      idx[axis_k] = add(off_k, i32(K + i));
+      idx[1 - axis_k] = r;
+      Value *off0 = idx[order[0]];
+      Value *off1 = idx[order[1]];
+      Value *phase = urem(udiv(off1, i32(per_phase)), i32(max_phase));
+      off0 = add(mul(xor_(udiv(off0, i32(vec)), phase), i32(vec)), urem(off0, i32(vec)));
+      return gep(shmems_[x], add(mul(off1, i32(shape[order[0]])), off0));
+    };
+    if(order[0] == axis_k || per_reg == 1)
+      return load(bit_cast(ptr(0), ptr_ty(i32_ty, 3)));
+    Type *elt_ty = cvt(sca_ty);
+    Value *ret = UndefValue::get(vec_ty(elt_ty, per_reg));
+    for(int i = 0; i < per_reg; i++)
+      ret = insert_elt(ret, load(ptr(i)), i);
+    return bit_cast(ret, i32_ty);
+  };
+
+  Type *c_ty = cvt(D->get_type()->get_scalar_ty());
+  std::string c_cst = is_int8 ? "=r" : "=f";
+  Type *c_pack4_ty = StructType::get(*ctx_, std::vector<llvm::Type*>{c_ty, c_ty, c_ty, c_ty});
+  Type *c_pack2_ty = StructType::get(*ctx_, std::vector<llvm::Type*>{c_ty, c_ty});
+  std::vector<llvm::Type*> mma_args(6, i32_ty);
+  for(int i = 0; i < 4; i++)
+    mma_args.push_back(c_ty);
+  FunctionType *mma_ty = FunctionType::get(c_pack4_ty, mma_args, false);
+  std::string mma_str = is_int8 ? "mma.sync.aligned.m16n8k32.row.col.s32.s8.s8.s32 "
+                                : "mma.sync.aligned.m16n8k8.row.col.f32.tf32.tf32.f32 ";
+  InlineAsm *mma_fn = InlineAsm::get(mma_ty, mma_str +
+                                             "{$0, $1, $2, $3}, "
+                                             "{$4, $5, $6, $7}, "
+                                             "{$8, $9}, "
+                                             "{$10, $11, $12, $13};",
+                                             c_cst + "," + c_cst + "," + c_cst + "," + c_cst + ",r,r,r,r,r,r,0,1,2,3", true);
+  FunctionType *mma8816_ty = FunctionType::get(c_pack2_ty, std::vector<llvm::Type*>{i32_ty, i32_ty, c_ty, c_ty}, false);
+  InlineAsm *mma8816_fn = InlineAsm::get(mma8816_ty, "mma.sync.aligned.m8n8k16.row.col.s32.s8.s8.s32 "
+                                                     "{$0, $1}, {$2}, {$3}, {$4, $5};",
+                                                     "=r,=r,r,r,0,1", true);
+  bool has_m16n8 = tgt_->as_nvidia()->sm() >= 80;
+
+  unsigned num_rep_0 = shapes[0] / layout->shape_per_cta(0);
+  unsigned num_rep_1 = shapes[1] / layout->shape_per_cta(1);
+  std::map<std::pair<unsigned, unsigned>, std::vector<Value*>> ha;
+  std::map<std::pair<unsigned, unsigned>, std::vector<Value*>> hb;
+  for(unsigned K = 0; K < NK; K += k_width)
+  for(unsigned m = 0; m < num_rep_0; m++)
+  for(unsigned n = 0; n < num_rep_1; n++){
+    unsigned K_hi = K + k_width / 2;
+    if(ha.find({m, K}) == ha.end()){
+      Value *r = add(off_m, i32(m*16*layout->wpt(0)));
+      Value *r8 = add(r, i32(8));
+      ha[{m, K}] = {load_frag(A, layout_a, 1, r, K),    load_frag(A, layout_a, 1, r8, K),
+                    load_frag(A, layout_a, 1, r, K_hi), load_frag(A, layout_a, 1, r8, K_hi)};
+    }
+    if(hb.find({n, K}) == hb.end()){
+      Value *r = add(off_n, i32(n*8*layout->wpt(1)));
+      hb[{n, K}] = {load_frag(B, layout_b, 0, r, K), load_frag(B, layout_b, 0, r, K_hi)};
+    }
+    const std::vector<Value*>& a = ha[{m, K}];
+    const std::vector<Value*>& b = hb[{n, K}];
+    unsigned cols_per_thread = num_rep_0 * 2;
+    std::vector<size_t> idx = {
+      (m*2 + 0) + (n*2 + 0)*cols_per_thread,
+      (m*2 + 0) + (n*2 + 1)*cols_per_thread,
+      (m*2 + 1) + (n*2 + 0)*cols_per_thread,
+      (m*2 + 1) + (n*2 + 1)*cols_per_thread
+    };
+    if(has_m16n8){
+      Value *nc = call(mma_ty, mma_fn, {a[0], a[1], a[2], a[3], b[0], b[1],
+                                        fc[idx[0]], fc[idx[1]], fc[idx[2]], fc[idx[3]]});
+      for(unsigned i = 0; i < 4; i++)
+        fc[idx[i]] = extract_val(nc, std::vector<unsigned>{i});
+      continue;
+    }
+    // rows 0-7 use a[0] and a[2], rows 8-15 use a[1] and a[3]
+    for(unsigned half = 0; half < 2; half++)
+    for(unsigned k = 0; k < 2; k++){
+      Value *nc = call(mma8816_ty, mma8816_fn, {a[2*k + half], b[k], fc[idx[2*half]], fc[idx[2*half + 1]]});
+      fc[idx[2*half]] = extract_val(nc, std::vector<unsigned>{0});
+      fc[idx[2*half + 1]] = extract_val(nc, std::vector<unsigned>{1});
+    }
+  }
+  // write back
+  unsigned i = 0;
+  for(indices_t idx: idxs_.at(C)){
+    std::vector<Value*> key(idx.size() - 2);
+    std::copy(idx.begin() + 2, idx.end(), key.begin());
+    if(i >= fcs.at(key).size())
+      i = 0;
+    vals_[C][idx] = fcs.at(key)[i++];
+  };
+}
+
 /**
  * \brief Code Generation for FMA-based `dot` (FP32, FP64, Default)
  */
@@ -1656,6 +2083,77 @@ void generator::visit_fmadot(ir::dot_inst* C, ir::value* A, ir::value* B, ir::va
   }
 }
 
+/**
+ * \brief Code Generation for integer `dot`
+ *
+ * Products are accumulated in the type of the accumulator. On NVIDIA GPUs
+ * that support it, int8 operands go through `dp4a`, which multiplies and
+ * accumulates four consecutive elements of the reduction axis at once.
+ */
+void generator::visit_imadot(ir::dot_inst* C, ir::value* A, ir::value* B, ir::value* D, unsigned NK, Type *c_ty) {
+  auto shape_c = C->get_type()->get_block_shapes();
+  auto shape_a = A->get_type()->get_block_shapes();
+  auto shape_b = B->get_type()->get_block_shapes();
+  auto ord_a = layouts_->get(A)->get_order();
+  auto ord_b = layouts_->get(B)->get_order();
+  analysis::scanline_layout* layout_c = layouts_->get(C)->to_scanline();
+  bool is_a_row = ord_a[0] == 1;
+  bool is_b_row = ord_b[0] == 1;
+  int stride_a_m = is_a_row ? shape_a[1] : 1;
+  int stride_a_k = is_a_row ? 1 : shape_a[0];
+  int stride_b_n = is_b_row ? 1 : shape_b[0];
+  int stride_b_k = is_b_row ? shape_b[1] : 1;
+  distributed_axis ax_m = axes_.at(a_axes_->get(C, 0));
+  distributed_axis ax_n = axes_.at(a_axes_->get(C, 1));
+  Value *ptr_a = gep(shmems_[A], mul(ax_m.thread_id, i32(ax_m.contiguous*stride_a_m)));
+  Value *ptr_b = gep(shmems_[B], mul(ax_n.thread_id, i32(ax_n.contiguous*stride_b_n)));
+
+  bool is_int8 = A->get_type()->get_scalar_ty()->is_integer_ty(8) &&
+                 B->get_type()->get_scalar_ty()->is_integer_ty(8);
+  bool use_dp4a = tgt_->as_nvidia() && tgt_->as_nvidia()->sm() >= 61 &&
+                  is_int8 && c_ty->isIntegerTy(32) && NK % 4 == 0;
+  unsigned vec_k = use_dp4a ? 4 : 1;
+  InlineAsm *dp4a = InlineAsm::get(FunctionType::get(i32_ty, {i32_ty, i32_ty, i32_ty}, false),
+                                   "dp4a.s32.s32 $0, $1, $2, $3;", "=r,r,r,r", false);
+  // operand elements k..k+vec_k-1, packed for dp4a or sign-extended
+  auto load_k = [&](Value *ptr, int off, int stride_k) -> Value* {
+    if(!use_dp4a)
+      return builder_->CreateSExtOrTrunc(load(gep(ptr, i32(off))), c_ty);
+    if(stride_k == 1)
+      return load(bit_cast(gep(ptr, i32(off)), ptr_ty(i32_ty, 3)));
+    Value *ret = UndefValue::get(vec_ty(i8_ty, 4));
+    for(int i = 0; i < 4; i++)
+      ret = insert_elt(ret, load(gep(ptr, i32(off + i*stride_k))), i);
+    return bit_cast(ret, i32_ty);
+  };
+
+  std::map<indices_t, Value*> ret = vals_[D];
+  std::map<std::pair<int, int>, Value*> has, hbs;
+  for(unsigned k = 0; k < NK; k += vec_k){
+    int z = 0;
+    for(unsigned m = 0; m < shape_c[0]; m += layout_c->shape_per_cta(0))
+    for(unsigned n = 0; n < shape_c[1]; n += layout_c->shape_per_cta(1))
+    for(unsigned mm = 0; mm < layout_c->nts(0); mm++)
+    for(unsigned nn = 0; nn < layout_c->nts(1); nn++)
+    {
+      if(has.find({m + mm, k}) == has.end())
+        has[{m + mm, k}] = load_k(ptr_a, (m + mm)*stride_a_m + k*stride_a_k, stride_a_k);
+      if(hbs.find({n + nn, k}) == hbs.end())
+        hbs[{n + nn, k}] = load_k(ptr_b, (n + nn)*stride_b_n + k*stride_b_k, stride_b_k);
+      Value *&acc = ret[idxs_[C].at(z)];
+      if(use_dp4a)
+        acc = call(dp4a, {has[{m+mm, k}], hbs[{n+nn, k}], acc});
+      else
+        acc = add(acc, mul(has[{m+mm, k}], hbs[{n+nn, k}]));
+      z++;
+    }
+  }
+
+  for(indices_t idx: idxs_.at(C)){
+    vals_[C][idx] = ret[idx];
+  }
+}
+
 /**
  * \brief Code Generation for `dot`
  * Dispatches to appropriate specialized function
@@ -1667,16 +2165,21 @@ void generator::visit_dot_inst(ir::dot_inst* dot) {
   ir::value *B = dot->get_operand(1);
   ir::value *D = dot->get_operand(2);
   Type *c_ty = cvt(D->get_type()->get_scalar_ty());
-  Function *f_mul_add = Intrinsic::getDeclaration(module, Intrinsic::fmuladd, std::vector<llvm::Type*>{c_ty});
   auto A_shapes = A->get_type()->get_block_shapes();
   size_t red_axis = 1;
   unsigned NK = A_shapes[red_axis];
   bool is_outer = NK == 1;
   bool is_mma = layouts_->get(dot)->to_mma();
+  ir::type *a_sca_ty = A->get_type()->get_scalar_ty();
+  if(!is_outer && is_mma && (a_sca_ty->is_integer_ty(8) || a_sca_ty->is_fp32_ty()))
+    return visit_mma_b32(dot, A, B, D, NK);
   if(!is_outer && is_mma && tgt_->as_nvidia()->sm() < 80)
     return visit_mma884(dot, A, B, D, NK);
   if(!is_outer && is_mma && tgt_->as_nvidia()->sm() >= 80)
     return visit_mma16816(dot, A, B, D, NK);
+  if(c_ty->isIntegerTy())
+    return visit_imadot(dot, A, B, D, NK, c_ty);
+  Function *f_mul_add = Intrinsic::getDeclaration(module, Intrinsic::fmuladd, std::vector<llvm::Type*>{c_ty});
   return visit_fmadot(dot, A, B, D, NK, c_ty, f_mul_add);
 }
 
@@ -1708,175 +2211,499 @@ Value* generator::shared_off(const std::vector<unsigned>& shapes, const std::vec
   return result;
 }
 
-inline Value* generator::shfl_sync(Value* acc, int32_t i){
+inline Value* generator::shfl(Value* acc, Value* i, const std::string& mode, int clamp){
   Type* ty = acc->getType();
-  std::string asm_str = "shfl.sync.bfly.b32 $0, $1, $2, 0x1f, 0xffffffff;";
-  InlineAsm *shfl = InlineAsm::get(FunctionType::get(ty, {ty, i32_ty}, false), asm_str, "=f,f,r", false);
+  std::ostringstream asm_str;
+  asm_str << "shfl.sync." << mode << ".b32 $0, $1, $2, " << clamp << ", 0xffffffff;";
+  InlineAsm *shfl = InlineAsm::get(FunctionType::get(ty, {ty, i32_ty}, false), asm_str.str(), "=f,f,r", false);
   if(ty->getPrimitiveSizeInBits() <= 32)
-    return call(shfl, {acc, i32(i)});
+    return call(shfl, {acc, i});
   acc = builder_->CreateBitCast(acc, vec_ty(f32_ty, 2));
   Value* acc0 = builder_->CreateExtractElement(acc, i32(0));
   Value* acc1 = builder_->CreateExtractElement(acc, i32(1));
   Value* ret = UndefValue::get(vec_ty(f32_ty, 2));
-  ret = insert_elt(ret, shfl_sync(acc0, i), i32(0));
-  ret = insert_elt(ret, shfl_sync(acc1, i), i32(1));
+  ret = insert_elt(ret, this->shfl(acc0, i, mode, clamp), i32(0));
+  ret = insert_elt(ret, this->shfl(acc1, i, mode, clamp), i32(1));
   return builder_->CreateBitCast(ret, ty);
 }
 
-/**
- * \brief Code Generation for `reduce` (1D case)
- */
-void generator::visit_reduce1d_inst(ir::reduce_inst* x, std::function<Value*(Value*,Value*)> do_acc, Value *neutral) {
-  std::map<indices_t, Value*> partial;
-  ir::value *arg = x->get_operand(0);
-  Type *ret_ty = cvt(x->get_type()->get_scalar_ty());
-  Value *acc = nullptr;
+inline Value* generator::shfl_sync(Value* acc, int32_t i){
+  return shfl(acc, i32(i), "bfly", 0x1f);
+}
 
-  // reduce within thread
-  for(indices_t idx: idxs_.at(arg)){
-    Value *val = vals_[arg][idx];
-    acc = !acc ? val : do_acc(acc, val);
-  }
-  // reduce within wrap
-  for(int i = 16; i > 0; i >>= 1)
-    acc = do_acc(acc, shfl_sync(acc, i));
-  // pointers
-  unsigned addr_space = shmem_->getType()->getPointerAddressSpace();
-  Value *base = bit_cast(shmem_, ptr_ty(ret_ty, addr_space));
-  Value* thread = tgt_->get_local_id(mod_, *builder_, 0);
-  Value* warp = udiv(thread, i32(32));
-  Value* lane = urem(thread, i32(32));
-  // store warp result in shared memory
-  add_barrier();
-  store(neutral, gep(base, lane));
-  add_barrier();
-  store(acc, gep(base, warp));
-  add_barrier();
+inline std::vector<Value*> generator::shfl_sync(const std::vector<Value*>& acc, int32_t i){
+  std::vector<Value*> ret;
+  for(Value *v: acc)
+    ret.push_back(shfl_sync(v, i));
+  return ret;
+}
 
-  // reduce across warps
-  Value *cond = icmp_eq(warp, i32(0));
-  Instruction *barrier = add_barrier();
-  builder_->SetInsertPoint(barrier->getParent());
-  Instruction* dummy = builder_->CreateRet(nullptr);
-  Instruction *term = llvm::SplitBlockAndInsertIfThen(cond, barrier, false);
-  dummy->removeFromParent();
-  builder_->SetInsertPoint(term);
-  Value* ret = load(gep(base, thread));
-  for(int i = (num_warps_+1)/2; i > 0; i >>= 1){
-    Value *current = shfl_sync(ret, i);
-    ret = do_acc(ret, current);
-  }
-  store(ret, gep(base, thread));
-
-  // store first warp done
-  builder_->SetInsertPoint(barrier->getParent());
-  ret = load(base);
-  for(indices_t idx: idxs_.at(x))
-    vals_[x][idx] = ret;
+inline Value* generator::shfl_up(Value* acc, int32_t i){
+  return shfl(acc, i32(i), "up", 0x0);
+}
+
+inline Value* generator::shfl_idx(Value* acc, Value* lane){
+  return shfl(acc, lane, "idx", 0x1f);
 }
 
 /**
- * \brief Code Generation for `reduce` (ND case)
+ * \brief Code Generation for `reduce` (any rank)
+ *
+ * Lines along the axis are reduced within threads, then across the lanes
+ * of each warp with butterfly shuffles. When the axis spans several warps,
+ * the per-warp partials of all lines are exchanged in a single round
+ * through shared memory. Fused reductions concatenate their accumulators
+ * and go through the same tree.
  */
-void generator::visit_reducend_inst(ir::reduce_inst* x, std::function<Value*(Value*,Value*)> do_acc, Value *neutral) {
+void generator::visit_reducend_inst(const std::vector<ir::reduce_inst*>& reds, const std::vector<reduce_fn_t>& fns) {
+  ir::reduce_inst *x = reds.front();
   ir::value *arg = x->get_operand(0);
-  Type *ty = cvt(x->get_type()->get_scalar_ty());
   unsigned axis = x->get_axis();
+  analysis::scanline_layout* layout = layouts_->get(arg)->to_scanline();
+  int stride = layout->lane_stride(axis);
+  int per_warp = layout->mts_per_warp(axis);
+  int num_warps = layout->mts(axis) / per_warp;
+  // accumulators of reds[m] are in [begin[m], begin[m+1])
+  std::vector<size_t> begin = {0};
+  for(ir::reduce_inst *red: reds)
+    begin.push_back(begin.back() + (red->has_pair_acc() ? 2 : 1));
+  auto do_acc = [&](const reduce_acc_t &x, const reduce_acc_t &y) -> reduce_acc_t {
+    reduce_acc_t ret;
+    for(size_t m = 0; m < reds.size(); m++){
+      reduce_acc_t xm(x.begin() + begin[m], x.begin() + begin[m+1]);
+      reduce_acc_t ym(y.begin() + begin[m], y.begin() + begin[m+1]);
+      reduce_acc_t rm = fns[m](xm, ym);
+      ret.insert(ret.end(), rm.begin(), rm.end());
+    }
+    return ret;
+  };
 
   // reduce within thread
-  std::map<indices_t, Value*> accs;
+  std::map<indices_t, reduce_acc_t> accs;
   for(indices_t idx: idxs_.at(arg)){
     indices_t pidx = idx;
     pidx[axis] = i32(0);
-    Value *current = vals_[arg][idx];
+    reduce_acc_t current;
+    for(ir::reduce_inst *red: reds){
+      current.push_back(vals_[red->get_operand(0)][idx]);
+      if(red->is_arg_op())
+        current.push_back(idx[axis]);
+      if(red->get_op() == ir::reduce_inst::FLOGSUMEXP)
+        current.push_back(ConstantFP::get(f32_ty, 1));
+    }
     bool is_first = accs.find(pidx) == accs.end();
     accs[pidx] = is_first ? current : do_acc(accs[pidx], current);
   };
 
-  // reduce within blocks
-  analysis::data_layout* layout = layouts_->get(layouts_->tmp(x));
-  Value *base = shared_ptr_.at(layout);
-  auto shape  = layout->get_shape();
-  auto order  = layout->get_order();
-  int  space = base->getType()->getPointerAddressSpace();
-  Value *ptr = bit_cast(base, ptr_ty(ty, space));
-  Value *lane = axes_.at(a_axes_->get(arg, axis)).thread_id;
-  for(auto& x: accs) {
-    // current element being computed
-    Value *&acc = x.second;
-    indices_t write_idx = x.first;
-    write_idx[axis] = lane;
-    // shared memory write  pointer
-    Value *write_off = shared_off(shape, order, write_idx);
-    Value *write_ptr = gep(ptr, write_off);
-    // initialize shared memory
+  // reduce within warp
+  for(auto& x: accs)
+  for(int i = per_warp/2; i > 0; i >>= 1)
+    x.second = do_acc(x.second, shfl_sync(x.second, i*stride));
+
+  // reduce across warps
+  if(num_warps > 1){
+    analysis::data_layout* tmp = layouts_->get(layouts_->tmp(x));
+    Value *base = shared_ptr_.at(tmp);
+    auto shape  = tmp->get_shape();
+    auto order  = tmp->get_order();
+    int  space = base->getType()->getPointerAddressSpace();
+    // the temporary holds one array per accumulator, widest first
+    shape[axis] = num_warps;
+    unsigned num_elements = std::accumulate(shape.begin(), shape.end(), 1, std::multiplies<unsigned>());
+    const reduce_acc_t& types = accs.begin()->second;
+    auto size_of = [&](size_t k) { return types[k]->getType()->getPrimitiveSizeInBits() / 8; };
+    std::vector<size_t> arrays(types.size());
+    std::iota(arrays.begin(), arrays.end(), 0);
+    std::stable_sort(arrays.begin(), arrays.end(), [&](size_t a, size_t b) { return size_of(a) > size_of(b); });
+    std::vector<Value*> ptrs(types.size());
+    unsigned offset = 0;
+    for(size_t k: arrays){
+      Value *ptr = gep(bit_cast(base, ptr_ty(i8_ty, space)), i32(offset));
+      ptrs[k] = bit_cast(ptr, ptr_ty(types[k]->getType(), space));
+      offset += num_elements * size_of(k);
+    }
+    Value *warp = udiv(axes_.at(a_axes_->get(arg, axis)).thread_id, i32(per_warp));
+    for(auto& x: accs){
+      indices_t idx = x.first;
+      idx[axis] = warp;
+      Value *off = shared_off(shape, order, idx);
+      for(size_t k = 0; k < ptrs.size(); k++)
+        store(x.second[k], gep(ptrs[k], off));
+    }
     add_barrier();
-    store(acc, write_ptr);
-    // build result
-    indices_t idx(write_idx.size(), i32(0));
-    for(size_t i = shape[axis]/2; i > 0; i >>= 1){
-      idx[axis] = i32(i);
-      // read pointer
-      Value *read_msk = icmp_ult(lane, i32(i));
-      Value *read_off = select(read_msk, shared_off(shape, order, idx), i32(0));
-      Value *read_ptr = gep(write_ptr, read_off);
-      add_barrier();
-      // update accumulator
-      acc = do_acc(acc, load(read_ptr));
-      add_barrier();
-      store(acc, write_ptr);
+    for(auto& x: accs){
+      reduce_acc_t acc;
+      indices_t idx = x.first;
+      for(int w = 0; w < num_warps; w++){
+        idx[axis] = i32(w);
+        Value *off = shared_off(shape, order, idx);
+        reduce_acc_t current;
+        for(Value *ptr: ptrs)
+          current.push_back(load(gep(ptr, off)));
+        acc = acc.empty() ? current : do_acc(acc, current);
+      }
+      x.second = acc;
     }
   }
-  add_barrier();
 
   // write back
-  for(indices_t idx: idxs_.at(x)){
+  for(size_t m = 0; m < reds.size(); m++)
+  for(indices_t idx: idxs_.at(reds[m])){
     indices_t read_idx = idx;
     read_idx.insert(read_idx.begin() + axis, i32(0));
-    Value *read_off = shared_off(shape, order, read_idx);
-    Value *read_ptr = gep(ptr, read_off);
-    vals_[x][idx] = load(read_ptr);
+    const reduce_acc_t &acc = accs.at(read_idx);
+    if(reds[m]->get_op() == ir::reduce_inst::FLOGSUMEXP)
+      vals_[reds[m]][idx] = fadd(acc[begin[m]], fast_log(acc[begin[m] + 1]));
+    else
+      vals_[reds[m]][idx] = acc[begin[m+1] - 1];
+  };
+}
+
+/**
+ * \brief Accumulation function of `reduce`
+ *
+ * Arg reductions carry (value, index) pairs and keep the smallest index
+ * among equal values. logsumexp carries (m, s) pairs standing for
+ * m + log(s), and rescales both sums to the larger m when combining.
+ */
+reduce_fn_t generator::get_reduce_fn(ir::reduce_inst* x) {
+  ir::reduce_inst::op_t op = x->get_op();
+  auto do_arg_acc = [this, op](const reduce_acc_t &x, const reduce_acc_t &y, Value *y_better) -> reduce_acc_t {
+    Value *tie = builder_->CreateAnd(op == ir::reduce_inst::ARGFMAX || op == ir::reduce_inst::ARGFMIN ?
+                                     fcmp(llvm::CmpInst::FCMP_OEQ, y[0], x[0]) : icmp_eq(y[0], x[0]),
+                                     icmp(llvm::CmpInst::ICMP_SLT, y[1], x[1]));
+    Value *take_y = builder_->CreateOr(y_better, tie);
+    return {select(take_y, y[0], x[0]), select(take_y, y[1], x[1])};
+  };
+  auto do_lse_acc = [this](const reduce_acc_t &x, const reduce_acc_t &y) -> reduce_acc_t {
+    Value *m = max_num(x[0], y[0]);
+    // the scale of the larger operand is one, even when both are infinite
+    auto scale = [&](Value *v) {
+      return select(fcmp(llvm::CmpInst::FCMP_OEQ, v, m), ConstantFP::get(f32_ty, 1), fast_exp(fsub(v, m)));
+    };
+    return {m, fadd(fmul(x[1], scale(x[0])), fmul(y[1], scale(y[0])))};
+  };
+  return [this, op, do_arg_acc, do_lse_acc](const reduce_acc_t &x, const reduce_acc_t &y) -> reduce_acc_t {
+    switch(op){
+    case ir::reduce_inst::ADD: return {add(x[0], y[0])};
+    case ir::reduce_inst::SUB: return {sub(x[0], y[0])};
+    case ir::reduce_inst::MAX: return {select(icmp_sge(x[0], y[0]), x[0], y[0])};
+    case ir::reduce_inst::MIN: return {select(icmp_sle(x[0], y[0]), x[0], y[0])};
+    case ir::reduce_inst::FADD: return {fadd(x[0], y[0])};
+    case ir::reduce_inst::FSUB: return {fsub(x[0], y[0])};
+    case ir::reduce_inst::FMAX: return {max_num(x[0], y[0])};
+    case ir::reduce_inst::FMIN: return {min_num(x[0], y[0])};
+    case ir::reduce_inst::FLOGSUMEXP: return do_lse_acc(x, y);
+    case ir::reduce_inst::ARGMAX: return do_arg_acc(x, y, icmp(llvm::CmpInst::ICMP_SGT, y[0], x[0]));
+    case ir::reduce_inst::ARGMIN: return do_arg_acc(x, y, icmp(llvm::CmpInst::ICMP_SLT, y[0], x[0]));
+    case ir::reduce_inst::ARGFMAX: return do_arg_acc(x, y, fcmp(llvm::CmpInst::FCMP_OGT, y[0], x[0]));
+    case ir::reduce_inst::ARGFMIN: return do_arg_acc(x, y, fcmp(llvm::CmpInst::FCMP_OLT, y[0], x[0]));
+    default: throw std::runtime_error("unreachable");
+    }
   };
 }
 
 /**
  * \brief Code Generation for `reduce` (generic case)
+ *
+ * Reductions fused with `x` are lowered when visiting the first of them.
  */
 void generator::visit_reduce_inst(ir::reduce_inst* x) {
+  const std::vector<ir::reduce_inst*>& reds = layouts_->fused_with(x);
+  if(reds.front() != x)
+    return;
+  std::vector<reduce_fn_t> fns;
+  for(ir::reduce_inst *red: reds){
+    // operands of the later reductions are computed before `x`
+    visit_value(red->get_operand(0));
+    init_idx(red);
+    fns.push_back(get_reduce_fn(red));
+  }
+  visit_reducend_inst(reds, fns);
+}
+
+/**
+ * \brief Code Generation for `scan`
+ *
+ * Each line along the axis is split in `reps` chunks of `nts` elements per
+ * thread. Chunks are scanned sequentially within threads, then across the
+ * lanes of a warp with a Kogge-Stone scan of the thread totals, and finally
+ * across warps through shared memory. Chunks are chained with a carry.
+ */
+void generator::visit_scan_inst(ir::scan_inst* x) {
+  ir::value *arg = x->get_operand(0);
   Type *ty = cvt(x->get_type()->get_scalar_ty());
+  unsigned axis = x->get_axis();
   // accumulation function
-  ir::reduce_inst::op_t op = x->get_op();
+  ir::scan_inst::op_t op = x->get_op();
   auto do_acc = [&](Value *x, Value *y) -> Value* {
     switch(op){
-    case ir::reduce_inst::ADD: return add(x, y);
-    case ir::reduce_inst::SUB: return sub(x, y);
-    case ir::reduce_inst::MAX: return select(icmp_sge(x, y), x, y);
-    case ir::reduce_inst::MIN: return select(icmp_sle(x, y), x, y);
-    case ir::reduce_inst::FADD: return fadd(x, y);
-    case ir::reduce_inst::FSUB: return fsub(x, y);
-    case ir::reduce_inst::FMAX: return max_num(x, y);
-    case ir::reduce_inst::FMIN: return min_num(x, y);
+    case ir::scan_inst::ADD: return add(x, y);
+    case ir::scan_inst::MUL: return mul(x, y);
+    case ir::scan_inst::MAX: return select(icmp_sge(x, y), x, y);
+    case ir::scan_inst::MIN: return select(icmp_sle(x, y), x, y);
+    case ir::scan_inst::FADD: return fadd(x, y);
+    case ir::scan_inst::FMUL: return fmul(x, y);
+    case ir::scan_inst::FMAX: return max_num(x, y);
+    case ir::scan_inst::FMIN: return min_num(x, y);
     default: throw std::runtime_error("unreachable");
     }
   };
+  // nullptr stands for the neutral element
+  auto combine = [&](Value *x, Value *y) -> Value* {
+    return !x ? y : !y ? x : do_acc(x, y);
+  };
   // neutral element
+  unsigned nbits = ty->getScalarSizeInBits();
   Value *neutral;
   switch(op) {
-    case ir::reduce_inst::ADD: neutral = ConstantInt::get(ty, 0); break;
-    case ir::reduce_inst::SUB:  neutral = ConstantInt::get(ty, 0); break;
-    case ir::reduce_inst::MAX:  neutral = ConstantInt::get(ty, INT32_MIN); break;
-    case ir::reduce_inst::MIN:  neutral = ConstantInt::get(ty, INT32_MAX); break;
-    case ir::reduce_inst::FADD: neutral = ConstantFP::get(ty, 0); break;
-    case ir::reduce_inst::FSUB: neutral = ConstantFP::get(ty, 0); break;
-    case ir::reduce_inst::FMAX: neutral = ConstantFP::get(ty, -INFINITY); break;
-    case ir::reduce_inst::FMIN: neutral = ConstantFP::get(ty, INFINITY); break;
+    case ir::scan_inst::ADD: neutral = ConstantInt::get(ty, 0); break;
+    case ir::scan_inst::MUL: neutral = ConstantInt::get(ty, 1); break;
+    case ir::scan_inst::MAX: neutral = ConstantInt::get(ty, APInt::getSignedMinValue(nbits)); break;
+    case ir::scan_inst::MIN: neutral = ConstantInt::get(ty, APInt::getSignedMaxValue(nbits)); break;
+    case ir::scan_inst::FADD: neutral = ConstantFP::get(ty, 0); break;
+    case ir::scan_inst::FMUL: neutral = ConstantFP::get(ty, 1); break;
+    case ir::scan_inst::FMAX: neutral = ConstantFP::get(ty, -INFINITY); break;
+    case ir::scan_inst::FMIN: neutral = ConstantFP::get(ty, INFINITY); break;
     default: throw std::runtime_error("unreachable");
   }
-  ir::value *arg = x->get_operand(0);
-  if(arg->get_type()->get_tile_rank() == 1)
-    visit_reduce1d_inst(x, do_acc, neutral);
+  // distribution of the axis
+  analysis::scanline_layout* layout = layouts_->get(arg)->to_scanline();
+  int nts = layout->nts(axis);
+  int mts = layout->mts(axis);
+  int reps = layout->rep_per_cta(axis);
+  int stride = layout->lane_stride(axis);
+  int per_warp = layout->mts_per_warp(axis);
+  int num_warps = mts / per_warp;
+  // lines along the axis, in increasing order
+  std::map<indices_t, std::vector<indices_t>> lines;
+  for(indices_t idx: idxs_.at(arg)){
+    indices_t pidx = idx;
+    pidx[axis] = i32(0);
+    lines[pidx].push_back(idx);
+  }
+
+  // scan within threads
+  std::map<indices_t, std::vector<Value*>> thread_totals;
+  for(auto& line: lines)
+  for(int r = 0; r < reps; r++){
+    Value *acc = nullptr;
+    for(int n = r*nts; n < (r+1)*nts; n++){
+      indices_t idx = line.second[n];
+      acc = combine(acc, vals_[arg][idx]);
+      vals_[x][idx] = acc;
+    }
+    thread_totals[line.first].push_back(acc);
+  }
+
+  // scan within warps
+  std::map<indices_t, std::vector<Value*>> prefixes;
+  std::map<indices_t, std::vector<Value*>> totals;
+  Value *thread = nullptr, *lane = nullptr, *warp = nullptr;
+  if(mts > 1){
+    thread = axes_.at(a_axes_->get(arg, axis)).thread_id;
+    lane = urem(tgt_->get_local_id(mod_, *builder_, 0), i32(32));
+    warp = udiv(thread, i32(per_warp));
+    Value *warp_lane = urem(thread, i32(per_warp));
+    Value *is_first = icmp_eq(warp_lane, i32(0));
+    Value *last = add(lane, mul(sub(i32(per_warp - 1), warp_lane), i32(stride)));
+    for(auto& line: thread_totals)
+    for(Value *acc: line.second){
+      for(int d = 1; d < per_warp; d <<= 1){
+        Value *other = shfl_up(acc, d*stride);
+        acc = select(icmp_ult(warp_lane, i32(d)), acc, do_acc(acc, other));
+      }
+      if(per_warp > 1){
+        prefixes[line.first].push_back(select(is_first, neutral, shfl_up(acc, stride)));
+        totals[line.first].push_back(shfl_idx(acc, last));
+      }
+      else{
+        prefixes[line.first].push_back(nullptr);
+        totals[line.first].push_back(acc);
+      }
+    }
+  }
   else
-    visit_reducend_inst(x, do_acc, neutral);
+    totals = thread_totals;
+
+  // scan across warps
+  if(num_warps > 1){
+    analysis::shared_layout* tmp = layouts_->get(layouts_->tmp(x))->to_shared();
+    auto shape = tmp->get_shape();
+    auto order = tmp->get_order();
+    Value *base = shared_ptr_.at(tmp);
+    Value *ptr = bit_cast(base, ptr_ty(ty, base->getType()->getPointerAddressSpace()));
+    for(auto& line: totals)
+    for(int r = 0; r < reps; r++){
+      indices_t idx = line.first;
+      idx[axis] = add(i32(r*num_warps), warp);
+      store(line.second[r], gep(ptr, shared_off(shape, order, idx)));
+    }
+    add_barrier();
+    for(auto& line: totals)
+    for(int r = 0; r < reps; r++){
+      Value *prefix = neutral;
+      Value *total = nullptr;
+      indices_t idx = line.first;
+      for(int w = 0; w < num_warps; w++){
+        idx[axis] = i32(r*num_warps + w);
+        Value *current = load(gep(ptr, shared_off(shape, order, idx)));
+        prefix = select(icmp_ult(i32(w), warp), do_acc(prefix, current), prefix);
+        total = combine(total, current);
+      }
+      Value *&thread_prefix = prefixes[line.first][r];
+      thread_prefix = combine(prefix, thread_prefix);
+      line.second[r] = total;
+    }
+  }
+
+  // propagate prefixes
+  for(auto& line: lines){
+    Value *carry = nullptr;
+    for(int r = 0; r < reps; r++){
+      Value *prefix = carry;
+      if(mts > 1)
+        prefix = combine(prefix, prefixes[line.first][r]);
+      if(prefix)
+        for(int n = r*nts; n < (r+1)*nts; n++){
+          indices_t idx = line.second[n];
+          vals_[x][idx] = do_acc(prefix, vals_[x][idx]);
+        }
+      carry = combine(carry, totals[line.first][r]);
+    }
+  }
+}
+
+/**
+ * \brief Code Generation for `sort`
+ *
+ * Bitonic sorting network along the axis. Each compare-exchange stage pairs
+ * position `p` with `p ^ j`: partners held by the same thread are exchanged
+ * in registers, partners in the same warp with butterfly shuffles, and
+ * partners in other warps through shared memory. A top-k keeps the first
+ * `k` sorted elements and redistributes them through shared memory.
+ * CPU targets run a single thread, so the whole network is in registers.
+ */
+void generator::visit_sort_inst(ir::sort_inst* x) {
+  ir::value *arg = x->get_operand(0);
+  Type *ty = cvt(arg->get_type()->get_scalar_ty());
+  bool is_int = arg->get_type()->get_scalar_ty()->is_integer_ty();
+  unsigned axis = x->get_axis();
+  int size = arg->get_type()->get_block_shapes()[axis];
+  auto less = [&](Value *a, Value *b) -> Value* {
+    return is_int ? icmp(llvm::CmpInst::ICMP_SLT, a, b) : fcmp(llvm::CmpInst::FCMP_OLT, a, b);
+  };
+  // distribution of the axis
+  analysis::scanline_layout* layout = layouts_->get(arg)->to_scanline();
+  int nts = layout->nts(axis);
+  int per_cta = layout->shape_per_cta(axis);
+  int stride = layout->lane_stride(axis);
+  int per_warp = layout->mts_per_warp(axis);
+  // lines along the axis, in increasing order
+  std::map<indices_t, std::vector<indices_t>> lines;
+  for(indices_t idx: idxs_.at(arg)){
+    indices_t pidx = idx;
+    pidx[axis] = i32(0);
+    lines[pidx].push_back(idx);
+  }
+  std::map<indices_t, std::vector<Value*>> vals;
+  for(auto& line: lines)
+  for(indices_t idx: line.second)
+    vals[line.first].push_back(vals_[arg][idx]);
+  // shared memory
+  Value *ptr = nullptr;
+  std::vector<unsigned> shape;
+  std::vector<int> order;
+  if(layouts_->has_tmp(x)){
+    analysis::shared_layout* tmp = layouts_->get(layouts_->tmp(x))->to_shared();
+    shape = tmp->get_shape();
+    order = tmp->get_order();
+    Value *base = shared_ptr_.at(tmp);
+    ptr = bit_cast(base, ptr_ty(ty, base->getType()->getPointerAddressSpace()));
+  }
+  bool wrote_shared = false;
+  auto exchange_shared = [&](std::function<indices_t(const indices_t&)> partner_idx) {
+    std::map<indices_t, std::vector<Value*>> ret;
+    if(wrote_shared)
+      add_barrier();
+    for(auto& line: lines)
+    for(size_t n = 0; n < line.second.size(); n++)
+      store(vals[line.first][n], gep(ptr, shared_off(shape, order, line.second[n])));
+    add_barrier();
+    wrote_shared = true;
+    for(auto& line: lines)
+    for(size_t n = 0; n < line.second.size(); n++)
+      ret[line.first].push_back(load(gep(ptr, shared_off(shape, order, partner_idx(line.second[n])))));
+    return ret;
+  };
+
+  // bitonic network
+  for(int k = 2; k <= size; k <<= 1)
+  for(int j = k / 2; j > 0; j >>= 1){
+    std::map<indices_t, std::vector<Value*>> partners;
+    if(!tgt_->is_gpu() || j < nts || j >= per_cta){
+      int mask = j < nts ? j : (j / per_cta) * nts;
+      for(auto& line: lines)
+      for(size_t n = 0; n < line.second.size(); n++)
+        partners[line.first].push_back(vals[line.first][n ^ mask]);
+    }
+    else if(j / nts < per_warp){
+      for(auto& line: lines)
+        partners[line.first] = shfl_sync(vals[line.first], (j / nts) * stride);
+    }
+    else
+      partners = exchange_shared([&](const indices_t& idx) {
+        indices_t ret = idx;
+        ret[axis] = xor_(idx[axis], i32(j));
+        return ret;
+      });
+    for(auto& line: lines)
+    for(size_t n = 0; n < line.second.size(); n++){
+      Value *p = line.second[n][axis];
+      Value *asc = icmp_eq(and_(p, i32(k)), i32(0));
+      if(x->is_descending())
+        asc = builder_->CreateNot(asc);
+      Value *keep_min = icmp_eq(icmp_eq(and_(p, i32(j)), i32(0)), asc);
+      Value *a = vals[line.first][n];
+      Value *b = partners[line.first][n];
+      Value *min = select(less(b, a), b, a);
+      Value *max = select(less(b, a), a, b);
+      vals[line.first][n] = select(keep_min, min, max);
+    }
+  }
+
+  // write back
+  if(!x->is_topk()){
+    for(auto& line: lines)
+    for(size_t n = 0; n < line.second.size(); n++)
+      vals_[x][line.second[n]] = vals[line.first][n];
+    return;
+  }
+  if(!tgt_->is_gpu()){
+    // indices of a single thread are constants: the first `k` elements
+    // are picked by position
+    auto position = [](const indices_t& idx) {
+      std::vector<uint64_t> ret;
+      for(Value *i: idx)
+        ret.push_back(llvm::cast<ConstantInt>(i)->getZExtValue());
+      return ret;
+    };
+    std::map<std::vector<uint64_t>, Value*> sorted;
+    for(auto& line: lines)
+    for(size_t n = 0; n < line.second.size(); n++)
+      sorted[position(line.second[n])] = vals[line.first][n];
+    for(indices_t idx: idxs_.at(x))
+      vals_[x][idx] = sorted.at(position(idx));
+    return;
+  }
+  if(wrote_shared)
+    add_barrier();
+  for(auto& line: lines)
+  for(size_t n = 0; n < line.second.size(); n++)
+    store(vals[line.first][n], gep(ptr, shared_off(shape, order, line.second[n])));
+  add_barrier();
+  for(indices_t idx: idxs_.at(x))
+    vals_[x][idx] = load(gep(ptr, shared_off(shape, order, idx)));
 }
 
 /**
@@ -2289,7 +3116,7 @@ void generator::visit_layout_mma(analysis::mma_layout* layout) {
   ir::value *a = nullptr;
   ir::value *b = nullptr;
   for(ir::value* v: layout->get_values())
-    if(ir::dot_inst* dot = dynamic_cast<ir::dot_inst*>(v)){
+    if(ir::dot_inst* dot = ir::dyn_cast<ir::dot_inst>(v)){
       a = dot->get_operand(0);
       b = dot->get_operand(1);
     }
@@ -2660,12 +3487,12 @@ void generator::finalize_shared_layout(analysis::shared_layout *shared) {
 void generator::finalize_function(ir::function *fn) {
   // finalize double-buffering
   for(const auto& x: layouts_->get_all())
-  if(auto *shared = dynamic_cast<analysis::shared_layout*>(x.second))
+  if(auto *shared = x.second->to_shared())
     finalize_shared_layout(shared);
   // finalize phi
   for(ir::basic_block *block: fn->blocks())
   for(ir::instruction *inst: block->get_inst_list())
-    if(auto *phi = dynamic_cast<ir::phi_node*>(inst))
+    if(auto *phi = ir::dyn_cast<ir::phi_node>(inst))
       finalize_phi_node(phi);
   for(auto& x: lazy_phi_incs_)
     std::get<0>(x)->addIncoming(std::get<1>(x), bbs_[std::get<2>(x)]);
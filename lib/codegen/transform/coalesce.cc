@@ -21,7 +21,7 @@ coalesce::coalesce(analysis::align* align, analysis::layouts *layouts)
 //   - cvt_1(elementwise(x, y)) = elementwise(convert(x), convert(y))
 //ir::value* coalesce::simplify(ir::instruction *inst, ir::builder& builder){
 //  ir::value* _op = inst->get_operand(0);
-//  ir::instruction* op = dynamic_cast<ir::instruction*>(_op);
+//  ir::instruction* op = ir::dyn_cast<ir::instruction>(_op);
 //  analysis::mma_layout* mma_in  = layout_->get(op)  ->to_mma();
 //  analysis::mma_layout* mma_out = layout_->get(inst)->to_mma();
 //  std::cout << 1 << std::endl;
@@ -58,7 +58,7 @@ void coalesce::run(ir::module &mod) {
   for(ir::basic_block *block: fn->blocks())
   for(ir::instruction* i: block->get_inst_list()){
     // coalesce before store
-    if(auto x = dynamic_cast<ir::store_inst*>(i))
+    if(auto x = ir::dyn_cast<ir::store_inst>(i))
     if(ir::value* op = x->get_value_operand())
     if(op->get_type()->is_block_ty())
     if(layout_->get(op)->to_mma()){
@@ -68,7 +68,7 @@ void coalesce::run(ir::module &mod) {
       x->replace_uses_of_with(op, new_op);
     }
     // uncoalesce after load
-    if(auto x = dynamic_cast<ir::load_inst*>(i))
+    if(auto x = ir::dyn_cast<ir::load_inst>(i))
     if(x->get_type()->is_block_ty())
     if(x->get_type()->get_tile_rank()==2)
     if(layout_->get(x)->to_mma()){
@@ -80,14 +80,14 @@ void coalesce::run(ir::module &mod) {
 //        new_x->replace_uses_of_with(new_x, new_x);
     }
     // re-arrange scanline to promote memory coalescing
-    if(auto x = dynamic_cast<ir::store_inst*>(i)){
+    if(auto x = ir::dyn_cast<ir::store_inst>(i)){
       ir::value* ptr = x->get_pointer_operand();
       ir::value* val = x->get_value_operand();
       auto out_contig = align_->contiguous(ptr);
-      auto val_inst = dynamic_cast<ir::instruction*>(val);
+      auto val_inst = ir::dyn_cast<ir::instruction>(val);
       if(!val_inst)
         break;
-      if(dynamic_cast<ir::cvt_layout_inst*>(val))
+      if(ir::isa<ir::cvt_layout_inst>(val))
         break;
       std::vector<unsigned> in_contig;
       std::vector<ir::instruction*> queue = {val_inst};
@@ -97,12 +97,12 @@ void coalesce::run(ir::module &mod) {
         ir::instruction* curr = queue.back();
         seen.insert(curr);
         queue.pop_back();
-        if(auto io_inst = dynamic_cast<ir::io_inst*>(curr)){
+        if(auto io_inst = ir::dyn_cast<ir::io_inst>(curr)){
           in_contig = align_->contiguous(io_inst->get_pointer_operand());
           break;
         }
         for(ir::value* op: curr->ops()){
-          auto inst_op = dynamic_cast<ir::instruction*>(op);
+          auto inst_op = ir::dyn_cast<ir::instruction>(op);
           if(!inst_op || seen.find(inst_op) != seen.end())
             continue;
           if(!op->get_type()->is_block_ty() ||
@@ -21,7 +21,7 @@ inline bool is_shmem_op(ir::instruction* i, int op) {
 }
 
 inline bool is_shmem_res(ir::value* v){
-  ir::instruction* i = dynamic_cast<ir::instruction*>(v);
+  ir::instruction* i = ir::dyn_cast<ir::instruction>(v);
   if(!i)
     return false;
   if(i->get_id() == ir::INST_TRANS)
@@ -36,7 +36,7 @@ inline bool is_shmem_res(ir::value* v){
 
 // run pass on module
 void cts::add_copy(ir::instruction *parent, ir::value *x, ir::builder &builder, bool to_shared) {
-  auto *i = dynamic_cast<ir::instruction*>(x);
+  auto *i = ir::dyn_cast<ir::instruction>(x);
   // not an instruction
   if(!i) {
     builder.set_insert_point(parent);
@@ -49,7 +49,7 @@ void cts::add_copy(ir::instruction *parent, ir::value *x, ir::builder &builder,
     return;
   }
   // phi node
-  if(auto* phi = dynamic_cast<ir::phi_node*>(x)) {
+  if(auto* phi = ir::dyn_cast<ir::phi_node>(x)) {
     for(unsigned i = 0; i < phi->get_num_incoming(); ++i)
       add_copy(phi, phi->get_incoming_value(i), builder, to_shared);
     return;
@@ -82,7 +82,7 @@ void cts::run(ir::module &mod) {
         }
       // copy from shared operands
       for(size_t k = 0; k < num_op; k++)
-        if(!dynamic_cast<ir::phi_node*>(i) &&
+        if(!ir::isa<ir::phi_node>(i) &&
            !is_shmem_op(i,k) &&
            is_shmem_res(i->get_operand(k))){
           add_copy(i, i->get_operand(k), builder, false);
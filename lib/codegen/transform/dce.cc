@@ -45,7 +45,7 @@ void dce::run(ir::module &mod) {
     work_list.pop_back();
     // mark instruction operands
     for(ir::value* op: current->ops()) {
-      if(auto *i = dynamic_cast<ir::instruction*>(op)){
+      if(auto *i = ir::dyn_cast<ir::instruction>(op)){
         if(marked.insert(i).second)
           work_list.push_back(i);
       }
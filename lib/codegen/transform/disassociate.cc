@@ -19,8 +19,8 @@ ir::instruction* rematerialize(ir::builder& bld, ir::instruction *root,
   bld.set_insert_point(root);
   ir::instruction *new_root = bld.insert(root->clone());
   for(ir::value *op: root->ops()){
-    ir::instruction *i = dynamic_cast<ir::instruction*>(op);
-    if(!i || i->get_id() == ir::INST_REDUCE)
+    ir::instruction *i = ir::dyn_cast<ir::instruction>(op);
+    if(!i || i->get_id() == ir::INST_REDUCE || i->get_id() == ir::INST_SCAN || i->get_id() == ir::INST_SORT)
       continue;
     ir::instruction* new_op = rematerialize(bld, i, seen);
     new_root->replace_uses_of_with(op, new_op);
@@ -34,7 +34,7 @@ void disassociate::run(ir::module &mod) {
 //  ir::for_each_instruction(mod, [&](ir::instruction *i){
 //    bld.set_insert_point(i);
 //    for(ir::value* op: i->ops()){
-//      auto reshape = dynamic_cast<ir::make_range*>(op);
+//      auto reshape = ir::dyn_cast<ir::make_range>(op);
 //      if(!reshape)
 //        continue;
 //      ir::instruction* new_op = bld.insert(reshape->clone());
@@ -44,7 +44,7 @@ void disassociate::run(ir::module &mod) {
 
 
   ir::for_each_instruction(mod, [&](ir::instruction *i){
-    if(dynamic_cast<ir::reshape_inst*>(i) || dynamic_cast<ir::splat_inst*>(i)){
+    if(ir::isa<ir::reshape_inst>(i) || ir::isa<ir::splat_inst>(i)){
       std::set<ir::value*> seen;
       ir::instruction* new_i = rematerialize(bld, i, seen);
       i->replace_all_uses_with(new_i);
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include "triton/codegen/transform/gvn.h"
+#include "triton/ir/module.h"
+#include "triton/ir/function.h"
+#include "triton/ir/basic_block.h"
+#include "triton/ir/instructions.h"
+#include "triton/ir/utils.h"
+
+namespace triton {
+namespace codegen{
+namespace transform{
+
+static bool is_commutative(ir::binary_op_t op) {
+  switch(op){
+    case ir::binary_op_t::Add:
+    case ir::binary_op_t::FAdd:
+    case ir::binary_op_t::Mul:
+    case ir::binary_op_t::FMul:
+    case ir::binary_op_t::And:
+    case ir::binary_op_t::Or:
+    case ir::binary_op_t::Xor:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/// returns false if `i` may have side-effects or depends on memory
+bool gvn::get_key(ir::instruction *i, key_t &key) {
+  std::vector<int> attrs;
+  switch(i->get_id()){
+    case ir::INST_BINOP: {
+      auto *x = (ir::binary_operator*)i;
+      attrs = {x->has_no_unsigned_wrap_, x->has_no_signed_wrap_};
+      break;
+    }
+    case ir::INST_TRANS: {
+      auto perm = ((ir::trans_inst*)i)->get_perm();
+      attrs.assign(perm.begin(), perm.end());
+      break;
+    }
+    case ir::INST_REDUCE: {
+      auto *x = (ir::reduce_inst*)i;
+      attrs = {(int)x->get_op(), (int)x->get_axis()};
+      break;
+    }
+    case ir::INST_SCAN: {
+      auto *x = (ir::scan_inst*)i;
+      attrs = {(int)x->get_op(), (int)x->get_axis()};
+      break;
+    }
+    case ir::INST_SORT: {
+      auto *x = (ir::sort_inst*)i;
+      attrs = {(int)x->get_axis(), (int)x->get_k(), (int)x->is_descending()};
+      break;
+    }
+    case ir::INST_ICMP:
+    case ir::INST_FCMP:
+    case ir::INST_GETELEMENTPTR:
+    case ir::INST_RESHAPE:
+    case ir::INST_SPLAT:
+    case ir::INST_BROADCAST:
+    case ir::INST_DOWNCAST:
+    case ir::INST_GET_PROGRAM_ID:
+    case ir::INST_GET_NUM_PROGRAMS:
+    case ir::INST_EXP:
+    case ir::INST_COS:
+    case ir::INST_SIN:
+    case ir::INST_LOG:
+    case ir::INST_SQRT:
+    case ir::INST_SELECT:
+    case ir::INST_MAKE_RANGE:
+      break;
+    default:
+      if(!ir::isa<ir::cast_inst>(i))
+        return false;
+  }
+  // user-provided hints must be preserved
+  attrs.push_back(i->get_metadata(ir::metadata::multiple_of));
+  attrs.push_back(i->get_metadata(ir::metadata::max_contiguous));
+  std::vector<ir::value*> ops = i->ops();
+  if(auto *x = ir::dyn_cast<ir::binary_operator>(i))
+  if(is_commutative(x->get_op()) && ops[1] < ops[0])
+    std::swap(ops[0], ops[1]);
+  key = key_t(i->get_id(), i->get_type(), i->repr(), ops, attrs);
+  return true;
+}
+
+void gvn::visit(ir::basic_block *block, const dom_tree_t &children, table_t &table) {
+  std::vector<key_t> added;
+  std::vector<ir::instruction*> to_delete;
+  for(ir::instruction *i: block->get_inst_list()){
+    key_t key;
+    if(!get_key(i, key))
+      continue;
+    auto it = table.find(key);
+    if(it == table.end()){
+      table.insert({key, i});
+      added.push_back(key);
+      continue;
+    }
+    i->replace_all_uses_with(it->second);
+    to_delete.push_back(i);
+    num_removed_++;
+    num_removed_elements_ += i->get_type()->is_block_ty() ? i->get_type()->get_tile_num_elements() : 1;
+  }
+  for(ir::instruction *i: to_delete)
+    i->erase_from_parent();
+  // values available in `block` are available in the blocks it dominates
+  auto it = children.find(block);
+  if(it != children.end())
+    for(ir::basic_block *child: it->second)
+      visit(child, children, table);
+  for(const key_t &key: added)
+    table.erase(key);
+}
+
+void gvn::run(ir::module &mod) {
+  num_removed_ = 0;
+  num_removed_elements_ = 0;
+  for(ir::function *fn: mod.get_function_list()){
+    std::map<ir::basic_block*, ir::basic_block*> idom = ir::cfg::immediate_dominators(fn);
+    dom_tree_t children;
+    std::vector<ir::basic_block*> roots;
+    for(ir::basic_block *block: ir::cfg::reverse_post_order(fn)){
+      if(ir::basic_block *parent = idom.at(block))
+        children[parent].push_back(block);
+      else
+        roots.push_back(block);
+    }
+    table_t table;
+    for(ir::basic_block *root: roots)
+      visit(root, children, table);
+  }
+}
+
+}
+}
+}
@@ -0,0 +1,218 @@
+#include <algorithm>
+#include "triton/codegen/transform/licm.h"
+#include "triton/ir/module.h"
+#include "triton/ir/function.h"
+#include "triton/ir/basic_block.h"
+#include "triton/ir/instructions.h"
+#include "triton/ir/constant.h"
+#include "triton/ir/utils.h"
+
+namespace triton {
+namespace codegen{
+namespace transform{
+
+/// whether `i` can be executed speculatively
+static bool is_speculatable(ir::instruction *i) {
+  switch(i->get_id()){
+    case ir::INST_BINOP:
+      // integer division by zero is undefined
+      return !((ir::binary_operator*)i)->is_int_div() && !((ir::binary_operator*)i)->is_int_rem();
+    case ir::INST_ICMP:
+    case ir::INST_FCMP:
+    case ir::INST_GETELEMENTPTR:
+    case ir::INST_RESHAPE:
+    case ir::INST_SPLAT:
+    case ir::INST_BROADCAST:
+    case ir::INST_DOWNCAST:
+    case ir::INST_GET_PROGRAM_ID:
+    case ir::INST_GET_NUM_PROGRAMS:
+    case ir::INST_EXP:
+    case ir::INST_COS:
+    case ir::INST_SIN:
+    case ir::INST_LOG:
+    case ir::INST_SQRT:
+    case ir::INST_TRANS:
+    case ir::INST_REDUCE:
+    case ir::INST_SCAN:
+    case ir::INST_SORT:
+    case ir::INST_SELECT:
+    case ir::INST_MAKE_RANGE:
+      return true;
+    default:
+      return ir::isa<ir::cast_inst>(i);
+  }
+}
+
+/// kernel argument `ptr` is derived from, or nullptr if unknown
+static ir::argument* get_base_argument(ir::value *ptr, std::set<ir::value*> &seen) {
+  if(!seen.insert(ptr).second)
+    return nullptr;
+  if(auto *arg = ir::dyn_cast<ir::argument>(ptr))
+    return arg;
+  if(auto *phi = ir::dyn_cast<ir::phi_node>(ptr)){
+    ir::argument *res = nullptr;
+    for(unsigned n = 0; n < phi->get_num_incoming(); n++){
+      ir::value *inc = phi->get_incoming_value(n);
+      // self-references do not change the base
+      if(inc == phi || seen.find(inc) != seen.end())
+        continue;
+      ir::argument *arg = get_base_argument(inc, seen);
+      if(!arg || (res && res != arg))
+        return nullptr;
+      res = arg;
+    }
+    return res;
+  }
+  auto *i = ir::dyn_cast<ir::instruction>(ptr);
+  if(i && (ir::isa<ir::getelementptr_inst>(i) || ir::isa<ir::retile_inst>(i)))
+    return get_base_argument(i->get_operand(0), seen);
+  return nullptr;
+}
+
+static ir::argument* get_base_argument(ir::value *ptr) {
+  std::set<ir::value*> seen;
+  return get_base_argument(ptr, seen);
+}
+
+/// natural loops of `fn`, innermost first
+std::vector<licm::loop_t> licm::get_loops(ir::function *fn) {
+  std::map<ir::basic_block*, ir::basic_block*> idom = ir::cfg::immediate_dominators(fn);
+  std::vector<loop_t> loops;
+  for(ir::basic_block *header: fn->blocks()){
+    if(idom.find(header) == idom.end())
+      continue;
+    // blocks that reach a back-edge without going through the header
+    std::vector<ir::basic_block*> stack;
+    for(ir::basic_block *pred: header->get_predecessors())
+      if(idom.find(pred) != idom.end() && ir::cfg::dominates(idom, header, pred))
+        stack.push_back(pred);
+    if(stack.empty())
+      continue;
+    loop_t loop;
+    loop.header = header;
+    loop.blocks.insert(header);
+    while(!stack.empty()){
+      ir::basic_block *block = stack.back();
+      stack.pop_back();
+      if(loop.blocks.insert(block).second)
+        for(ir::basic_block *pred: block->get_predecessors())
+          stack.push_back(pred);
+    }
+    // only loops with a unique entry block
+    std::vector<ir::basic_block*> entries;
+    for(ir::basic_block *pred: header->get_predecessors())
+      if(loop.blocks.find(pred) == loop.blocks.end())
+        entries.push_back(pred);
+    if(entries.size() != 1 || entries[0]->empty() || !ir::isa<ir::branch_inst>(&entries[0]->back()))
+      continue;
+    loop.preheader = entries[0];
+    loops.push_back(loop);
+  }
+  std::stable_sort(loops.begin(), loops.end(), [](const loop_t &a, const loop_t &b) {
+    return a.blocks.size() < b.blocks.size();
+  });
+  return loops;
+}
+
+bool licm::is_invariant(ir::instruction *i, const loop_t &loop) {
+  for(ir::value *op: i->ops()){
+    auto *x = ir::dyn_cast_or_null<ir::instruction>(op);
+    if(x && loop.blocks.find(x->get_parent()) != loop.blocks.end())
+      return false;
+  }
+  return true;
+}
+
+bool licm::can_hoist_load(ir::instruction *i, const loop_t &loop, ir::function *fn) {
+  if(!ir::isa<ir::unmasked_load_inst>(i) && !ir::isa<ir::masked_load_inst>(i))
+    return false;
+  if(((ir::load_inst*)i)->get_is_volatile())
+    return false;
+  // the load must execute whenever the loop is entered
+  if(i->get_parent() != loop.header)
+    return false;
+  // the loop-entry condition is applied as a mask
+  auto *guard = ir::dyn_cast<ir::cond_branch_inst>(&loop.preheader->back());
+  if(guard && (guard->get_true_dest() != loop.header || !i->get_type()->is_block_ty()))
+    return false;
+  // memory written in the loop
+  std::vector<ir::argument*> written;
+  for(ir::basic_block *block: loop.blocks)
+  for(ir::instruction *x: block->get_inst_list())
+    if(ir::isa<ir::store_inst>(x) || ir::isa<ir::atomic_inst>(x))
+      written.push_back(get_base_argument(((ir::io_inst*)x)->get_pointer_operand()));
+  if(written.empty())
+    return true;
+  ir::argument *base = get_base_argument(((ir::load_inst*)i)->get_pointer_operand());
+  if(!base)
+    return false;
+  bool readonly = false;
+  bool noalias = false;
+  for(ir::attribute attr: fn->get_attributes(base)){
+    readonly |= attr.get_kind() == ir::readonly;
+    noalias |= attr.get_kind() == ir::noalias;
+  }
+  if(readonly)
+    return true;
+  return noalias && std::none_of(written.begin(), written.end(), [&](ir::argument *arg) {
+    return !arg || arg == base;
+  });
+}
+
+void licm::hoist_load(ir::instruction *i, const loop_t &loop, ir::builder &builder) {
+  auto *guard = ir::dyn_cast<ir::cond_branch_inst>(&loop.preheader->back());
+  ir::type *ty = i->get_type();
+  builder.set_insert_point(&loop.preheader->back());
+  ir::value *mask = builder.create_splat(guard->get_cond(), ty->get_block_shapes());
+  ir::value *false_value;
+  if(auto *masked_load = ir::dyn_cast<ir::masked_load_inst>(i)){
+    mask = builder.create_and(mask, masked_load->get_mask_operand());
+    false_value = masked_load->get_false_value_operand();
+  }
+  else
+    false_value = builder.create_splat(ir::undef_value::get(ty->get_scalar_ty()), ty->get_block_shapes());
+  ir::value *ptr = ((ir::load_inst*)i)->get_pointer_operand();
+  ir::instruction *new_load = (ir::instruction*)builder.create_masked_load(ptr, mask, false_value);
+  new_load->copy_metadata_from(i);
+  i->replace_all_uses_with(new_load);
+  i->erase_from_parent();
+}
+
+void licm::run(ir::function *fn, const loop_t &loop, ir::builder &builder) {
+  // visit definitions before their uses
+  for(ir::basic_block *block: ir::cfg::reverse_post_order(fn)){
+    if(loop.blocks.find(block) == loop.blocks.end())
+      continue;
+    std::vector<ir::instruction*> insts(block->begin(), block->end());
+    for(ir::instruction *i: insts){
+      if(!is_invariant(i, loop))
+        continue;
+      bool is_load = ir::isa<ir::load_inst>(i);
+      if(is_load && !can_hoist_load(i, loop, fn))
+        continue;
+      if(!is_load && !is_speculatable(i))
+        continue;
+      num_hoisted_++;
+      if(is_load && ir::isa<ir::cond_branch_inst>(&loop.preheader->back())){
+        hoist_load(i, loop, builder);
+        continue;
+      }
+      block->erase(i);
+      ir::basic_block::inst_list_t &dst = loop.preheader->get_inst_list();
+      dst.insert(std::prev(dst.end()), i);
+      i->set_parent(loop.preheader);
+    }
+  }
+}
+
+void licm::run(ir::module &mod) {
+  num_hoisted_ = 0;
+  ir::builder &builder = mod.get_builder();
+  for(ir::function *fn: mod.get_function_list())
+  for(const loop_t &loop: get_loops(fn))
+    run(fn, loop, builder);
+}
+
+}
+}
+}
@@ -19,7 +19,7 @@ namespace transform{
 
 
 int membar::group_of(ir::value* v, std::vector<ir::value*> &async_write) {
-  if(ir::phi_node* phi = dynamic_cast<ir::phi_node*>(v)){
+  if(ir::phi_node* phi = ir::dyn_cast<ir::phi_node>(v)){
     analysis::shared_layout* layout = layouts_->get(v)->to_shared();
     if (analysis::double_buffer_info_t* info = layout->get_double_buffer())
       return group_of(info->first, async_write);
@@ -85,7 +85,7 @@ bool membar::check_safe_war(ir::instruction* i) {
   
   if (is_i_double_buffered || is_i_n_buffered) {
     // with async copy & prefetch_s disabled, WARs are not safe
-    if (dynamic_cast<ir::masked_load_async_inst*>(i) && !prefetch_->is_prefetched(i))
+    if (ir::isa<ir::masked_load_async_inst>(i) && !prefetch_->is_prefetched(i))
       return false;
     else
       return true;
@@ -102,16 +102,16 @@ void membar::transfer(ir::basic_block *block,
   std::vector<ir::async_wait_inst*> async_waits;
   ir::basic_block::inst_list_t instructions = block->get_inst_list();
   for(ir::instruction *i: instructions){
-    if(dynamic_cast<ir::phi_node*>(i))
+    if(ir::isa<ir::phi_node>(i))
       continue;
     if(std::find(async_write.begin(), async_write.end(), i) == async_write.end() &&
-       dynamic_cast<ir::masked_load_async_inst*>(i)){
+       ir::dyn_cast<ir::masked_load_async_inst>(i)){
       async_write.push_back(i);
     }
-    if(dynamic_cast<ir::copy_to_shared_inst*>(i))
+    if(ir::isa<ir::copy_to_shared_inst>(i))
       sync_write.insert(i);
-    ir::barrier_inst* barrier = dynamic_cast<ir::barrier_inst*>(i);
-    ir::async_wait_inst* async_wait = dynamic_cast<ir::async_wait_inst*>(i);
+    ir::barrier_inst* barrier = ir::dyn_cast<ir::barrier_inst>(i);
+    ir::async_wait_inst* async_wait = ir::dyn_cast<ir::async_wait_inst>(i);
     // Get shared memory reads
     std::set<ir::value*> read;
     std::copy_if(i->op_begin(), i->op_end(), std::inserter(read, read.begin()),
@@ -169,11 +169,11 @@ void membar::transfer(ir::basic_block *block,
           // peak next 5 instructions
           auto peak_iter = std::next(iter);
           if (std::distance(peak_iter, instructions.end()) >= 5) {
-            auto first_bar = dynamic_cast<ir::barrier_inst*>(*peak_iter++);
-            auto first_pf = dynamic_cast<ir::prefetch_s_inst*>(*peak_iter++);
-            auto second_async_wait = dynamic_cast<ir::async_wait_inst*>(*peak_iter++);
-            auto second_bar = dynamic_cast<ir::barrier_inst*>(*peak_iter++);
-            auto second_pf = dynamic_cast<ir::prefetch_s_inst*>(*peak_iter);
+            auto first_bar = ir::dyn_cast<ir::barrier_inst>(*peak_iter++);
+            auto first_pf = ir::dyn_cast<ir::prefetch_s_inst>(*peak_iter++);
+            auto second_async_wait = ir::dyn_cast<ir::async_wait_inst>(*peak_iter++);
+            auto second_bar = ir::dyn_cast<ir::barrier_inst>(*peak_iter++);
+            auto second_pf = ir::dyn_cast<ir::prefetch_s_inst>(*peak_iter);
             if (first_bar && first_pf && second_async_wait && second_bar && second_pf) {
               int first_n = first_async_wait->get_N();
               int second_n = second_async_wait->get_N();
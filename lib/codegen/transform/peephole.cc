@@ -4,6 +4,7 @@
 #include "triton/ir/function.h"
 #include "triton/codegen/transform/peephole.h"
 #include "triton/codegen/analysis/layout.h"
+#include "triton/codegen/analysis/range.h"
 
 namespace triton {
 namespace codegen{
@@ -12,7 +13,7 @@ namespace transform{
 
 ir::value* rewrite_trans_phi_impl(ir::value *value, ir::builder &builder,
                                  const std::vector<int>& perm) {
-  if(auto phi = dynamic_cast<ir::phi_node*>(value)) {
+  if(auto phi = ir::dyn_cast<ir::phi_node>(value)) {
     // transpose operands
     std::vector<ir::value*> incs;
     for(unsigned n = 0; n < phi->get_num_incoming(); n++)
@@ -24,7 +25,7 @@ ir::value* rewrite_trans_phi_impl(ir::value *value, ir::builder &builder,
       result->add_incoming(incs[n], phi->get_incoming_block(n));
     return result;
   }
-  else if(auto i = dynamic_cast<ir::instruction*>(value)){
+  else if(auto i = ir::dyn_cast<ir::instruction>(value)){
     ir::basic_block* block = i->get_parent();
     auto it = std::find(block->begin(), block->end(), i);
     it++;
@@ -37,7 +38,7 @@ ir::value* rewrite_trans_phi_impl(ir::value *value, ir::builder &builder,
 }
 
 bool peephole::rewrite_trans_phi(ir::instruction* value, ir::builder& builder) {
-  auto trans = dynamic_cast<ir::trans_inst*>(value);
+  auto trans = ir::dyn_cast<ir::trans_inst>(value);
   if(!trans)
     return false;
   auto users = trans->get_users();
@@ -46,7 +47,7 @@ bool peephole::rewrite_trans_phi(ir::instruction* value, ir::builder& builder) {
     return false;
   ir::value* op = *ops.begin();
   // trans(phi) -> phi(trans(), trans()...)
-  auto* phi = dynamic_cast<ir::phi_node*>(op);
+  auto* phi = ir::dyn_cast<ir::phi_node>(op);
   if(!phi)
     return false;
   ir::value* new_phi = rewrite_trans_phi_impl(phi, builder, trans->get_perm());
@@ -60,27 +61,27 @@ bool peephole::rewrite_trans_phi(ir::instruction* value, ir::builder& builder) {
 bool peephole::rewrite_dot(ir::instruction *value, ir::builder& builder){
   // dot(a, b, c) + d -> dot(a, b, c + d)
   // d + dot(a, b, c) -> dot(a, b, c + d)
-  auto add = dynamic_cast<ir::binary_operator*>(value);
-  if(add && add->get_op() == ir::binary_op_t::FAdd) {
+  auto add = ir::dyn_cast<ir::binary_operator>(value);
+  if(add && (add->get_op() == ir::binary_op_t::FAdd || add->get_op() == ir::binary_op_t::Add)) {
     ir::value *lhs = add->get_operand(0);
     ir::value *rhs = add->get_operand(1);
-    ir::dot_inst *lhs_dot = dynamic_cast<ir::dot_inst*>(lhs);
-    ir::dot_inst *rhs_dot = dynamic_cast<ir::dot_inst*>(rhs);
+    ir::dot_inst *lhs_dot = ir::dyn_cast<ir::dot_inst>(lhs);
+    ir::dot_inst *rhs_dot = ir::dyn_cast<ir::dot_inst>(rhs);
     if(!lhs_dot && !rhs_dot)
       return false;
     ir::dot_inst *dot = lhs_dot ? lhs_dot : rhs_dot;
     ir::value *other = (dot == lhs) ? rhs : lhs;
     ir::value *acc = dot->get_operand(2);
-    ir::splat_inst *splat = dynamic_cast<ir::splat_inst*>(acc);
-    ir::constant_fp *_0 = nullptr;
-    if(splat)
-      _0 = dynamic_cast<ir::constant_fp*>(splat->get_operand(0));
-    if(!(_0 && _0->get_value() == 0.0))
+    ir::splat_inst *splat = ir::dyn_cast<ir::splat_inst>(acc);
+    ir::value *_0 = splat ? splat->get_operand(0) : nullptr;
+    auto *_0_fp = ir::dyn_cast_or_null<ir::constant_fp>(_0);
+    auto *_0_int = ir::dyn_cast_or_null<ir::constant_int>(_0);
+    if(!(_0_fp && _0_fp->get_value() == 0.0) && !(_0_int && _0_int->get_value() == 0))
       return false;
     ir::value *a = dot->get_operand(0);
     ir::value *b = dot->get_operand(1);
     builder.set_insert_point(add);
-    ir::value * new_dot = builder.insert(ir::dot_inst::create_nn(a, b, other, dot->get_name()));
+    ir::value * new_dot = builder.insert(ir::dot_inst::create_nn(a, b, other, dot->allow_tf32(), dot->get_name()));
     add->replace_all_uses_with(new_dot);
     return true;
   }
@@ -88,10 +89,10 @@ bool peephole::rewrite_dot(ir::instruction *value, ir::builder& builder){
 }
 
 //bool peephole::rewrite_cts_cfs(ir::instruction *value, ir::builder &builder){
-//  auto cfs = dynamic_cast<ir::copy_from_shared_inst*>(value);
+//  auto cfs = ir::dyn_cast<ir::copy_from_shared_inst>(value);
 //  if(cfs) {
 //    ir::value *arg = cfs->get_operand(0);
-//    ir::copy_to_shared_inst* cts = dynamic_cast<ir::copy_to_shared_inst*>(arg);
+//    ir::copy_to_shared_inst* cts = ir::dyn_cast<ir::copy_to_shared_inst>(arg);
 //    if(!cts)
 //      return false;
 //    cfs->replace_all_uses_with(cts->get_operand(0));
@@ -101,13 +102,18 @@ bool peephole::rewrite_dot(ir::instruction *value, ir::builder& builder){
 //}
 
 bool peephole::rewrite_load_to_shared(ir::instruction *value, ir::builder& builder){
-  auto copy_to_shared = dynamic_cast<ir::copy_to_shared_inst*>(value);
+  auto copy_to_shared = ir::dyn_cast<ir::copy_to_shared_inst>(value);
   if(!copy_to_shared)
     return false;
   ir::value *arg = copy_to_shared->get_operand(0);
-  ir::masked_load_inst* ld = dynamic_cast<ir::masked_load_inst*>(arg);
+  ir::masked_load_inst* ld = ir::dyn_cast<ir::masked_load_inst>(arg);
   if(!ld)
     return false;
+  // cp.async has no volatile form and only supports .ca/.cg
+  auto modifier = ld->get_cache_modifier();
+  if(ld->get_is_volatile() || ld->get_eviction_policy() == ir::io_inst::EVICT_FIRST ||
+     (modifier != ir::io_inst::NONE && modifier != ir::io_inst::CA && modifier != ir::io_inst::CG))
+    return false;
   builder.set_insert_point(copy_to_shared);
   ir::value *ptr = ld->get_pointer_operand();
   ir::value *msk = ld->get_mask_operand();
@@ -116,7 +122,8 @@ bool peephole::rewrite_load_to_shared(ir::instruction *value, ir::builder& build
   int nts = layout->nts(layout->get_order()[0]);
   int dtsize = value->get_type()->get_scalar_ty()->get_primitive_size_in_bits() / 8;
   if(nts*dtsize >= 4){
-    ir::value* new_load = builder.create_masked_load_async(ptr, msk, val);
+    ir::instruction* new_load = (ir::instruction*)builder.create_masked_load_async(ptr, msk, val);
+    new_load->copy_metadata_from(ld);
     copy_to_shared->replace_all_uses_with(new_load);
     return true;
   }
@@ -128,14 +135,21 @@ bool peephole::rewrite_load_to_shared(ir::instruction *value, ir::builder& build
 }
 
 bool peephole::rewrite_unit_red(ir::instruction *value, ir::builder& builder){
-  auto x = dynamic_cast<ir::reduce_inst*>(value);
+  auto x = ir::dyn_cast<ir::reduce_inst>(value);
   if(!x)
     return false;
   ir::value *arg = x->get_operand(0);
   auto shapes = arg->get_type()->get_block_shapes();
   if(shapes[x->get_axis()] == 1){
     builder.set_insert_point(x);
-    ir::value* new_red = builder.create_reshape(arg, x->get_type()->get_block_shapes());
+    ir::value* new_red;
+    if(x->is_arg_op()){
+      new_red = builder.get_int32(0);
+      if(x->get_type()->is_block_ty())
+        new_red = builder.create_splat(new_red, x->get_type()->get_block_shapes());
+    }
+    else
+      new_red = builder.create_reshape(arg, x->get_type()->get_block_shapes());
     x->replace_all_uses_with(new_red);
     return true;
   }
@@ -143,19 +157,19 @@ bool peephole::rewrite_unit_red(ir::instruction *value, ir::builder& builder){
 }
 
 bool peephole::rewrite_mult(ir::instruction *value, ir::builder& builder) {
-    auto binop = dynamic_cast<ir::binary_operator*>(value);
+    auto binop = ir::dyn_cast<ir::binary_operator>(value);
     if(binop && binop->get_op() == ir::binary_op_t::Mul) {
       ir::value *lhs = binop->get_operand(0);
       ir::value *rhs = binop->get_operand(1);
       ir::constant_int *_1_lhs = nullptr;
-      if(ir::splat_inst *splat = dynamic_cast<ir::splat_inst*>(lhs)){
-        auto *cst = dynamic_cast<ir::constant_int*>(splat->get_operand(0));
+      if(ir::splat_inst *splat = ir::dyn_cast<ir::splat_inst>(lhs)){
+        auto *cst = ir::dyn_cast<ir::constant_int>(splat->get_operand(0));
         if(cst && cst->get_value() == 1)
           _1_lhs = cst;
       }
       ir::constant_int *_1_rhs = nullptr;
-      if(ir::splat_inst *splat = dynamic_cast<ir::splat_inst*>(rhs)){
-        auto *cst = dynamic_cast<ir::constant_int*>(splat->get_operand(0));
+      if(ir::splat_inst *splat = ir::dyn_cast<ir::splat_inst>(rhs)){
+        auto *cst = ir::dyn_cast<ir::constant_int>(splat->get_operand(0));
         if(cst && cst->get_value() == 1)
           _1_rhs = cst;
       }
@@ -173,18 +187,18 @@ bool peephole::rewrite_mult(ir::instruction *value, ir::builder& builder) {
 
 
 bool peephole::rewrite_gep_ptr_min_off_plus_off(ir::instruction *value, ir::builder& builder) {
-  auto x = dynamic_cast<ir::getelementptr_inst*>(value);
+  auto x = ir::dyn_cast<ir::getelementptr_inst>(value);
   if(!x)
     return false;
-  auto y = dynamic_cast<ir::getelementptr_inst*>(x->get_pointer_operand());
+  auto y = ir::dyn_cast<ir::getelementptr_inst>(x->get_pointer_operand());
   if(!y)
     return false;
   auto idx = *y->idx_begin();
-  auto z = dynamic_cast<ir::binary_operator*>(idx);
+  auto z = ir::dyn_cast<ir::binary_operator>(idx);
   if(!z)
     return false;
   bool is_sub = z->get_op() == ir::binary_op_t::Sub;
-  auto *lhs = dynamic_cast<ir::constant_int*>(z->get_operand(0));
+  auto *lhs = ir::dyn_cast<ir::constant_int>(z->get_operand(0));
   bool is_lhs_0 = lhs && (lhs->get_value()==0);
   bool is_rhs_eq_x_rhs = z->get_operand(1) == *x->idx_begin();
   if(is_sub && is_lhs_0 && is_rhs_eq_x_rhs){
@@ -195,27 +209,28 @@ bool peephole::rewrite_gep_ptr_min_off_plus_off(ir::instruction *value, ir::buil
 }
 
 bool peephole::rewrite_select_masked_load(ir::instruction *value, ir::builder& builder){
-  auto select = dynamic_cast<ir::select_inst*>(value);
+  auto select = ir::dyn_cast<ir::select_inst>(value);
   if(!select)
     return false;
-  auto if_value = dynamic_cast<ir::masked_load_inst*>(select->get_if_value_op());
+  auto if_value = ir::dyn_cast<ir::masked_load_inst>(select->get_if_value_op());
   if(!if_value)
     return false;
   if(select->get_pred_op() != if_value->get_mask_operand())
     return false;
   builder.set_insert_point(select);
-  ir::value* new_load = builder.create_masked_load(if_value->get_pointer_operand(),
-                                                   if_value->get_mask_operand(),
-                                                   select->get_else_value_op());
+  ir::instruction* new_load = (ir::instruction*)builder.create_masked_load(if_value->get_pointer_operand(),
+                                                                           if_value->get_mask_operand(),
+                                                                           select->get_else_value_op());
+  new_load->copy_metadata_from(if_value);
   select->replace_all_uses_with(new_load);
   return true;
 }
 
 bool peephole::rewrite_cvt_layout(ir::instruction *value, ir::builder& builder){
-  auto cvt = dynamic_cast<ir::cvt_layout_inst*>(value);
+  auto cvt = ir::dyn_cast<ir::cvt_layout_inst>(value);
   if(!cvt)
     return false;
-  ir::instruction* op = dynamic_cast<ir::instruction*>(cvt->get_operand(0));
+  ir::instruction* op = ir::dyn_cast<ir::instruction>(cvt->get_operand(0));
   if(!op)
     return false;
   // convert(elementwise(x, y)) = elementwise(convert(x), convert(y))
@@ -234,7 +249,7 @@ bool peephole::rewrite_cvt_layout(ir::instruction *value, ir::builder& builder){
     cvt->replace_all_uses_with(op);
     return true;
   }
-  auto cvt_op = dynamic_cast<ir::cvt_layout_inst*>(op);
+  auto cvt_op = ir::dyn_cast<ir::cvt_layout_inst>(op);
   if(!cvt_op)
     return false;
   // convert1(convert2(x)) if convert1 is the inverse of convert2
@@ -247,6 +262,47 @@ bool peephole::rewrite_cvt_layout(ir::instruction *value, ir::builder& builder){
   return false;
 }
 
+bool peephole::rewrite_masked_load(ir::instruction *value, ir::builder& builder){
+  auto ld = ir::dyn_cast<ir::masked_load_inst>(value);
+  if(!ld)
+    return false;
+  ir::value *msk = ld->get_mask_operand();
+  // masked_load(ptr, false, other) -> other
+  if(range_->is_false(msk)){
+    ld->replace_all_uses_with(ld->get_false_value_operand());
+    num_masks_removed_++;
+    return true;
+  }
+  // masked_load(ptr, true, other) -> load(ptr)
+  if(range_->is_true(msk)){
+    builder.set_insert_point(ld);
+    ir::instruction* new_load = (ir::instruction*)builder.create_load(ld->get_pointer_operand());
+    new_load->copy_metadata_from(ld);
+    ld->replace_all_uses_with(new_load);
+    num_masks_removed_++;
+    return true;
+  }
+  return false;
+}
+
+bool peephole::rewrite_masked_store(ir::instruction *value, ir::builder& builder){
+  auto st = ir::dyn_cast<ir::masked_store_inst>(value);
+  if(!st)
+    return false;
+  ir::value *msk = st->get_mask_operand();
+  if(!range_->is_false(msk) && !range_->is_true(msk))
+    return false;
+  // masked_store(ptr, val, true) -> store(ptr, val)
+  if(range_->is_true(msk)){
+    builder.set_insert_point(st);
+    ir::instruction* new_store = (ir::instruction*)builder.create_store(st->get_pointer_operand(), st->get_value_operand());
+    new_store->copy_metadata_from(st);
+  }
+  // the masked store itself is erased by `run`
+  num_masks_removed_++;
+  return true;
+}
+
 void peephole::run(ir::module &mod) {
   ir::builder &builder = mod.get_builder();
   // keep track of whether any modification was made
@@ -285,12 +341,19 @@ void peephole::run(ir::module &mod) {
       was_modified = was_modified || rewrite_gep_ptr_min_off_plus_off(i, builder);
       was_modified = was_modified || rewrite_select_masked_load(i, builder);
       was_modified = was_modified || rewrite_cvt_layout(i, builder);
+      was_modified = was_modified || rewrite_masked_load(i, builder);
+      was_modified = was_modified || rewrite_masked_store(i, builder);
       if(tgt_->as_nvidia()->sm() >= 80)
         was_modified = was_modified || rewrite_load_to_shared(i, builder);
       if(was_modified)
         seen.insert(i);
     }
   }while(seen.size() != n_seen);
+
+  // stores are not removed by dce
+  for(ir::value* v: seen)
+  if(auto st = ir::dyn_cast<ir::masked_store_inst>(v))
+    st->erase_from_parent();
 }
 
 }
@@ -13,7 +13,7 @@ namespace transform{
 
 
 void recursive_deps(ir::value* v, ir::basic_block* block, std::vector<ir::instruction*>& ret){
- ir::instruction* i = dynamic_cast<ir::instruction*>(v);
+ ir::instruction* i = ir::dyn_cast<ir::instruction>(v);
  if(!i || i->get_parent() != block)
    return;
  if(i->get_id()==ir::INST_PHI)
@@ -23,25 +23,66 @@ void recursive_deps(ir::value* v, ir::basic_block* block, std::vector<ir::instru
    recursive_deps(u, block, ret);
 }
 
-void get_induction_vars(ir::value* cond, std::set<ir::phi_node*>& phis) {
-  auto instr = dynamic_cast<ir::instruction*>(cond);
-  for (auto op : instr->ops()) {
-    if (auto phi_op = dynamic_cast<ir::phi_node*>(op)) {
-      phis.insert(phi_op);
-      return;
-    }
-    if (dynamic_cast<ir::instruction*>(op))
-      get_induction_vars(op, phis);
+/// loop-carried phis of `block` that `v` depends on, including
+/// those their next values depend on
+void get_induction_vars(ir::value* v, ir::basic_block* block, std::set<ir::phi_node*>& phis) {
+  ir::instruction* i = ir::dyn_cast<ir::instruction>(v);
+  if(!i || i->get_parent() != block)
+    return;
+  if(ir::phi_node* phi = ir::dyn_cast<ir::phi_node>(i)){
+    if(phis.insert(phi).second)
+      get_induction_vars(phi->get_value_for_block(block), block, phis);
+    return;
+  }
+  for(ir::value* op: i->ops())
+    get_induction_vars(op, block, phis);
+}
+
+/// whether `v` can be recomputed from the loop-carried phis of `block`
+bool is_rematerializable(ir::value* v, ir::basic_block* block) {
+  ir::instruction* i = ir::dyn_cast<ir::instruction>(v);
+  if(!i || i->get_parent() != block || ir::isa<ir::phi_node>(i))
+    return true;
+  switch(i->get_id()){
+    case ir::INST_BINOP:
+    case ir::INST_ICMP:
+    case ir::INST_FCMP:
+    case ir::INST_GETELEMENTPTR:
+    case ir::INST_RESHAPE:
+    case ir::INST_SPLAT:
+    case ir::INST_BROADCAST:
+    case ir::INST_SELECT:
+    case ir::INST_MAKE_RANGE:
+      break;
+    default:
+      if(!ir::isa<ir::cast_inst>(i))
+        return false;
   }
+  for(ir::value* op: i->ops())
+    if(!is_rematerializable(op, block))
+      return false;
+  return true;
+}
+
+/// pre-header of `block` if it is a loop made of a single basic block
+ir::basic_block* get_loop_header(ir::basic_block* block) {
+  auto* block_br = ir::dyn_cast<ir::cond_branch_inst>(block->get_inst_list().back());
+  auto preds = block->get_predecessors();
+  if(!block_br || preds.size() != 2 || std::find(preds.begin(), preds.end(), block) == preds.end())
+    return nullptr;
+  ir::basic_block* header = preds[0] == block ? preds[1] : preds[0];
+  if(!ir::isa<ir::cond_branch_inst>(header->get_inst_list().back()))
+    return nullptr;
+  return header;
 }
 
 /// assume incoming block is 1
 ir::value* rematerialize_vals(ir::builder& builder, ir::basic_block* block, ir::value* v,
                               std::map<ir::phi_node*, ir::value*>& prev_phi_vals) {
-  ir::instruction* i = dynamic_cast<ir::instruction*>(v);
+  ir::instruction* i = ir::dyn_cast<ir::instruction>(v);
   if(!i || i->get_parent() != block)
     return v;
-  if(ir::phi_node* phi = dynamic_cast<ir::phi_node*>(v)) {
+  if(ir::phi_node* phi = ir::dyn_cast<ir::phi_node>(v)) {
     if (prev_phi_vals.find(phi) == prev_phi_vals.end())
       throw std::runtime_error("Don't have that phi node\n");
     return prev_phi_vals.at(phi);
@@ -60,10 +101,10 @@ ir::value* rematerialize_vals(ir::builder& builder, ir::basic_block* block, ir::
 
 ir::value* rematerialize(ir::builder& builder, ir::basic_block* block,
                          ir::value* v, size_t phi_idx){
-  ir::instruction* i = dynamic_cast<ir::instruction*>(v);
+  ir::instruction* i = ir::dyn_cast<ir::instruction>(v);
   if(!i || i->get_parent() != block)
     return v;
-  if(ir::phi_node* phi = dynamic_cast<ir::phi_node*>(v))
+  if(ir::phi_node* phi = ir::dyn_cast<ir::phi_node>(v))
     return phi->get_incoming_value(phi_idx);
 
   std::vector<ir::value*> new_ops;
@@ -90,7 +131,7 @@ std::map<ir::phi_node*, ir::value*> update_prev_phi_vals(
 void finalize_iv_vals(ir::builder& builder, ir::basic_block* block, std::map<ir::phi_node*, ir::value*>& load_ivs,
                                             std::map<ir::phi_node*, ir::value*>& next_load_ivs) {
   for (auto& [phi, val] : load_ivs) {
-    if (auto new_phi = dynamic_cast<ir::phi_node*>(val)) {
+    if (auto new_phi = ir::dyn_cast<ir::phi_node>(val)) {
       ir::value* next_k = rematerialize_vals(builder, block, phi->get_incoming_value(1), load_ivs);
       assert(new_phi->get_num_operands() == 1 && "should be incomplete phi");
       new_phi->add_incoming(next_k, phi->get_incoming_block(1));
@@ -102,33 +143,45 @@ void finalize_iv_vals(ir::builder& builder, ir::basic_block* block, std::map<ir:
 }
 
 void pipeline::run(ir::module &mod) {
-  // *Very* conservative heuristics for pre-fetching.
   // A load instruction can be pipelined if:
-  //   - the pointer is a phi node that references a value
-  //     in its basic block (i.e., pointer induction variable)
-  //   - the load has only  a single use in a dot instruction
-  // As more use cases become apparent, this pass will be improved
-  std::vector<std::pair<ir::load_inst*, ir::phi_node*>> to_pipeline;
+  //   - it is in a loop made of a single basic block
+  //   - its pointer, mask and default value can be recomputed from
+  //     the loop-carried phis of that block (e.g., induction variables)
+  // Loads whose only user is a dot are pre-fetched `num_stages - 1` iterations
+  // in advance, as they go to shared memory. The others, which may feed
+  // conversions, element-wise operations or reductions, are pre-fetched one
+  // iteration in advance in registers.
+  std::vector<std::pair<ir::load_inst*, int>> to_pipeline;
   ir::for_each_instruction(mod, [&](ir::instruction *i){
-    if(auto* load = dynamic_cast<ir::load_inst*>(i)){
-      ir::phi_node* ptr = dynamic_cast<ir::phi_node*>(load->get_pointer_operand());
-      auto users = load->get_users();
-      if(ptr && ptr->get_incoming_block(1) == ptr->get_parent()
-         && users.size() == 1 && dynamic_cast<ir::dot_inst*>(*users.begin()))
-        to_pipeline.push_back({load, ptr});
-    }});
+    auto* load = ir::dyn_cast<ir::load_inst>(i);
+    if(!load || load->get_users().empty() || load->get_is_volatile() || !get_loop_header(load->get_parent()))
+      return;
+    ir::basic_block* block = load->get_parent();
+    std::set<ir::phi_node*> deps;
+    for(ir::value* op: load->ops())
+      get_induction_vars(op, block, deps);
+    get_induction_vars(((ir::cond_branch_inst*)block->get_inst_list().back())->get_cond(), block, deps);
+    bool ok = std::all_of(load->op_begin(), load->op_end(), [&](ir::value* op) { return is_rematerializable(op, block); });
+    for(ir::phi_node* phi: deps)
+      ok = ok && is_rematerializable(phi->get_value_for_block(block), block);
+    if(!ok)
+      return;
+    auto users = load->get_users();
+    bool to_shared = users.size() == 1 && ir::isa<ir::dot_inst>(*users.begin());
+    to_pipeline.push_back({load, to_shared ? num_stages_ : 2});
+  });
   // do the pipelining
   std::vector<ir::phi_node*> new_loads;
   ir::builder &builder = mod.get_builder();
-  const int num_stages = num_stages_;
   std::vector<std::pair<ir::phi_node*, std::vector<ir::value*>>> preheader_loads; // Used to reorder loads
   for(auto info: to_pipeline){
     ir::load_inst* load = info.first;
-    ir::phi_node* ptr   = info.second;
+    const int num_stages = info.second;
+    ir::value* ptr = load->get_pointer_operand();
     ir::basic_block* block = load->get_parent();
-    ir::basic_block* header = block->get_predecessors()[0];
-    auto* block_br = dynamic_cast<ir::cond_branch_inst*>(block->get_inst_list().back());
-    auto* header_br = dynamic_cast<ir::cond_branch_inst*>(header->get_inst_list().back());
+    ir::basic_block* header = get_loop_header(block);
+    auto* block_br = ir::dyn_cast<ir::cond_branch_inst>(block->get_inst_list().back());
+    auto* header_br = ir::dyn_cast<ir::cond_branch_inst>(header->get_inst_list().back());
     assert(block_br);
     assert(header_br);
     ir::type* ty = load->get_type();
@@ -138,7 +191,9 @@ void pipeline::run(ir::module &mod) {
       ir::value* block_cond = block_br->get_cond();
       // 1. collect induction variables
       std::set<ir::phi_node*> induction_vars;
-      get_induction_vars(block_cond, induction_vars);
+      get_induction_vars(block_cond, block, induction_vars);
+      for(ir::value* op: load->ops())
+        get_induction_vars(op, block, induction_vars);
 
       std::vector<ir::value*> first_ptrs(num_stages-1);
       std::vector<ir::value*> first_loads(num_stages-1);
@@ -149,16 +204,16 @@ void pipeline::run(ir::module &mod) {
       // initialize prev_phi_vals
       // Add all phi nodes. The following DCE pass will delete dead ones.
       for (ir::instruction *instr : block->get_inst_list())
-        if (auto *phi = dynamic_cast<ir::phi_node*>(instr))
+        if (auto *phi = ir::dyn_cast<ir::phi_node>(instr))
           if (phi->get_incoming_block(1) == block)
             prev_phi_vals[phi] = phi->get_value_for_block(header);
 
       builder.set_insert_point(header->get_inst_list().back());
-      first_ptrs[0] = ptr->get_value_for_block(header);
+      first_ptrs[0] = rematerialize_vals(builder, block, ptr, prev_phi_vals);
       loop_conds[0] = header_cond;
       first_masks[0] = builder.create_splat(loop_conds[0], ty->get_block_shapes());
       ir::value* false_value = nullptr;
-      if (auto* masked_load = dynamic_cast<ir::masked_load_inst*>(load)) {
+      if (auto* masked_load = ir::dyn_cast<ir::masked_load_inst>(load)) {
         ir::value* remat_mask =rematerialize_vals(builder, block, masked_load->get_mask_operand(), prev_phi_vals) ;
         ir::value* remat_false_value = 
             rematerialize_vals(builder, block, masked_load->get_false_value_operand(), prev_phi_vals);
@@ -167,6 +222,7 @@ void pipeline::run(ir::module &mod) {
       } else
         false_value = builder.create_splat(ir::undef_value::get(ty->get_scalar_ty()), ty->get_block_shapes());
       first_loads[0] = builder.create_masked_load(first_ptrs[0], first_masks[0], false_value);
+      ((ir::instruction*)first_loads[0])->copy_metadata_from(load);
 
       for (int stage = 1; stage < num_stages-1; ++stage) {
         // mask is the loop condition of the previous iteration
@@ -174,7 +230,7 @@ void pipeline::run(ir::module &mod) {
         prev_phi_vals = update_prev_phi_vals(builder, block, prev_phi_vals);
         first_ptrs[stage] = rematerialize_vals(builder, block, ptr, prev_phi_vals);
         first_masks[stage] = builder.create_splat(loop_conds[stage], ty->get_block_shapes());
-        if (auto* masked_load = dynamic_cast<ir::masked_load_inst*>(load)) {
+        if (auto* masked_load = ir::dyn_cast<ir::masked_load_inst>(load)) {
           ir::value* remat_mask = rematerialize_vals(builder, block, masked_load->get_mask_operand(), prev_phi_vals);
           ir::value* remat_false_value = 
               rematerialize_vals(builder, block, masked_load->get_false_value_operand(), prev_phi_vals);
@@ -182,6 +238,7 @@ void pipeline::run(ir::module &mod) {
           false_value = remat_false_value;
         }
         first_loads[stage] = builder.create_masked_load(first_ptrs[stage], first_masks[stage], false_value);
+        ((ir::instruction*)first_loads[stage])->copy_metadata_from(load);
       }
 
       // create new phis for induction variables
@@ -198,10 +255,10 @@ void pipeline::run(ir::module &mod) {
         
       // pre-fetch next iteration
       builder.set_insert_point(block->get_inst_list().back());
-      ir::value* next_ptr = ptr->get_value_for_block(block);
+      ir::value* next_ptr = rematerialize_vals(builder, block, ptr, next_load_ivs);
       ir::value* next_mask = builder.create_splat(
           rematerialize_vals(builder, block, block_cond, load_ivs), ty->get_block_shapes());
-      if (auto* masked_load = dynamic_cast<ir::masked_load_inst*>(load)) {
+      if (auto* masked_load = ir::dyn_cast<ir::masked_load_inst>(load)) {
         ir::value* remat_mask = rematerialize_vals(builder, block, masked_load->get_mask_operand(), next_load_ivs);
         // TODO: false may depends on some other phi nodes
         ir::value* remat_false_value = 
@@ -210,10 +267,10 @@ void pipeline::run(ir::module &mod) {
         false_value = remat_false_value;
       }
       ir::value* next_load = builder.create_masked_load(next_ptr, next_mask, false_value);
+      ((ir::instruction*)next_load)->copy_metadata_from(load);
 
 
       // phi node
-      ptr->set_incoming_value(0, first_ptrs.back());
       builder.set_insert_point(block->get_first_non_phi());
       // nested phis for load
       std::vector<ir::phi_node*> new_load_phis(num_stages-1);
@@ -233,10 +290,10 @@ void pipeline::run(ir::module &mod) {
     } else {
       // pre-fetch first iteration
       builder.set_insert_point(header->get_inst_list().back());
-      ir::value* first_ptr = ptr->get_value_for_block(header);
+      ir::value* first_ptr = rematerialize(builder, block, ptr, 0);
       ir::value* first_mask = builder.create_splat(header_br->get_cond(), ty->get_block_shapes());
       ir::value* false_value;
-      if(auto* masked_load = dynamic_cast<ir::masked_load_inst*>(load)){
+      if(auto* masked_load = ir::dyn_cast<ir::masked_load_inst>(load)){
         ir::value* remat_mask = rematerialize(builder, block, masked_load->get_mask_operand(), 0);
         ir::value* remat_false_value = rematerialize(builder, block, masked_load->get_false_value_operand(), 0);
         first_mask = builder.create_and(first_mask, remat_mask);
@@ -245,17 +302,19 @@ void pipeline::run(ir::module &mod) {
       else
         false_value = builder.create_splat(ir::undef_value::get(ty->get_scalar_ty()), ty->get_block_shapes());
       ir::value* first_load = builder.create_masked_load(first_ptr, first_mask, false_value);
+      ((ir::instruction*)first_load)->copy_metadata_from(load);
       // pre-fetch next iteration
       builder.set_insert_point(block->get_inst_list().back());
-      ir::value* next_ptr = ptr->get_value_for_block(block);
+      ir::value* next_ptr = rematerialize(builder, block, ptr, 1);
       ir::value* next_mask = builder.create_splat(block_br->get_cond(), ty->get_block_shapes());
-      if(auto* masked_load = dynamic_cast<ir::masked_load_inst*>(load)){
+      if(auto* masked_load = ir::dyn_cast<ir::masked_load_inst>(load)){
         ir::value* remat_mask = rematerialize(builder, block, masked_load->get_mask_operand(), 1);
         ir::value* remat_false_value = rematerialize(builder, block, masked_load->get_false_value_operand(), 1);
         next_mask = builder.create_and(next_mask, remat_mask);
         false_value = remat_false_value;
       }
       ir::value* next_load = builder.create_masked_load(next_ptr, next_mask, false_value);
+      ((ir::instruction*)next_load)->copy_metadata_from(load);
       // phi node
       builder.set_insert_point(block->get_first_non_phi());
       ir::phi_node* new_load = builder.create_phi(ty, 2);
@@ -271,7 +330,7 @@ void pipeline::run(ir::module &mod) {
   if (!preheader_loads.empty()) {
     ir::basic_block* header = preheader_loads.begin()->first->get_incoming_block(0);
     builder.set_insert_point(header->get_inst_list().back());
-    for (int i=1; i<num_stages-1; ++i) {
+    for (int i=1; i<num_stages_-1; ++i) {
       for (auto iter = preheader_loads.begin(); iter != preheader_loads.end(); ++iter) {
         ir::instruction* original_load = static_cast<ir::instruction*>(iter->second.at(i));
         ir::instruction* moved_load = original_load->clone();
@@ -293,9 +352,9 @@ void pipeline::run(ir::module &mod) {
     for(ir::function* fn: mod.get_function_list())
     for(ir::basic_block* bb: fn->blocks())
     for(ir::instruction* inst: bb->get_inst_list()){
-      if(auto* i = dynamic_cast<ir::dot_inst*>(inst))
+      if(auto* i = ir::dyn_cast<ir::dot_inst>(inst))
         recursive_deps(i, bb, to_move[bb].insts);
-      if(auto* i = dynamic_cast<ir::load_inst*>(inst))
+      if(auto* i = ir::dyn_cast<ir::load_inst>(inst))
         to_move[bb].dst = i;
     }
 
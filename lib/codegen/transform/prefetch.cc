@@ -14,7 +14,7 @@ namespace triton::codegen::transform {
 
 /// find defs till phis
 static void recursive_defs(ir::value *v, ir::basic_block *bb, std::vector<ir::instruction*> &ret) {
-  ir::instruction *i = dynamic_cast<ir::instruction*>(v);
+  ir::instruction *i = ir::dyn_cast<ir::instruction>(v);
   if (!i || i->get_parent() != bb)
     return;
   if (i->get_id() == ir::INST_PHI)
@@ -28,12 +28,12 @@ void prefetch::run(ir::module &mod) {
   // 1. collect dots that can be prefethced
   std::vector<ir::dot_inst*> to_prefetch;
   ir::for_each_instruction(mod, [&](ir::instruction *i) {
-    if (auto *dot = dynamic_cast<ir::dot_inst*>(i)) {
+    if (auto *dot = ir::dyn_cast<ir::dot_inst>(i)) {
       // Now only do prefetching when dot is fp16
       if (dot->get_operand(0)->get_type()->get_scalar_ty()->get_type_id() != ir::type::FP16TyID)
         return;
-      auto *a = dynamic_cast<ir::phi_node*>(dot->get_operand(0));
-      auto *b = dynamic_cast<ir::phi_node*>(dot->get_operand(1));
+      auto *a = ir::dyn_cast<ir::phi_node>(dot->get_operand(0));
+      auto *b = ir::dyn_cast<ir::phi_node>(dot->get_operand(1));
       if (a && a->get_incoming_block(1) == a->get_parent() &&
           b && b->get_incoming_block(1) == b->get_parent()) 
         to_prefetch.push_back(dot);
@@ -44,8 +44,8 @@ void prefetch::run(ir::module &mod) {
   ir::builder &builder = mod.get_builder();
   // 2. do the prefetching
   for (ir::dot_inst* dot : to_prefetch) {
-    auto *a = dynamic_cast<ir::phi_node*>(dot->get_operand(0));
-    auto *b = dynamic_cast<ir::phi_node*>(dot->get_operand(1));
+    auto *a = ir::dyn_cast<ir::phi_node>(dot->get_operand(0));
+    auto *b = ir::dyn_cast<ir::phi_node>(dot->get_operand(1));
     assert(a->get_incoming_block(0) == b->get_incoming_block(0));
     ir::basic_block *loop_header = a->get_incoming_block(0);
     ir::basic_block *loop_body = a->get_parent();
@@ -68,14 +68,14 @@ void prefetch::run(ir::module &mod) {
     prefetched_vals_.insert(b->get_incoming_value(0));
     // nested phis
     ir::value* next_a = a->get_incoming_value(1);
-    while (auto* next_a_phi = dynamic_cast<ir::phi_node*>(next_a)) {
+    while (auto* next_a_phi = ir::dyn_cast<ir::phi_node>(next_a)) {
       prefetched_vals_.insert(next_a_phi->get_incoming_value(0));
       next_a = next_a_phi->get_incoming_value(1);
     }
     prefetched_vals_.insert(next_a);
 
     ir::value* next_b = b->get_incoming_value(1);
-    while (auto* next_b_phi = dynamic_cast<ir::phi_node*>(next_b)) {
+    while (auto* next_b_phi = ir::dyn_cast<ir::phi_node>(next_b)) {
       prefetched_vals_.insert(next_b_phi->get_incoming_value(0));
       next_b = next_b_phi->get_incoming_value(1);
     }
@@ -95,7 +95,7 @@ void prefetch::run(ir::module &mod) {
       std::map<ir::instruction*, size_t> idx_map;
       size_t idx = 0;
       for (ir::instruction *inst : bb->get_inst_list()) {
-        if (auto *i = dynamic_cast<ir::masked_load_inst*>(inst))
+        if (auto *i = ir::dyn_cast<ir::masked_load_inst>(inst))
           recursive_defs(i, bb, loads);
         idx_map[inst] = idx;
         idx++;
@@ -0,0 +1,160 @@
+#include "triton/codegen/transform/reassociate.h"
+#include "triton/ir/module.h"
+#include "triton/ir/function.h"
+#include "triton/ir/basic_block.h"
+#include "triton/ir/instructions.h"
+#include "triton/ir/constant.h"
+#include "triton/ir/utils.h"
+
+namespace triton {
+namespace codegen{
+namespace transform{
+
+/// tells which parts `split` would produce for `x`, without creating
+/// any instruction
+void reassociate::classify(ir::value *x, bool &has_uniform, bool &has_varying) {
+  has_uniform = false;
+  has_varying = true;
+  auto *i = ir::dyn_cast<ir::instruction>(x);
+  if(!i || !i->get_type()->is_block_ty())
+    return;
+  // user-provided hints must be preserved
+  if(i->get_metadata(ir::metadata::multiple_of) || i->get_metadata(ir::metadata::max_contiguous))
+    return;
+  if(ir::isa<ir::splat_inst>(i)){
+    has_uniform = true;
+    has_varying = false;
+    return;
+  }
+  if(ir::isa<ir::reshape_inst>(i) || ir::isa<ir::broadcast_inst>(i)){
+    bool u, v;
+    classify(i->get_operand(0), u, v);
+    has_uniform = u;
+    has_varying = v;
+    return;
+  }
+  auto *binop = ir::dyn_cast<ir::binary_operator>(i);
+  if(!binop)
+    return;
+  bool lu, lv, ru, rv;
+  classify(binop->get_operand(0), lu, lv);
+  classify(binop->get_operand(1), ru, rv);
+  bool ok;
+  switch(binop->get_op()){
+    case ir::binary_op_t::Add: ok = lu || ru; break;
+    case ir::binary_op_t::Sub: ok = (lu || ru) && (lv || !rv); break;
+    case ir::binary_op_t::Mul: ok = lu && ru && !(lv && rv); break;
+    default: ok = false; break;
+  }
+  if(!ok)
+    return;
+  has_uniform = true;
+  has_varying = lv || rv;
+}
+
+/// splits `x` into the sum of a scalar `uniform` part and a block `varying`
+/// part; either may be nullptr. New instructions are created only if `x`
+/// has a uniform part: `classify` is checked first so that no case bails
+/// out after its operands were split.
+void reassociate::split(ir::value *x, ir::builder &builder, ir::value *&uniform, ir::value *&varying) {
+  uniform = nullptr;
+  varying = x;
+  bool has_uniform, has_varying;
+  classify(x, has_uniform, has_varying);
+  if(!has_uniform)
+    return;
+  auto *i = ir::cast<ir::instruction>(x);
+  // splat(u) = u
+  if(auto *splat = ir::dyn_cast<ir::splat_inst>(i)){
+    uniform = splat->get_operand(0);
+    varying = nullptr;
+    return;
+  }
+  // retile(u + v) = u + retile(v)
+  if(ir::isa<ir::reshape_inst>(i) || ir::isa<ir::broadcast_inst>(i)){
+    ir::value *u, *v;
+    split(i->get_operand(0), builder, u, v);
+    uniform = u;
+    if(!v)
+      varying = nullptr;
+    else if(ir::isa<ir::reshape_inst>(i))
+      varying = builder.create_reshape(v, i->get_type()->get_block_shapes());
+    else
+      varying = builder.create_broadcast(v, i->get_type()->get_block_shapes());
+    return;
+  }
+  auto *binop = ir::cast<ir::binary_operator>(i);
+  ir::value *lu, *lv, *ru, *rv;
+  switch(binop->get_op()){
+    // (lu + lv) + (ru + rv) = (lu + ru) + (lv + rv)
+    case ir::binary_op_t::Add:
+      split(binop->get_operand(0), builder, lu, lv);
+      split(binop->get_operand(1), builder, ru, rv);
+      uniform = lu && ru ? builder.create_add(lu, ru) : (lu ? lu : ru);
+      varying = lv && rv ? builder.create_add(lv, rv) : (lv ? lv : rv);
+      return;
+    // (lu + lv) - (ru + rv) = (lu - ru) + (lv - rv)
+    case ir::binary_op_t::Sub:
+      split(binop->get_operand(0), builder, lu, lv);
+      split(binop->get_operand(1), builder, ru, rv);
+      if(ru)
+        uniform = builder.create_sub(lu ? lu : ir::constant::get_null_value(ru->get_type()), ru);
+      else
+        uniform = lu;
+      varying = rv ? builder.create_sub(lv, rv) : lv;
+      return;
+    // (u + v) * s = u*s + v*s
+    case ir::binary_op_t::Mul:
+      split(binop->get_operand(0), builder, lu, lv);
+      split(binop->get_operand(1), builder, ru, rv);
+      uniform = builder.create_mul(lu, ru);
+      if(lv)
+        varying = builder.create_mul(lv, builder.create_splat(ru, i->get_type()->get_block_shapes()));
+      else if(rv)
+        varying = builder.create_mul(builder.create_splat(lu, i->get_type()->get_block_shapes()), rv);
+      else
+        varying = nullptr;
+      return;
+    default:
+      return;
+  }
+}
+
+bool reassociate::rewrite(ir::getelementptr_inst *x, ir::builder &builder) {
+  if(!x->get_type()->is_block_ty() || x->get_num_operands() != 2)
+    return false;
+  auto *ptr = ir::dyn_cast<ir::splat_inst>(x->get_pointer_operand());
+  if(!ptr)
+    return false;
+  ir::value *idx = *x->idx_begin();
+  // the index is already a splat or has no uniform part
+  if(ir::isa<ir::splat_inst>(idx))
+    return false;
+  builder.set_insert_point(x);
+  ir::value *u, *v;
+  split(idx, builder, u, v);
+  if(!u)
+    return false;
+  ir::value *base = builder.create_gep(ptr->get_operand(0), {u});
+  ir::value *res = builder.create_splat(base, x->get_type()->get_block_shapes());
+  if(v)
+    res = builder.create_gep(res, {v});
+  x->replace_all_uses_with(res);
+  return true;
+}
+
+void reassociate::run(ir::module &mod) {
+  num_rewritten_ = 0;
+  ir::builder &builder = mod.get_builder();
+  std::vector<ir::getelementptr_inst*> geps;
+  ir::for_each_instruction(mod, [&](ir::instruction *i){
+    if(auto *x = ir::dyn_cast<ir::getelementptr_inst>(i))
+      geps.push_back(x);
+  });
+  for(ir::getelementptr_inst *x: geps)
+    num_rewritten_ += rewrite(x, builder);
+}
+
+}
+}
+}
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <vector>
+#include "triton/codegen/transform/rematerialize.h"
+#include "triton/codegen/analysis/pressure.h"
+#include "triton/ir/module.h"
+#include "triton/ir/function.h"
+#include "triton/ir/basic_block.h"
+#include "triton/ir/instructions.h"
+
+namespace triton {
+namespace codegen{
+namespace transform{
+
+// largest number of instructions recomputed for a single value
+static const unsigned max_cost = 8;
+
+/// whether `v` is a block that can be recomputed from scalars in
+/// at most `max_cost` instructions
+bool rematerialize::is_cheap(ir::value *v, unsigned &cost) {
+  if(!v->get_type()->is_block_ty())
+    return true;
+  ir::instruction *i = ir::dyn_cast<ir::instruction>(v);
+  if(!i || ++cost > max_cost)
+    return false;
+  switch(i->get_id()){
+    case ir::INST_MAKE_RANGE:
+    case ir::INST_SPLAT:
+    case ir::INST_RESHAPE:
+    case ir::INST_BROADCAST:
+    case ir::INST_GETELEMENTPTR:
+      break;
+    case ir::INST_BINOP:
+      if(((ir::binary_operator*)i)->is_int_div() || ((ir::binary_operator*)i)->is_int_rem())
+        return false;
+      break;
+    default:
+      return false;
+  }
+  for(ir::value *op: i->ops())
+    if(!is_cheap(op, cost))
+      return false;
+  return true;
+}
+
+ir::value* rematerialize::clone(ir::value *v, ir::builder &builder, std::map<ir::value*, ir::value*> &clones) {
+  if(!v->get_type()->is_block_ty())
+    return v;
+  auto it = clones.find(v);
+  if(it != clones.end())
+    return it->second;
+  ir::instruction *i = (ir::instruction*)v;
+  std::vector<ir::value*> new_ops;
+  for(ir::value *op: i->ops())
+    new_ops.push_back(clone(op, builder, clones));
+  ir::instruction *ret = i->clone();
+  for(size_t k = 0; k < new_ops.size(); k++)
+    ret->set_operand(k, new_ops[k]);
+  builder.insert(ret);
+  clones[v] = ret;
+  return ret;
+}
+
+unsigned rematerialize::max_registers() const {
+  // 64K registers per block, at most 255 per thread
+  return std::min(255, 65536 / (num_warps_ * 32));
+}
+
+void rematerialize::run(ir::module &mod) {
+  num_rematerialized_ = 0;
+  if(pressure_->max_live() <= max_registers())
+    return;
+  ir::builder &builder = mod.get_builder();
+  for(ir::value *v: pressure_->get_peak()){
+    ir::instruction *i = ir::dyn_cast<ir::instruction>(v);
+    unsigned cost = 0;
+    if(!i || !i->get_type()->is_block_ty() || !is_cheap(i, cost))
+      continue;
+    // values flowing through phi nodes stay live until the end of their block
+    std::vector<ir::user*> users(i->get_users().begin(), i->get_users().end());
+    if(std::any_of(users.begin(), users.end(), [](ir::user *u) { return ir::isa<ir::phi_node>(u); }))
+      continue;
+    // recompute once per block, before the first user
+    std::map<ir::basic_block*, ir::instruction*> first;
+    for(ir::basic_block *block: i->get_parent()->get_parent()->blocks())
+    for(ir::instruction *inst: block->get_inst_list())
+      if(std::find(users.begin(), users.end(), inst) != users.end() && !first.count(block))
+        first[block] = inst;
+    for(auto &x: first){
+      builder.set_insert_point(x.second);
+      std::map<ir::value*, ir::value*> clones;
+      ir::value *new_i = clone(i, builder, clones);
+      for(ir::user *u: users)
+        if(((ir::instruction*)u)->get_parent() == x.first)
+          u->replace_uses_of_with(i, new_i);
+    }
+    num_rematerialized_++;
+  }
+}
+
+} // namespace transform
+} // namespace codegen
+} // namespace triton
@@ -17,7 +17,7 @@ void reorder::run(ir::module& mod){
 //    for(ir::function *fn: mod.get_function_list())
 //    for(ir::basic_block *block: fn->blocks())
 //    for(ir::instruction* i: block->get_inst_list()){
-//      if(auto* ld = dynamic_cast<ir::masked_load_inst*>(i)){
+//      if(auto* ld = ir::dyn_cast<ir::masked_load_inst>(i)){
 //        ir::value* _ptr = ld->get_pointer_operand();
 //        ir::value* _msk = ld->get_mask_operand();
 //        ir::value* _val = ld->get_false_value_operand();
@@ -0,0 +1,428 @@
+#include <cmath>
+#include "triton/codegen/transform/simplify.h"
+#include "triton/ir/module.h"
+#include "triton/ir/function.h"
+#include "triton/ir/basic_block.h"
+#include "triton/ir/instructions.h"
+#include "triton/ir/constant.h"
+#include "triton/ir/utils.h"
+
+namespace triton {
+namespace codegen{
+namespace transform{
+
+// rules are tried in order until one applies
+const std::vector<simplify::rule_t> simplify::rules_ = {
+  &simplify::fold_binop,
+  &simplify::splat_binop,
+  &simplify::simplify_binop,
+  &simplify::fold_cast,
+  &simplify::splat_cast,
+  &simplify::simplify_cast,
+  &simplify::simplify_retile,
+  &simplify::simplify_select
+};
+
+/*
+ * helpers
+ */
+
+static int64_t sext(uint64_t x, unsigned bits) {
+  if(bits >= 64)
+    return x;
+  uint64_t mask = (uint64_t(1) << bits) - 1;
+  uint64_t sign = uint64_t(1) << (bits - 1);
+  return ((x & mask) ^ sign) - sign;
+}
+
+static uint64_t zext(uint64_t x, unsigned bits) {
+  if(bits >= 64)
+    return x;
+  return x & ((uint64_t(1) << bits) - 1);
+}
+
+static ir::constant_int* get_int(ir::type *ty, uint64_t x) {
+  unsigned bits = ty->get_integer_bitwidth();
+  // booleans are stored as 0/1
+  return ir::constant_int::get(ty, bits == 1 ? x & 1 : sext(x, bits));
+}
+
+/// only types whose arithmetic can be reproduced exactly on the host
+static bool is_foldable_fp(ir::type *ty) {
+  return ty->is_fp32_ty() || ty->is_fp64_ty();
+}
+
+static ir::constant* get_fp(ir::type *ty, double x) {
+  return ir::constant_fp::get(ty, ty->is_fp32_ty() ? (double)(float)x : x);
+}
+
+/// the scalar constant all elements of `v` are equal to, if any
+static ir::constant* get_splat_constant(ir::value *v) {
+  if(auto *splat = ir::dyn_cast<ir::splat_inst>(v))
+    v = splat->get_operand(0);
+  if(ir::isa<ir::constant_int>(v) || ir::isa<ir::constant_fp>(v))
+    return (ir::constant*)v;
+  return nullptr;
+}
+
+static bool is_int(ir::value *v, int64_t x) {
+  auto *cst = ir::dyn_cast_or_null<ir::constant_int>(get_splat_constant(v));
+  return cst && sext(cst->get_value(), cst->get_type()->get_integer_bitwidth()) == x;
+}
+
+static bool is_fp(ir::value *v, double x) {
+  auto *cst = ir::dyn_cast_or_null<ir::constant_fp>(get_splat_constant(v));
+  return cst && cst->get_value() == x && std::signbit(cst->get_value()) == std::signbit(x);
+}
+
+/// `cst` with the same shape as `i`
+static ir::value* splat_like(ir::instruction *i, ir::constant *cst, ir::builder &builder) {
+  if(!i->get_type()->is_block_ty())
+    return cst;
+  builder.set_insert_point(i);
+  return builder.create_splat(cst, i->get_type()->get_block_shapes());
+}
+
+static bool fold_int(ir::binary_op_t op, uint64_t lhs, uint64_t rhs, unsigned bits, uint64_t &res) {
+  int64_t slhs = sext(lhs, bits);
+  int64_t srhs = sext(rhs, bits);
+  uint64_t ulhs = zext(lhs, bits);
+  uint64_t urhs = zext(rhs, bits);
+  switch(op){
+    case ir::binary_op_t::Add: res = ulhs + urhs; return true;
+    case ir::binary_op_t::Sub: res = ulhs - urhs; return true;
+    case ir::binary_op_t::Mul: res = ulhs * urhs; return true;
+    case ir::binary_op_t::And: res = ulhs & urhs; return true;
+    case ir::binary_op_t::Or:  res = ulhs | urhs; return true;
+    case ir::binary_op_t::Xor: res = ulhs ^ urhs; return true;
+    // division by zero and overflow are undefined
+    case ir::binary_op_t::SDiv:
+      if(srhs == 0 || (srhs == -1 && slhs == sext(uint64_t(1) << (bits - 1), bits)))
+        return false;
+      res = slhs / srhs; return true;
+    case ir::binary_op_t::SRem:
+      if(srhs == 0 || srhs == -1)
+        return false;
+      res = slhs % srhs; return true;
+    case ir::binary_op_t::UDiv: if(urhs == 0) return false; res = ulhs / urhs; return true;
+    case ir::binary_op_t::URem: if(urhs == 0) return false; res = ulhs % urhs; return true;
+    case ir::binary_op_t::Shl:  if(urhs >= bits) return false; res = ulhs << urhs; return true;
+    case ir::binary_op_t::LShr: if(urhs >= bits) return false; res = ulhs >> urhs; return true;
+    case ir::binary_op_t::AShr: if(urhs >= bits) return false; res = slhs >> urhs; return true;
+    default: return false;
+  }
+}
+
+static bool fold_fp(ir::binary_op_t op, double lhs, double rhs, double &res) {
+  switch(op){
+    case ir::binary_op_t::FAdd: res = lhs + rhs; return true;
+    case ir::binary_op_t::FSub: res = lhs - rhs; return true;
+    case ir::binary_op_t::FMul: res = lhs * rhs; return true;
+    case ir::binary_op_t::FDiv: res = lhs / rhs; return true;
+    case ir::binary_op_t::FRem: res = std::fmod(lhs, rhs); return true;
+    default: return false;
+  }
+}
+
+/*
+ * binary_operator
+ */
+
+/// c op d -> constant
+ir::value* simplify::fold_binop(ir::instruction *i, ir::builder &builder) {
+  auto *x = ir::dyn_cast<ir::binary_operator>(i);
+  if(!x)
+    return nullptr;
+  ir::type *ty = x->get_type();
+  if(auto *lhs = ir::dyn_cast<ir::constant_int>(x->get_operand(0)))
+  if(auto *rhs = ir::dyn_cast<ir::constant_int>(x->get_operand(1))){
+    uint64_t res;
+    if(!fold_int(x->get_op(), lhs->get_value(), rhs->get_value(), ty->get_integer_bitwidth(), res))
+      return nullptr;
+    return get_int(ty, res);
+  }
+  if(auto *lhs = ir::dyn_cast<ir::constant_fp>(x->get_operand(0)))
+  if(auto *rhs = ir::dyn_cast<ir::constant_fp>(x->get_operand(1))){
+    double res;
+    if(!is_foldable_fp(ty) || !fold_fp(x->get_op(), lhs->get_value(), rhs->get_value(), res))
+      return nullptr;
+    return get_fp(ty, res);
+  }
+  return nullptr;
+}
+
+/// splat(a) op splat(b) -> splat(a op b)
+ir::value* simplify::splat_binop(ir::instruction *i, ir::builder &builder) {
+  auto *x = ir::dyn_cast<ir::binary_operator>(i);
+  if(!x)
+    return nullptr;
+  auto *lhs = ir::dyn_cast<ir::splat_inst>(x->get_operand(0));
+  auto *rhs = ir::dyn_cast<ir::splat_inst>(x->get_operand(1));
+  if(!lhs || !rhs)
+    return nullptr;
+  builder.set_insert_point(x);
+  auto *op = ir::binary_operator::create(x->get_op(), lhs->get_operand(0), rhs->get_operand(0));
+  op->set_has_no_unsigned_wrap(x->has_no_unsigned_wrap_);
+  op->set_has_no_signed_wrap(x->has_no_signed_wrap_);
+  builder.insert(op);
+  return builder.create_splat(op, x->get_type()->get_block_shapes());
+}
+
+/// algebraic identities
+ir::value* simplify::simplify_binop(ir::instruction *i, ir::builder &builder) {
+  auto *x = ir::dyn_cast<ir::binary_operator>(i);
+  if(!x)
+    return nullptr;
+  ir::value *lhs = x->get_operand(0);
+  ir::value *rhs = x->get_operand(1);
+  ir::type *scalar_ty = x->get_type()->get_scalar_ty();
+  auto zero = [&]() { return splat_like(x, ir::constant::get_null_value(scalar_ty), builder); };
+  switch(x->get_op()){
+    // x + 0 = 0 + x = x
+    case ir::binary_op_t::Add:
+      if(is_int(rhs, 0)) return lhs;
+      if(is_int(lhs, 0)) return rhs;
+      break;
+    // x - 0 = x ; x - x = 0
+    case ir::binary_op_t::Sub:
+      if(is_int(rhs, 0)) return lhs;
+      if(lhs == rhs) return zero();
+      break;
+    // x * 1 = 1 * x = x ; x * 0 = 0 * x = 0
+    case ir::binary_op_t::Mul:
+      if(is_int(rhs, 1)) return lhs;
+      if(is_int(lhs, 1)) return rhs;
+      if(is_int(lhs, 0) || is_int(rhs, 0)) return zero();
+      break;
+    // x / 1 = x ; x % 1 = 0
+    case ir::binary_op_t::SDiv:
+    case ir::binary_op_t::UDiv:
+      if(is_int(rhs, 1)) return lhs;
+      break;
+    case ir::binary_op_t::SRem:
+    case ir::binary_op_t::URem:
+      if(is_int(rhs, 1)) return zero();
+      break;
+    // x << 0 = x >> 0 = x
+    case ir::binary_op_t::Shl:
+    case ir::binary_op_t::LShr:
+    case ir::binary_op_t::AShr:
+      if(is_int(rhs, 0)) return lhs;
+      break;
+    // x & -1 = x ; x & 0 = 0 ; x & x = x
+    case ir::binary_op_t::And:
+      if(is_int(rhs, -1) || lhs == rhs) return lhs;
+      if(is_int(lhs, -1)) return rhs;
+      if(is_int(lhs, 0) || is_int(rhs, 0)) return zero();
+      break;
+    // x | 0 = x ; x | x = x
+    case ir::binary_op_t::Or:
+      if(is_int(rhs, 0) || lhs == rhs) return lhs;
+      if(is_int(lhs, 0)) return rhs;
+      break;
+    // x ^ 0 = x ; x ^ x = 0
+    case ir::binary_op_t::Xor:
+      if(is_int(rhs, 0)) return lhs;
+      if(is_int(lhs, 0)) return rhs;
+      if(lhs == rhs) return zero();
+      break;
+    // x + -0. = x (x + 0. is not x when x = -0.)
+    case ir::binary_op_t::FAdd:
+      if(is_fp(rhs, -0.)) return lhs;
+      if(is_fp(lhs, -0.)) return rhs;
+      break;
+    // x - 0. = x
+    case ir::binary_op_t::FSub:
+      if(is_fp(rhs, 0.)) return lhs;
+      break;
+    // x * 1. = 1. * x = x
+    case ir::binary_op_t::FMul:
+      if(is_fp(rhs, 1.)) return lhs;
+      if(is_fp(lhs, 1.)) return rhs;
+      break;
+    // x / 1. = x
+    case ir::binary_op_t::FDiv:
+      if(is_fp(rhs, 1.)) return lhs;
+      break;
+    default:
+      break;
+  }
+  return nullptr;
+}
+
+/*
+ * cast_inst
+ */
+
+/// cast(c) -> constant
+ir::value* simplify::fold_cast(ir::instruction *i, ir::builder &builder) {
+  auto *x = ir::dyn_cast<ir::cast_inst>(i);
+  if(!x)
+    return nullptr;
+  ir::value *arg = x->get_operand(0);
+  ir::type *ty = x->get_type();
+  if(auto *cst = ir::dyn_cast<ir::constant_int>(arg)){
+    unsigned bits = arg->get_type()->get_integer_bitwidth();
+    // booleans are stored as 0/1
+    uint64_t value = bits == 1 ? (cst->get_value() & 1 ? ~uint64_t(0) : 0) : cst->get_value();
+    switch(x->get_op()){
+      case ir::cast_op_t::Trunc:
+      case ir::cast_op_t::SExt:  return get_int(ty, sext(value, bits));
+      case ir::cast_op_t::ZExt:  return get_int(ty, zext(value, bits));
+      case ir::cast_op_t::SIToFP: if(is_foldable_fp(ty)) return get_fp(ty, (double)sext(value, bits)); break;
+      case ir::cast_op_t::UIToFP: if(is_foldable_fp(ty)) return get_fp(ty, (double)zext(value, bits)); break;
+      default: break;
+    }
+    return nullptr;
+  }
+  if(auto *cst = ir::dyn_cast<ir::constant_fp>(arg)){
+    if(!is_foldable_fp(arg->get_type()))
+      return nullptr;
+    double value = cst->get_value();
+    switch(x->get_op()){
+      case ir::cast_op_t::FPExt:
+      case ir::cast_op_t::FPTrunc:
+        if(is_foldable_fp(ty)) return get_fp(ty, value);
+        break;
+      case ir::cast_op_t::FPToSI:
+      case ir::cast_op_t::FPToUI: {
+        // out-of-range conversions are undefined
+        unsigned bits = ty->get_integer_bitwidth();
+        double lo = x->get_op() == ir::cast_op_t::FPToSI ? -std::ldexp(1., bits - 1) : 0.;
+        double hi = x->get_op() == ir::cast_op_t::FPToSI ? std::ldexp(1., bits - 1) : std::ldexp(1., bits);
+        if(bits > 1 && bits < 64 && value > lo - 1. && value < hi)
+          return get_int(ty, (uint64_t)(int64_t)std::trunc(value));
+        break;
+      }
+      default: break;
+    }
+  }
+  return nullptr;
+}
+
+/// cast(splat(x)) -> splat(cast(x))
+ir::value* simplify::splat_cast(ir::instruction *i, ir::builder &builder) {
+  auto *x = ir::dyn_cast<ir::cast_inst>(i);
+  if(!x)
+    return nullptr;
+  auto *splat = ir::dyn_cast<ir::splat_inst>(x->get_operand(0));
+  if(!splat)
+    return nullptr;
+  builder.set_insert_point(x);
+  ir::value *cast = builder.create_cast(x->get_op(), splat->get_operand(0), x->get_type()->get_scalar_ty());
+  return builder.create_splat(cast, x->get_type()->get_block_shapes());
+}
+
+/// no-op and redundant casts
+ir::value* simplify::simplify_cast(ir::instruction *i, ir::builder &builder) {
+  auto *x = ir::dyn_cast<ir::cast_inst>(i);
+  if(!x)
+    return nullptr;
+  ir::value *arg = x->get_operand(0);
+  ir::cast_op_t op = x->get_op();
+  bool is_int_cast = op == ir::cast_op_t::Trunc || op == ir::cast_op_t::SExt || op == ir::cast_op_t::ZExt;
+  if(arg->get_type() == x->get_type() && (is_int_cast || op == ir::cast_op_t::BitCast))
+    return arg;
+  auto *y = ir::dyn_cast<ir::cast_inst>(arg);
+  if(!y)
+    return nullptr;
+  // trunc(ext(x)) -> x
+  bool is_ext = y->get_op() == ir::cast_op_t::SExt || y->get_op() == ir::cast_op_t::ZExt;
+  if(op == ir::cast_op_t::Trunc && is_ext && y->get_operand(0)->get_type() == x->get_type())
+    return y->get_operand(0);
+  // sext(sext(x)) -> sext(x) ; zext(zext(x)) -> zext(x)
+  if((op == ir::cast_op_t::SExt || op == ir::cast_op_t::ZExt) && y->get_op() == op){
+    builder.set_insert_point(x);
+    return builder.create_cast(op, y->get_operand(0), x->get_type());
+  }
+  return nullptr;
+}
+
+/*
+ * retile_inst
+ */
+
+ir::value* simplify::simplify_retile(ir::instruction *i, ir::builder &builder) {
+  ir::value_id_t id = i->get_id();
+  if(id != ir::INST_RESHAPE && id != ir::INST_BROADCAST && id != ir::INST_DOWNCAST)
+    return nullptr;
+  ir::value *arg = i->get_operand(0);
+  // downcast(splat(x)) -> x
+  if(id == ir::INST_DOWNCAST){
+    auto *splat = ir::dyn_cast<ir::splat_inst>(arg);
+    return splat ? splat->get_operand(0) : nullptr;
+  }
+  // reshape(x) -> x ; broadcast(x) -> x if the shape is unchanged
+  if(arg->get_type() == i->get_type())
+    return arg;
+  auto *x = ir::dyn_cast<ir::instruction>(arg);
+  if(!x)
+    return nullptr;
+  ir::type::block_shapes_t shapes = i->get_type()->get_block_shapes();
+  // reshape(splat(x)) -> splat(x) ; broadcast(splat(x)) -> splat(x)
+  if(x->get_id() == ir::INST_SPLAT){
+    builder.set_insert_point(i);
+    return builder.create_splat(x->get_operand(0), shapes);
+  }
+  // reshape(reshape(x)) -> reshape(x) ; broadcast(broadcast(x)) -> broadcast(x)
+  if(x->get_id() == id){
+    builder.set_insert_point(i);
+    if(id == ir::INST_RESHAPE)
+      return builder.create_reshape(x->get_operand(0), shapes);
+    return builder.create_broadcast(x->get_operand(0), shapes);
+  }
+  return nullptr;
+}
+
+/*
+ * select_inst
+ */
+
+/// select(true, a, b) -> a ; select(false, a, b) -> b ; select(c, a, a) -> a
+ir::value* simplify::simplify_select(ir::instruction *i, ir::builder &builder) {
+  auto *x = ir::dyn_cast<ir::select_inst>(i);
+  if(!x)
+    return nullptr;
+  if(x->get_if_value_op() == x->get_else_value_op())
+    return x->get_if_value_op();
+  auto *pred = ir::dyn_cast_or_null<ir::constant_int>(get_splat_constant(x->get_pred_op()));
+  if(!pred)
+    return nullptr;
+  return (pred->get_value() & 1) ? x->get_if_value_op() : x->get_else_value_op();
+}
+
+void simplify::run(ir::module &mod) {
+  num_simplified_ = 0;
+  ir::builder &builder = mod.get_builder();
+  bool changed = true;
+  while(changed){
+    changed = false;
+    for(ir::function *fn: mod.get_function_list())
+    for(ir::basic_block *block: ir::cfg::reverse_post_order(fn)){
+      // rules may insert new instructions
+      std::vector<ir::instruction*> insts(block->begin(), block->end());
+      std::vector<ir::instruction*> to_delete;
+      for(ir::instruction *i: insts){
+        // user-provided hints must be preserved
+        if(i->get_metadata(ir::metadata::multiple_of) || i->get_metadata(ir::metadata::max_contiguous))
+          continue;
+        for(rule_t rule: rules_){
+          ir::value *res = (this->*rule)(i, builder);
+          if(!res)
+            continue;
+          i->replace_all_uses_with(res);
+          to_delete.push_back(i);
+          num_simplified_++;
+          changed = true;
+          break;
+        }
+      }
+      for(ir::instruction *i: to_delete)
+        i->erase_from_parent();
+    }
+  }
+}
+
+}
+}
+}
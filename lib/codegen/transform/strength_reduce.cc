@@ -0,0 +1,118 @@
+#include "triton/codegen/transform/strength_reduce.h"
+#include "triton/ir/module.h"
+#include "triton/ir/function.h"
+#include "triton/ir/basic_block.h"
+#include "triton/ir/instructions.h"
+#include "triton/ir/utils.h"
+
+namespace triton {
+namespace codegen{
+namespace transform{
+
+/// decomposes `v` into gep(splat(base), offs) followed by scalar `steps`
+static bool decompose(ir::value *v, ir::value *&base, ir::value *&offs, std::vector<ir::value*> &steps) {
+  auto *gep = ir::dyn_cast<ir::getelementptr_inst>(v);
+  if(!gep || gep->get_num_operands() != 2)
+    return false;
+  ir::value *idx = *gep->idx_begin();
+  if(auto *splat = ir::dyn_cast<ir::splat_inst>(gep->get_pointer_operand())){
+    base = splat->get_operand(0);
+    offs = idx;
+    return true;
+  }
+  auto *splat = ir::dyn_cast<ir::splat_inst>(idx);
+  if(!splat || !decompose(gep->get_pointer_operand(), base, offs, steps))
+    return false;
+  steps.push_back(splat->get_operand(0));
+  return true;
+}
+
+/// whether `v` is available at the beginning of `block`
+static bool is_available(ir::value *v, ir::basic_block *block,
+                         const std::map<ir::basic_block*, ir::basic_block*> &idom) {
+  auto *i = ir::dyn_cast<ir::instruction>(v);
+  if(!i)
+    return true;
+  ir::basic_block *def = i->get_parent();
+  return def != block && idom.find(def) != idom.end() && ir::cfg::dominates(idom, def, block);
+}
+
+bool strength_reduce::rewrite(ir::phi_node *phi, ir::builder &builder,
+                              const std::map<ir::basic_block*, ir::basic_block*> &idom) {
+  ir::type *ty = phi->get_type();
+  if(!ty->is_block_ty() || !ty->get_scalar_ty()->is_pointer_ty() || phi->get_num_incoming() != 2)
+    return false;
+  // next = gep(phi, splat(step))
+  unsigned k = 0;
+  auto *next = ir::dyn_cast<ir::getelementptr_inst>(phi->get_incoming_value(k));
+  if(!next || next->get_pointer_operand() != phi)
+    next = ir::dyn_cast<ir::getelementptr_inst>(phi->get_incoming_value(k = 1));
+  if(!next || next->get_pointer_operand() != phi || next->get_num_operands() != 2)
+    return false;
+  if(!ir::isa<ir::splat_inst>(*next->idx_begin()))
+    return false;
+  // init = gep(splat(base), offs), possibly advanced by scalar steps
+  ir::value *init = phi->get_incoming_value(1 - k);
+  ir::value *base, *offs;
+  std::vector<ir::value*> init_steps;
+  if(!decompose(init, base, offs, init_steps))
+    return false;
+  ir::basic_block *header = phi->get_parent();
+  if(!is_available(base, header, idom) || !is_available(offs, header, idom))
+    return false;
+  for(ir::value *s: init_steps)
+    if(!is_available(s, header, idom))
+      return false;
+  // scalar induction variable
+  builder.set_insert_point((ir::instruction*)init);
+  for(ir::value *s: init_steps)
+    base = builder.create_gep(base, {s});
+  builder.set_insert_point(phi);
+  ir::phi_node *ptr = builder.create_phi(base->get_type(), 2);
+  // block pointers are rebuilt from the loop-invariant offsets
+  ir::type::block_shapes_t shapes = ty->get_block_shapes();
+  auto rebuild = [&](ir::value *scalar) {
+    return builder.create_gep(builder.create_splat(scalar, shapes), {offs});
+  };
+  // `next` and other pointers derived from `phi` by a uniform offset
+  ir::value *ptr_next = nullptr;
+  std::vector<ir::user*> users(phi->get_users().begin(), phi->get_users().end());
+  for(ir::user *u: users){
+    auto *gep = ir::dyn_cast<ir::getelementptr_inst>(u);
+    if(!gep || gep->get_pointer_operand() != phi || gep->get_num_operands() != 2)
+      continue;
+    auto *splat = ir::dyn_cast<ir::splat_inst>(*gep->idx_begin());
+    if(!splat)
+      continue;
+    builder.set_insert_point(gep);
+    ir::value *scalar = builder.create_gep(ptr, {splat->get_operand(0)});
+    if(gep == next)
+      ptr_next = scalar;
+    gep->replace_all_uses_with(rebuild(scalar));
+  }
+  ptr->add_incoming(base, phi->get_incoming_block(1 - k));
+  ptr->add_incoming(ptr_next, phi->get_incoming_block(k));
+  builder.set_insert_point(header->get_first_non_phi());
+  // `phi` and the geps above are now dead and removed by dce
+  phi->replace_all_uses_with(rebuild(ptr));
+  return true;
+}
+
+void strength_reduce::run(ir::module &mod) {
+  num_rewritten_ = 0;
+  ir::builder &builder = mod.get_builder();
+  for(ir::function *fn: mod.get_function_list()){
+    std::map<ir::basic_block*, ir::basic_block*> idom = ir::cfg::immediate_dominators(fn);
+    std::vector<ir::phi_node*> phis;
+    for(ir::basic_block *block: fn->blocks())
+    for(ir::instruction *i: block->get_inst_list())
+      if(auto *phi = ir::dyn_cast<ir::phi_node>(i))
+        phis.push_back(phi);
+    for(ir::phi_node *phi: phis)
+      num_rewritten_ += rewrite(phi, builder, idom);
+  }
+}
+
+}
+}
+}
@@ -0,0 +1,261 @@
+#include <algorithm>
+#include <stdexcept>
+#include "triton/codegen/transform/unroll.h"
+#include "triton/ir/module.h"
+#include "triton/ir/function.h"
+#include "triton/ir/basic_block.h"
+#include "triton/ir/instructions.h"
+#include "triton/ir/constant.h"
+#include "triton/ir/type.h"
+
+namespace triton {
+namespace codegen{
+namespace transform{
+
+// number of iterations simulated before giving up on finding a trip count
+static const int max_trip_count = 4096;
+
+static int64_t sext(uint64_t x, unsigned bits) {
+  if(bits >= 64)
+    return x;
+  uint64_t mask = (uint64_t(1) << bits) - 1;
+  uint64_t sign = uint64_t(1) << (bits - 1);
+  return ((x & mask) ^ sign) - sign;
+}
+
+static uint64_t zext(int64_t x, unsigned bits) {
+  if(bits >= 64)
+    return x;
+  return uint64_t(x) & ((uint64_t(1) << bits) - 1);
+}
+
+static bool compare(ir::cmp_pred_t pred, int64_t lhs, int64_t rhs, unsigned bits) {
+  uint64_t ulhs = zext(lhs, bits);
+  uint64_t urhs = zext(rhs, bits);
+  switch(pred){
+    case ir::ICMP_EQ:  return lhs == rhs;
+    case ir::ICMP_NE:  return lhs != rhs;
+    case ir::ICMP_UGT: return ulhs > urhs;
+    case ir::ICMP_UGE: return ulhs >= urhs;
+    case ir::ICMP_ULT: return ulhs < urhs;
+    case ir::ICMP_ULE: return ulhs <= urhs;
+    case ir::ICMP_SGT: return lhs > rhs;
+    case ir::ICMP_SGE: return lhs >= rhs;
+    case ir::ICMP_SLT: return lhs < rhs;
+    case ir::ICMP_SLE: return lhs <= rhs;
+    default: throw std::runtime_error("unreachable");
+  }
+}
+
+/// evaluates scalar integer expressions given the values of some phi nodes
+bool unroll::evaluate(ir::value *v, const env_t &env, int64_t &res) {
+  auto it = env.find(v);
+  if(it != env.end()){
+    res = it->second;
+    return true;
+  }
+  if(!v->get_type()->is_integer_ty())
+    return false;
+  unsigned bits = v->get_type()->get_integer_bitwidth();
+  if(auto *x = ir::dyn_cast<ir::constant_int>(v)){
+    res = sext(x->get_value(), bits);
+    return true;
+  }
+  if(auto *x = ir::dyn_cast<ir::binary_operator>(v)){
+    int64_t lhs, rhs;
+    if(!evaluate(x->get_operand(0), env, lhs) || !evaluate(x->get_operand(1), env, rhs))
+      return false;
+    uint64_t ulhs = zext(lhs, bits);
+    uint64_t urhs = zext(rhs, bits);
+    uint64_t ures;
+    switch(x->get_op()){
+      case ir::binary_op_t::Add: ures = ulhs + urhs; break;
+      case ir::binary_op_t::Sub: ures = ulhs - urhs; break;
+      case ir::binary_op_t::Mul: ures = ulhs * urhs; break;
+      case ir::binary_op_t::And: ures = ulhs & urhs; break;
+      case ir::binary_op_t::Or:  ures = ulhs | urhs; break;
+      case ir::binary_op_t::Xor: ures = ulhs ^ urhs; break;
+      case ir::binary_op_t::SDiv: if(rhs == 0) return false; ures = lhs / rhs; break;
+      case ir::binary_op_t::SRem: if(rhs == 0) return false; ures = lhs % rhs; break;
+      case ir::binary_op_t::UDiv: if(urhs == 0) return false; ures = ulhs / urhs; break;
+      case ir::binary_op_t::URem: if(urhs == 0) return false; ures = ulhs % urhs; break;
+      case ir::binary_op_t::Shl:  if(urhs >= bits) return false; ures = ulhs << urhs; break;
+      case ir::binary_op_t::LShr: if(urhs >= bits) return false; ures = ulhs >> urhs; break;
+      case ir::binary_op_t::AShr: if(urhs >= bits) return false; ures = lhs >> urhs; break;
+      default: return false;
+    }
+    res = sext(ures, bits);
+    return true;
+  }
+  if(auto *x = ir::dyn_cast<ir::icmp_inst>(v)){
+    int64_t lhs, rhs;
+    if(!evaluate(x->get_operand(0), env, lhs) || !evaluate(x->get_operand(1), env, rhs))
+      return false;
+    unsigned op_bits = x->get_operand(0)->get_type()->get_integer_bitwidth();
+    res = compare(x->get_pred(), lhs, rhs, op_bits);
+    return true;
+  }
+  if(auto *x = ir::dyn_cast<ir::select_inst>(v)){
+    int64_t pred;
+    if(!evaluate(x->get_pred_op(), env, pred))
+      return false;
+    return evaluate(pred ? x->get_if_value_op() : x->get_else_value_op(), env, res);
+  }
+  return false;
+}
+
+/// number of times `block` executes once entered from `header`,
+/// or -1 if it cannot be determined at compile-time
+int unroll::get_trip_count(ir::basic_block *block, ir::basic_block *header,
+                           ir::cond_branch_inst *br) {
+  // the loop must be entered
+  if(auto *header_br = ir::dyn_cast<ir::cond_branch_inst>(&header->back())){
+    int64_t cond;
+    if(!evaluate(header_br->get_cond(), env_t(), cond))
+      return -1;
+    if((cond != 0) != (header_br->get_true_dest() == block))
+      return -1;
+  }
+  // initial values of the induction variables
+  env_t env;
+  for(ir::instruction *i: block->get_inst_list())
+  if(auto *phi = ir::dyn_cast<ir::phi_node>(i)){
+    int64_t init;
+    if(evaluate(phi->get_value_for_block(header), env_t(), init))
+      env[phi] = init;
+  }
+  // simulate the loop
+  for(int n = 1; n <= max_trip_count; n++){
+    int64_t cond;
+    if(!evaluate(br->get_cond(), env, cond))
+      return -1;
+    if(!cond)
+      return n;
+    env_t next;
+    for(auto &x: env){
+      int64_t val;
+      ir::phi_node *phi = (ir::phi_node*)x.first;
+      if(evaluate(phi->get_value_for_block(block), env, val))
+        next[phi] = val;
+    }
+    env = std::move(next);
+  }
+  return -1;
+}
+
+void unroll::do_unroll(ir::basic_block *block, ir::basic_block *header,
+                       ir::cond_branch_inst *br, unsigned factor, bool full) {
+  std::vector<ir::phi_node*> phis;
+  std::vector<ir::instruction*> body;
+  for(ir::instruction *i: block->get_inst_list()){
+    if(auto *phi = ir::dyn_cast<ir::phi_node>(i))
+      phis.push_back(phi);
+    else if(i != br)
+      body.push_back(i);
+  }
+  auto lookup = [](const std::map<ir::value*, ir::value*> &vmap, ir::value *v) {
+    auto it = vmap.find(v);
+    return it == vmap.end() ? v : it->second;
+  };
+  // append `factor - 1` copies of the body before the terminator;
+  // `vmap` maps each original value to its counterpart in the last copy
+  std::map<ir::value*, ir::value*> vmap;
+  ir::basic_block::inst_list_t &insts = block->get_inst_list();
+  auto insert_pt = std::find(insts.begin(), insts.end(), (ir::instruction*)br);
+  for(unsigned k = 1; k < factor; k++){
+    std::map<ir::value*, ir::value*> next;
+    for(ir::phi_node *phi: phis)
+      next[phi] = lookup(vmap, phi->get_value_for_block(block));
+    for(ir::instruction *i: body){
+      ir::instruction *copy = i->clone();
+      for(size_t n = 0; n < i->ops().size(); n++)
+        if(ir::value *op = i->ops()[n])
+          copy->set_operand(n, lookup(next, op));
+      insts.insert(insert_pt, copy);
+      copy->set_parent(block);
+      next[i] = copy;
+    }
+    vmap = std::move(next);
+  }
+  // users outside of the loop see the values of the last copy
+  std::vector<ir::instruction*> defs(phis.begin(), phis.end());
+  defs.insert(defs.end(), body.begin(), body.end());
+  for(ir::instruction *i: defs){
+    ir::value *last = lookup(vmap, i);
+    if(last == i)
+      continue;
+    std::vector<ir::user*> users(i->get_users().begin(), i->get_users().end());
+    for(ir::user *u: users){
+      auto *inst = ir::dyn_cast<ir::instruction>(u);
+      if(inst && inst->get_parent() != block)
+        u->replace_uses_of_with(i, last);
+    }
+  }
+  // back-edge values and exit condition come from the last copy
+  for(ir::phi_node *phi: phis){
+    ir::value *latch = phi->get_value_for_block(block);
+    ir::value *last = lookup(vmap, latch);
+    if(last != latch)
+      phi->replace_uses_of_with(latch, last);
+  }
+  ir::value *cond = br->get_cond();
+  if(lookup(vmap, cond) != cond)
+    br->replace_uses_of_with(cond, lookup(vmap, cond));
+  if(!full)
+    return;
+  // the loop now executes exactly once: remove the back-edge
+  ir::basic_block *exit = br->get_false_dest();
+  br->erase_from_parent();
+  ir::instruction *exit_br = ir::branch_inst::create(exit);
+  insts.push_back(exit_br);
+  exit_br->set_parent(block);
+  block->remove_predecessor(block);
+  for(ir::phi_node *phi: phis)
+    phi->replace_all_uses_with(phi->get_value_for_block(header));
+  for(ir::phi_node *phi: phis)
+    phi->erase_from_parent();
+}
+
+void unroll::run(ir::module &mod) {
+  for(ir::function *fn: mod.get_function_list()){
+    // unrolling does not create or delete blocks
+    for(ir::basic_block *block: fn->blocks()){
+      if(block->empty())
+        continue;
+      // single-block loop entered from `header`
+      auto *br = ir::dyn_cast<ir::cond_branch_inst>(&block->back());
+      if(!br || br->get_true_dest() != block || br->get_false_dest() == block)
+        continue;
+      const auto &preds = block->get_predecessors();
+      if(preds.size() != 2 || (preds[0] == block) == (preds[1] == block))
+        continue;
+      ir::basic_block *header = preds[0] == block ? preds[1] : preds[0];
+      unsigned size = 0;
+      bool valid = true;
+      for(ir::instruction *i: block->get_inst_list()){
+        if(auto *phi = ir::dyn_cast<ir::phi_node>(i))
+          valid = valid && phi->get_num_incoming() == 2;
+        else if(i != br)
+          size++;
+      }
+      if(!valid)
+        continue;
+      int trip_count = get_trip_count(block, header, br);
+      if(trip_count <= 0)
+        continue;
+      if(trip_count * size <= max_size_){
+        do_unroll(block, header, br, trip_count, true);
+        continue;
+      }
+      unsigned factor = max_factor_;
+      while(factor > 1 && (trip_count % factor != 0 || factor * size > max_size_))
+        factor--;
+      if(factor > 1)
+        do_unroll(block, header, br, factor, false);
+    }
+  }
+}
+
+}
+}
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "triton/ir/basic_block.h"
 #include "triton/ir/instructions.h"
 #include "triton/ir/type.h"
@@ -10,7 +11,7 @@ class phi_node;
 
 
 basic_block::basic_block(context &ctx, const std::string &name, function *parent):
-    value(type::get_label_ty(ctx), name), ctx_(ctx), parent_(parent) {
+    value(type::get_label_ty(ctx), VALUE_BASIC_BLOCK, name), ctx_(ctx), parent_(parent) {
   if(parent_)
     parent_->insert_block(this);
 }
@@ -25,12 +26,21 @@ void basic_block::add_predecessor(basic_block *pred) {
     pred->succs_.push_back(this);
 }
 
+void basic_block::remove_predecessor(basic_block *pred) {
+  auto it = std::find(preds_.begin(), preds_.end(), pred);
+  if(it == preds_.end())
+    return;
+  preds_.erase(it);
+  if(pred)
+    pred->succs_.erase(std::find(pred->succs_.begin(), pred->succs_.end(), this));
+}
+
 
 
 basic_block::iterator basic_block::get_first_non_phi(){
   auto it = begin();
   for(; it != end(); it++)
-  if(!dynamic_cast<phi_node*>(*it)){
+  if(!isa<phi_node>(*it)){
     return it;
   }
   return it;
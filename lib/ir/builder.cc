@@ -345,8 +345,8 @@ value *builder::create_log(value *arg){
   return insert(log_inst::create(arg));
 }
 
-value *builder::create_dot(value *A, value *B, value *C) {
-  return insert(dot_inst::create_nn(A, B, C));
+value *builder::create_dot(value *A, value *B, value *C, bool allow_tf32) {
+  return insert(dot_inst::create_nn(A, B, C, allow_tf32));
 }
 
 value *builder::create_trans(value *A, const std::vector<int>& perm) {
@@ -361,6 +361,14 @@ value *builder::create_reduce(value *A, reduce_inst::op_t op, unsigned axis) {
   return insert(reduce_inst::create(A, op, axis));
 }
 
+value *builder::create_scan(value *A, scan_inst::op_t op, unsigned axis) {
+  return insert(scan_inst::create(A, op, axis));
+}
+
+value *builder::create_sort(value *A, unsigned axis, unsigned k, bool descending) {
+  return insert(sort_inst::create(A, axis, k, descending));
+}
+
 value *builder::create_select(value *pred, value *if_value, value *else_value){
   return insert(select_inst::create(pred, if_value, else_value));
 }
@@ -41,7 +41,7 @@ constant *constant::get_all_ones_value(type *ty) {
 // FIXME use something like APInt
 
 constant_int::constant_int(type *ty, uint64_t value)
-  : constant(ty, 0), value_(value){ }
+  : constant(ty, VALUE_CONSTANT_INT, 0), value_(value){ }
 
 constant_int *constant_int::get(type *ty, uint64_t value) {
   if (!ty->is_integer_ty())
@@ -58,7 +58,7 @@ constant_int *constant_int::get(type *ty, uint64_t value) {
 // FIXME use something like APFloat
 
 constant_fp::constant_fp(type *ty, double value)
-  : constant(ty, 0), value_(value){ }
+  : constant(ty, VALUE_CONSTANT_FP, 0), value_(value){ }
 
 constant *constant_fp::get_negative_zero(type *ty){
   double neg_zero = 0;
@@ -82,7 +82,7 @@ constant *constant_fp::get(type *ty, double v){
 
 // undef value
 undef_value::undef_value(type *ty)
-  : constant(ty, 0) { }
+  : constant(ty, VALUE_UNDEF, 0) { }
 
 undef_value *undef_value::get(type *ty) {
   context_impl *impl = ty->get_context().p_impl.get();
@@ -93,23 +93,23 @@ undef_value *undef_value::get(type *ty) {
 }
 
 /* global value */
-global_value::global_value(type *ty, unsigned num_ops,
+global_value::global_value(type *ty, value_id_t id, unsigned num_ops,
                            linkage_types_t linkage,
                            const std::string &name, unsigned addr_space)
-    : constant(pointer_type::get(ty, addr_space), num_ops, name),
+    : constant(pointer_type::get(ty, addr_space), id, num_ops, name),
       linkage_(linkage) { }
 
 
 /* global object */
-global_object::global_object(type *ty, unsigned num_ops,
+global_object::global_object(type *ty, value_id_t id, unsigned num_ops,
                             linkage_types_t linkage,
                             const std::string &name, unsigned addr_space)
-  : global_value(ty, num_ops, linkage, name, addr_space) { }
+  : global_value(ty, id, num_ops, linkage, name, addr_space) { }
 
 
 /* alloc const */
 alloc_const::alloc_const(type *ty, constant_int *size, const std::string &name)
-  : global_object(ty, 1, global_value::external, name, 4) {
+  : global_object(ty, VALUE_ALLOC_CONST, 1, global_value::external, name, 4) {
   set_operand(0, size);
 }
 
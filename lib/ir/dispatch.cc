@@ -1,5 +1,6 @@
 #include "triton/ir/dispatch.h"
 #include <iostream>
+#include <functional>
 
 namespace triton{
 namespace ir{
@@ -497,7 +498,39 @@ ir::value *dispatch::cast(ir::value *input, ir::type *dst_ty, ir::builder *build
 //                               Memory Operators
 //===----------------------------------------------------------------------===//
 
-ir::value *dispatch::load(ir::value* ptr, ir::value* mask, ir::value* other, ir::builder* builder) {
+/// parses the cache and eviction hints of a memory access and attaches them to `i`
+static ir::value *set_io_hints(ir::value *i, const std::string &cache_modifier, const std::string &eviction_policy,
+                               bool is_volatile, bool is_load) {
+  static const std::map<std::string, ir::io_inst::CACHE_MODIFIER> load_modifiers = {
+    {"", ir::io_inst::NONE}, {".ca", ir::io_inst::CA}, {".cg", ir::io_inst::CG},
+    {".cs", ir::io_inst::CS}, {".lu", ir::io_inst::LU}, {".cv", ir::io_inst::CV}
+  };
+  static const std::map<std::string, ir::io_inst::CACHE_MODIFIER> store_modifiers = {
+    {"", ir::io_inst::NONE}, {".wb", ir::io_inst::WB}, {".cg", ir::io_inst::CG},
+    {".cs", ir::io_inst::CS}, {".wt", ir::io_inst::WT}
+  };
+  static const std::map<std::string, ir::io_inst::EVICTION_POLICY> policies = {
+    {"", ir::io_inst::NORMAL}, {"evict_normal", ir::io_inst::NORMAL},
+    {"evict_first", ir::io_inst::EVICT_FIRST}, {"evict_last", ir::io_inst::EVICT_LAST}
+  };
+  const auto &modifiers = is_load ? load_modifiers : store_modifiers;
+  auto cache = modifiers.find(cache_modifier);
+  if(cache == modifiers.end())
+    throw semantic_error("Cache modifier " + cache_modifier + " not supported for " + (is_load ? "loads" : "stores"));
+  auto policy = policies.find(eviction_policy);
+  if(policy == policies.end())
+    throw semantic_error("Eviction policy " + eviction_policy + " not supported");
+  if(is_volatile && cache->second != ir::io_inst::NONE)
+    throw semantic_error("Volatile memory accesses cannot have a cache modifier");
+  ir::io_inst *io = (ir::io_inst*)i;
+  io->set_cache_modifier(cache->second);
+  io->set_eviction_policy(policy->second);
+  io->set_is_volatile(is_volatile);
+  return io;
+}
+
+ir::value *dispatch::load(ir::value* ptr, ir::value* mask, ir::value* other, const std::string &cache_modifier,
+                          const std::string &eviction_policy, bool is_volatile, ir::builder* builder) {
   if(!ptr->get_type()->get_scalar_ty()->is_pointer_ty())
     throw semantic_error("Pointer argument of load instruction is " + ptr->get_type()->repr());
   if(ptr->get_type()->is_block_ty()){
@@ -510,7 +543,7 @@ ir::value *dispatch::load(ir::value* ptr, ir::value* mask, ir::value* other, ir:
     }
   }
   if (!mask && !other)
-    return builder->create_load(ptr);
+    return set_io_hints(builder->create_load(ptr), cache_modifier, eviction_policy, is_volatile, true);
   if (!mask)
     throw std::runtime_error("`other` cannot be provided without `mask`");
   ir::type *elt_ty = ptr->get_type()->get_scalar_ty()->get_pointer_element_ty();
@@ -520,10 +553,11 @@ ir::value *dispatch::load(ir::value* ptr, ir::value* mask, ir::value* other, ir:
     if(ptr->get_type()->is_block_ty())
       other = builder->create_splat(other, ptr->get_type()->get_block_shapes());
   }
-  return builder->create_masked_load(ptr, mask, other);
+  return set_io_hints(builder->create_masked_load(ptr, mask, other), cache_modifier, eviction_policy, is_volatile, true);
 }
 
-ir::value *dispatch::store(ir::value* ptr, ir::value *val, ir::value* mask, ir::builder *builder) {
+ir::value *dispatch::store(ir::value* ptr, ir::value *val, ir::value* mask, const std::string &cache_modifier,
+                           const std::string &eviction_policy, bool is_volatile, ir::builder *builder) {
   if(!ptr->get_type()->get_scalar_ty()->is_pointer_ty())
     throw semantic_error("Pointer argument of store instruction is " + ptr->get_type()->repr());
   if(ptr->get_type()->is_block_ty())
@@ -533,10 +567,10 @@ ir::value *dispatch::store(ir::value* ptr, ir::value *val, ir::value* mask, ir::
   ir::type *ptr_ty = ptr->get_type();
   val = dispatch::cast(val, ptr_ty->get_scalar_ty()->get_pointer_element_ty(), builder);
   if (!mask)
-    return builder->create_store(ptr, val);
+    return set_io_hints(builder->create_store(ptr, val), cache_modifier, eviction_policy, is_volatile, false);
   if(!mask->get_type()->get_scalar_ty()->is_bool_ty())
     throw semantic_error("Mask must have boolean scalar type");
-  return builder->create_masked_store(ptr, val, mask);
+  return set_io_hints(builder->create_masked_store(ptr, val, mask), cache_modifier, eviction_policy, is_volatile, false);
 }
 
 ir::value *dispatch::atomic_cas(ir::value* ptr, ir::value *cmp, ir::value *val, ir::builder *builder){
@@ -630,12 +664,20 @@ ir::value *dispatch::atomic_xchg(ir::value* ptr, ir::value *val, ir::value *mask
 //                               Linear Algebra
 //===----------------------------------------------------------------------===//
 
-ir::value *dispatch::dot(ir::value *lhs, ir::value *rhs, ir::builder *builder) {
+ir::value *dispatch::dot(ir::value *lhs, ir::value *rhs, bool allow_tf32, ir::builder *builder) {
+  ir::type *lhs_sca_ty = lhs->get_type()->get_scalar_ty();
+  ir::type *rhs_sca_ty = rhs->get_type()->get_scalar_ty();
   ir::value *_0 = builder->get_float32(0);
+  // int8 products are accumulated in int32
+  if(lhs_sca_ty->is_integer_ty() || rhs_sca_ty->is_integer_ty()){
+    if(!lhs_sca_ty->is_integer_ty(8) || !rhs_sca_ty->is_integer_ty(8))
+      throw semantic_error("integer dot only supports int8 operands");
+    _0 = builder->get_int32(0);
+  }
   unsigned M = lhs->get_type()->get_block_shapes()[0];
   unsigned N = rhs->get_type()->get_block_shapes()[1];
   _0 = builder->create_splat(_0, {M, N});
-  return builder->create_dot(lhs, rhs, _0);
+  return builder->create_dot(lhs, rhs, _0, allow_tf32);
 }
 
 
@@ -686,6 +728,107 @@ ir::value *dispatch::sum(ir::value *input, unsigned int axis, ir::builder *build
   return reduce_impl(input, axis, builder, "sum", ir::reduce_inst::FADD, ir::reduce_inst::ADD);
 }
 
+ir::value *arg_reduce_impl(ir::value *input, unsigned int axis, ir::builder *builder, const std::string &name,
+                           ir::reduce_inst::op_t FLOAT_OP, ir::reduce_inst::op_t INT_OP) {
+  ir::type *scalar_ty = input->get_type()->get_scalar_ty();
+  // values and indices are exchanged through the same shared memory
+  // temporary, so values are kept at least 32-bits wide
+  if(scalar_ty->is_floating_point_ty() && scalar_ty->get_primitive_size_in_bits() < 32)
+    input = dispatch::cast(input, type::get_fp32_ty(scalar_ty->get_context()), builder);
+  return reduce_impl(input, axis, builder, name, FLOAT_OP, INT_OP);
+}
+
+ir::value *dispatch::argmin(ir::value *input, unsigned int axis, ir::builder *builder) {
+  return arg_reduce_impl(input, axis, builder, "argmin", ir::reduce_inst::ARGFMIN, ir::reduce_inst::ARGMIN);
+}
+
+ir::value *dispatch::argmax(ir::value *input, unsigned int axis, ir::builder *builder) {
+  return arg_reduce_impl(input, axis, builder, "argmax", ir::reduce_inst::ARGFMAX, ir::reduce_inst::ARGMAX);
+}
+
+ir::value *dispatch::logsumexp(ir::value *input, unsigned int axis, ir::builder *builder) {
+  ir::type *scalar_ty = input->get_type()->get_scalar_ty();
+  if(!scalar_ty->is_floating_point_ty() || scalar_ty->is_fp64_ty())
+    throw semantic_error("logsumexp only supports floating-point inputs of at most 32 bits");
+  // accumulated in fp32, like exp and log
+  if(!scalar_ty->is_fp32_ty())
+    input = dispatch::cast(input, type::get_fp32_ty(scalar_ty->get_context()), builder);
+  return builder->create_reduce(input, ir::reduce_inst::FLOGSUMEXP, axis);
+}
+
+
+//===----------------------------------------------------------------------===//
+//                               Scans
+//===----------------------------------------------------------------------===//
+
+ir::value *scan_impl(ir::value *input, unsigned int axis, ir::builder *builder, const std::string &name,
+                     ir::scan_inst::op_t FLOAT_OP, ir::scan_inst::op_t INT_OP) {
+  if(!input->get_type()->is_block_ty())
+    throw semantic_error(name + " expects a block input");
+  if(axis >= input->get_type()->get_tile_rank())
+    throw semantic_error(name + " axis out of range");
+  ir::type *scalar_ty = input->get_type()->get_scalar_ty();
+  // same promotion as reductions
+  if(scalar_ty->is_integer_ty() && scalar_ty->get_integer_bitwidth() <= 32)
+    input = dispatch::cast(input, type::get_int32_ty(scalar_ty->get_context()), builder);
+  if (scalar_ty->is_floating_point_ty())
+    return builder->create_scan(input, FLOAT_OP, axis);
+  else if (scalar_ty->is_integer_ty())
+    return builder->create_scan(input, INT_OP, axis);
+  return throw_unreachable(name);
+}
+
+ir::value *dispatch::cumsum(ir::value *input, unsigned int axis, ir::builder *builder) {
+  return scan_impl(input, axis, builder, "cumsum", ir::scan_inst::FADD, ir::scan_inst::ADD);
+}
+
+ir::value *dispatch::cumprod(ir::value *input, unsigned int axis, ir::builder *builder) {
+  return scan_impl(input, axis, builder, "cumprod", ir::scan_inst::FMUL, ir::scan_inst::MUL);
+}
+
+ir::value *dispatch::cummax(ir::value *input, unsigned int axis, ir::builder *builder) {
+  return scan_impl(input, axis, builder, "cummax", ir::scan_inst::FMAX, ir::scan_inst::MAX);
+}
+
+ir::value *dispatch::cummin(ir::value *input, unsigned int axis, ir::builder *builder) {
+  return scan_impl(input, axis, builder, "cummin", ir::scan_inst::FMIN, ir::scan_inst::MIN);
+}
+
+
+//===----------------------------------------------------------------------===//
+//                               Sorting
+//===----------------------------------------------------------------------===//
+
+static bool is_power_of_2(unsigned x) {
+  return x > 0 && (x & (x - 1)) == 0;
+}
+
+ir::value *sort_impl(ir::value *input, unsigned int axis, unsigned int k, bool descending,
+                     ir::builder *builder, const std::string &name) {
+  if(!input->get_type()->is_block_ty())
+    throw semantic_error(name + " expects a block input");
+  if(axis >= input->get_type()->get_tile_rank())
+    throw semantic_error(name + " axis out of range");
+  unsigned shape = input->get_type()->get_block_shapes()[axis];
+  if(!is_power_of_2(shape))
+    throw semantic_error(name + " expects a power of 2 number of elements along the axis");
+  if(!is_power_of_2(k) || k > shape)
+    throw semantic_error(name + " expects k to be a power of 2 no larger than the axis");
+  ir::type *scalar_ty = input->get_type()->get_scalar_ty();
+  if(!scalar_ty->is_floating_point_ty() && !scalar_ty->is_integer_ty())
+    return throw_unreachable(name);
+  return builder->create_sort(input, axis, k, descending);
+}
+
+ir::value *dispatch::sort(ir::value *input, unsigned int axis, bool descending, ir::builder *builder) {
+  unsigned shape = input->get_type()->is_block_ty() ? input->get_type()->get_block_shapes().at(axis) : 0;
+  return sort_impl(input, axis, shape, descending, builder, "sort");
+}
+
+ir::value *dispatch::topk(ir::value *input, unsigned int k, unsigned int axis, ir::builder *builder) {
+  return sort_impl(input, axis, k, true, builder, "topk");
+}
+
 
 //===----------------------------------------------------------------------===//
 //                               Math
@@ -715,7 +858,7 @@ ir::value *dispatch::sqrt(ir::value *x, ir::builder *builder) {
 //
 
 ir::value *dispatch::multiple_of(ir::value *x, int value, ir::builder *){
-  ir::instruction* i = dynamic_cast<ir::instruction*>(x);
+  ir::instruction* i = ir::dyn_cast<ir::instruction>(x);
   if(!i)
     throw_unreachable("multiple_of");
   i->set_metadata(ir::metadata::multiple_of, value);
@@ -723,7 +866,7 @@ ir::value *dispatch::multiple_of(ir::value *x, int value, ir::builder *){
 }
 
 ir::value *dispatch::max_contiguous(ir::value *x, int value, ir::builder *){
-  ir::instruction* i = dynamic_cast<ir::instruction*>(x);
+  ir::instruction* i = ir::dyn_cast<ir::instruction>(x);
   if(!i)
     throw_unreachable("max_contiguous");
   i->set_metadata(ir::metadata::max_contiguous, value);
@@ -734,6 +877,51 @@ ir::value *dispatch::debug_barrier(ir::builder *builder) {
   return builder->create_barrier();
 }
 
+//===----------------------------------------------------------------------===//
+//                               Batched Operations
+//===----------------------------------------------------------------------===//
+
+struct batched_op_t {
+  std::string name;
+  size_t num_args;
+  std::function<ir::value*(const std::vector<ir::value*>&, ir::builder*)> fn;
+};
+
+#define UNARY(NAME) {#NAME, 1, [](const std::vector<ir::value*> &x, ir::builder *b) { return dispatch::NAME(x[0], b); }}
+#define BINARY(NAME) {#NAME, 2, [](const std::vector<ir::value*> &x, ir::builder *b) { return dispatch::NAME(x[0], x[1], b); }}
+static const std::vector<batched_op_t> &batched_op_table() {
+  static const std::vector<batched_op_t> table = {
+    BINARY(add), BINARY(sub), BINARY(mul), BINARY(truediv), BINARY(floordiv), BINARY(mod),
+    BINARY(and_), BINARY(or_), BINARY(xor_), BINARY(lshr), BINARY(shl),
+    UNARY(plus), UNARY(minus), UNARY(invert),
+    BINARY(greater_than), BINARY(greater_equal), BINARY(less_than),
+    BINARY(less_equal), BINARY(equal), BINARY(not_equal),
+    {"where", 3, [](const std::vector<ir::value*> &x, ir::builder *b) { return dispatch::where(x[0], x[1], x[2], b); }},
+    UNARY(exp), UNARY(log), UNARY(cos), UNARY(sin), UNARY(sqrt),
+  };
+  return table;
+}
+#undef UNARY
+#undef BINARY
+
+const std::vector<std::string> &dispatch::batched_ops() {
+  static std::vector<std::string> names;
+  if(names.empty())
+  for(const batched_op_t &op: batched_op_table())
+    names.push_back(op.name);
+  return names;
+}
+
+ir::value *dispatch::batched(unsigned opcode, const std::vector<ir::value*> &args, ir::builder *builder) {
+  const std::vector<batched_op_t> &table = batched_op_table();
+  if(opcode >= table.size())
+    throw std::runtime_error("invalid batched opcode " + std::to_string(opcode));
+  const batched_op_t &op = table[opcode];
+  if(args.size() != op.num_args)
+    throw std::runtime_error("wrong number of arguments for `" + op.name + "`");
+  return op.fn(args, builder);
+}
+
 
 }
 }
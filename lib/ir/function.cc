@@ -2,6 +2,8 @@
 #include "triton/ir/function.h"
 #include "triton/ir/type.h"
 #include "triton/ir/module.h"
+#include "triton/ir/basic_block.h"
+#include "triton/ir/instructions.h"
 
 namespace triton{
 namespace ir{
@@ -10,7 +12,7 @@ namespace ir{
 /* Argument */
 
 argument::argument(type *ty, const std::string &name, function *parent, unsigned arg_no)
-  : value(ty, name), parent_(parent), arg_no_(arg_no) { }
+  : value(ty, VALUE_ARGUMENT, name), parent_(parent), arg_no_(arg_no) { }
 
 argument *argument::create(type *ty, const std::string &name,
                           function *parent, unsigned arg_no) {
@@ -33,11 +35,8 @@ void argument::accept(visitor *v) {
 /* function */
 function::function(function_type *ty, linkage_types_t linkage,
                    const std::string &name, module *parent)
-    : global_object(ty, 0, linkage, name), parent_(parent), fn_ty_(ty) {
+    : global_object(ty, VALUE_FUNCTION, 0, linkage, name), parent_(parent), fn_ty_(ty) {
   unsigned num_params = fn_ty_->get_num_params();
-  // skip if no parameter
-  if(num_params == 0)
-    return;
   // create arguments
   args_.resize(num_params);
   for(unsigned i = 0; i < num_params; i++){
@@ -60,6 +59,59 @@ function *function::create(function_type *ty, linkage_types_t linkage,
   return new function(ty, linkage, name, mod);
 }
 
+/* cloning */
+function *function::clone(module *parent, std::map<value*, value*> &vmap) {
+  function *res = create(fn_ty_, get_linkage(), get_name(), parent);
+  res->attrs_ = attrs_;
+  for(size_t i = 0; i < args_.size(); i++){
+    res->args_[i]->set_name(args_[i]->get_name());
+    vmap[args_[i]] = res->args_[i];
+  }
+  // blocks
+  for(basic_block *block: blocks_)
+    vmap[block] = basic_block::create(block->get_context(), block->get_name(), res);
+  auto remap_block = [&](basic_block *block) {
+    return block ? (basic_block*)vmap.at(block) : nullptr;
+  };
+  for(basic_block *block: blocks_){
+    basic_block *new_block = remap_block(block);
+    for(basic_block *pred: block->preds_)
+      new_block->preds_.push_back(remap_block(pred));
+    for(basic_block *succ: block->succs_)
+      new_block->succs_.push_back(remap_block(succ));
+  }
+  // instructions; operands may be defined later in the
+  // block list (e.g., loop-carried phis), so remap in a second pass
+  std::vector<instruction*> cloned;
+  for(basic_block *block: blocks_)
+  for(instruction *inst: block->get_inst_list()){
+    instruction *new_inst = inst->clone();
+    basic_block *new_block = remap_block(block);
+    new_block->get_inst_list().push_back(new_inst);
+    new_inst->set_parent(new_block);
+    vmap[inst] = new_inst;
+    cloned.push_back(new_inst);
+  }
+  for(instruction *inst: cloned){
+    for(size_t i = 0; i < inst->ops().size(); i++){
+      value *op = inst->ops()[i];
+      if(!op)
+        continue;
+      auto it = vmap.find(op);
+      inst->set_operand(i, it == vmap.end() ? op : it->second);
+    }
+    if(auto *phi = dyn_cast<phi_node>(inst))
+    for(unsigned i = 0; i < phi->get_num_incoming(); i++)
+      phi->set_incoming_block(i, remap_block(phi->get_incoming_block(i)));
+  }
+  return res;
+}
+
+function *function::clone(module *parent) {
+  std::map<value*, value*> vmap;
+  return clone(parent, vmap);
+}
+
 
 }
 }
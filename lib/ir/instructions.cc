@@ -15,7 +15,7 @@ namespace ir{
 
 instruction::instruction(type *ty, value_id_t ity, unsigned num_ops,
                          const std::string &name, instruction *next)
-    : user(ty, num_ops, name), id_(ity) {
+    : user(ty, ity, num_ops, name) {
   if(next){
     basic_block *block = next->get_parent();
     assert(block && "Next instruction is not in a basic block!");
@@ -556,40 +556,40 @@ instruction* downcast_inst::create(value *arg, const std::string &name, instruct
 //                               matmul_inst classes
 //===----------------------------------------------------------------------===//
 
-dot_inst::dot_inst(value *A, value *B, value *C, TransT AT, TransT BT,
+dot_inst::dot_inst(value *A, value *B, value *C, TransT AT, TransT BT, bool allow_tf32,
                          const std::string &name, instruction *next)
-    : builtin_inst(C->get_type(), INST_DOT, 3, name, next) {
+    : builtin_inst(C->get_type(), INST_DOT, 3, name, next), allow_tf32_(allow_tf32) {
   set_operand(0, A);
   set_operand(1, B);
   set_operand(2, C);
 }
 
 instruction *dot_inst::create(value *A, value *B, value *C,
-                              bool AT, bool BT,
+                              bool AT, bool BT, bool allow_tf32,
                               const std::string &name, instruction *next) {
   TransT OPA = AT ? Trans : NoTrans;
   TransT OPB = BT ? Trans : NoTrans;
-  return new dot_inst(A, B, C, OPA, OPB, name, next);
+  return new dot_inst(A, B, C, OPA, OPB, allow_tf32, name, next);
 }
 
-instruction *dot_inst::create_nn(value *A, value *B, value *C,
+instruction *dot_inst::create_nn(value *A, value *B, value *C, bool allow_tf32,
                                  const std::string &name, instruction *next) {
-  return new dot_inst(A, B, C, NoTrans, NoTrans, name, next);
+  return new dot_inst(A, B, C, NoTrans, NoTrans, allow_tf32, name, next);
 }
 
-instruction *dot_inst::create_nt(value *A, value *B, value *C,
+instruction *dot_inst::create_nt(value *A, value *B, value *C, bool allow_tf32,
                                  const std::string &name, instruction *next) {
-  return new dot_inst(A, B, C, NoTrans, Trans, name, next);
+  return new dot_inst(A, B, C, NoTrans, Trans, allow_tf32, name, next);
 }
 
-instruction *dot_inst::create_tn(value *A, value *B, value *C,
+instruction *dot_inst::create_tn(value *A, value *B, value *C, bool allow_tf32,
                                  const std::string &name, instruction *next) {
-  return new dot_inst(A, B, C, Trans, NoTrans, name, next);
+  return new dot_inst(A, B, C, Trans, NoTrans, allow_tf32, name, next);
 }
 
-instruction *dot_inst::create_tt(value *A, value *B, value *C,
+instruction *dot_inst::create_tt(value *A, value *B, value *C, bool allow_tf32,
                                  const std::string &name, instruction *next) {
-  return new dot_inst(A, B, C, Trans, Trans, name, next);
+  return new dot_inst(A, B, C, Trans, Trans, allow_tf32, name, next);
 }
 
 //===----------------------------------------------------------------------===//
@@ -663,16 +663,23 @@ std::string reduce_inst::to_str(op_t op) {
     case FSUB: return "-";
     case FMAX: return "fmax";
     case FMIN: return "fmin";
+    case FLOGSUMEXP: return "logsumexp";
+    case ARGMAX: return "argimax";
+    case ARGMIN: return "argimin";
+    case ARGFMAX: return "argfmax";
+    case ARGFMIN: return "argfmin";
     default: break;
   }
   assert(false);
   return "";
 }
 
-type* reduce_inst::get_res_type(value *arg, unsigned axis) {
+type* reduce_inst::get_res_type(value *arg, op_t op, unsigned axis) {
   ir::block_type::block_shapes_t shapes = arg->get_type()->get_block_shapes();
   shapes.erase(shapes.begin() + axis);
   type *scalar_ty = arg->get_type()->get_scalar_ty();
+  if(is_arg_op(op))
+    scalar_ty = type::get_int32_ty(scalar_ty->get_context());
   if(shapes.empty())
 //    shapes.push_back(1);
     return scalar_ty;
@@ -680,7 +687,7 @@ type* reduce_inst::get_res_type(value *arg, unsigned axis) {
 }
 
 reduce_inst::reduce_inst(value *arg, op_t op, unsigned axis, const std::string &name, instruction *next)
-  : builtin_inst(get_res_type(arg, axis), INST_REDUCE, 1, name, next),
+  : builtin_inst(get_res_type(arg, op, axis), INST_REDUCE, 1, name, next),
     op_(op),
     axis_(axis){
   set_operand(0, arg);
@@ -691,6 +698,45 @@ instruction* reduce_inst::create(value *arg, op_t op, unsigned axis, const std::
 }
 
 
+//===----------------------------------------------------------------------===//
+//                               scan instructions
+//===----------------------------------------------------------------------===//
+
+scan_inst::scan_inst(value *arg, op_t op, unsigned axis, const std::string &name, instruction *next)
+  : builtin_inst(arg->get_type(), INST_SCAN, 1, name, next),
+    axis_(axis),
+    op_(op){
+  set_operand(0, arg);
+}
+
+instruction* scan_inst::create(value *arg, op_t op, unsigned axis, const std::string &name, instruction *next) {
+  return new scan_inst(arg, op, axis, name, next);
+}
+
+
+//===----------------------------------------------------------------------===//
+//                               sort instructions
+//===----------------------------------------------------------------------===//
+
+type* sort_inst::get_res_type(value *arg, unsigned axis, unsigned k) {
+  ir::block_type::block_shapes_t shapes = arg->get_type()->get_block_shapes();
+  shapes[axis] = k;
+  return block_type::get(arg->get_type()->get_scalar_ty(), shapes);
+}
+
+sort_inst::sort_inst(value *arg, unsigned axis, unsigned k, bool descending, const std::string &name, instruction *next)
+  : builtin_inst(get_res_type(arg, axis, k), INST_SORT, 1, name, next),
+    axis_(axis),
+    k_(k),
+    descending_(descending){
+  set_operand(0, arg);
+}
+
+instruction* sort_inst::create(value *arg, unsigned axis, unsigned k, bool descending, const std::string &name, instruction *next) {
+  return new sort_inst(arg, axis, k, descending, name, next);
+}
+
+
 //===----------------------------------------------------------------------===//
 //                               select instructions
 //===----------------------------------------------------------------------===//
@@ -5,6 +5,7 @@
 #include "triton/ir/type.h"
 #include "triton/ir/constant.h"
 #include "triton/ir/function.h"
+#include "triton/ir/instructions.h"
 
 namespace triton{
 namespace ir{
@@ -19,10 +20,37 @@ ir::builder& module::get_builder() {
   return builder_;
 }
 
+module *module::clone() {
+  module *res = new module(name_, builder_);
+  res->types_ = types_;
+  res->const_ = const_;
+  res->allocs_ = allocs_;
+  res->globals_ = globals_;
+  res->metadatas_ = metadatas_;
+  res->continue_fn_ = continue_fn_;
+  std::map<value*, value*> vmap;
+  for(function *fn: functions_){
+    function *new_fn = fn->clone(res, vmap);
+    vmap[fn] = new_fn;
+    if(symbols_.find(fn->get_name()) != symbols_.end())
+      res->symbols_[fn->get_name()] = new_fn;
+  }
+  // frontend lookup tables, so that a clone taken mid-generation stays usable
+  auto remap = [&](value *v) {
+    auto it = vmap.find(v);
+    return it == vmap.end() ? v : it->second;
+  };
+  for(auto &x: values_)
+    res->values_[val_key_t{x.first.first, (basic_block*)remap(x.first.second)}] = remap(x.second);
+  for(basic_block *block: sealed_blocks_)
+    res->sealed_blocks_.insert((basic_block*)remap(block));
+  return res;
+}
+
 void module::set_value(const std::string& name, ir::basic_block *block, ir::value *value){
   values_[val_key_t{name, block}] = value;
   auto it = metadatas_.find(name);
-  if(auto *x = dynamic_cast<ir::instruction*>(value))
+  if(auto *x = ir::dyn_cast_or_null<ir::instruction>(value))
   if(it != metadatas_.end()){
     x->set_metadata(it->second.first, it->second.second);
   }
@@ -30,6 +58,8 @@ void module::set_value(const std::string& name, ir::basic_block *block, ir::valu
 }
 
 void module::set_value(const std::string& name, ir::value *value){
+  if(value)
+    types_[name] = value->get_type();
   return set_value(name, builder_.get_insert_block(), value);
 }
 
@@ -71,7 +101,7 @@ ir::value *module::try_remove_trivial_phis(ir::phi_node *&phi){
   phi->erase_from_parent();
   std::set<ir::user*> users = phi->get_users();
   for(ir::user* u: users)
-  if(auto *uphi = dynamic_cast<ir::phi_node*>(u))
+  if(auto *uphi = ir::dyn_cast<ir::phi_node>(u))
     if(uphi != phi)
       try_remove_trivial_phis(uphi);
   return same;
@@ -107,10 +137,10 @@ ir::value *module::get_value_recursive(const std::string& name, ir::basic_block
     ir::phi_node* phi = make_phi(ty, 1, block);
     set_value(name, block, phi);
     result = add_phi_operands(name, phi);
-    if(auto *phi = dynamic_cast<ir::phi_node*>(result))
+    if(auto *phi = ir::dyn_cast<ir::phi_node>(result))
       result = try_remove_trivial_phis(phi);
   }
-  if(auto *phi = dynamic_cast<ir::phi_node*>(result)){
+  if(auto *phi = ir::dyn_cast<ir::phi_node>(result)){
     result = try_remove_trivial_phis(phi);
   }
   set_value(name, block, result);
@@ -150,6 +180,76 @@ void module::seal_block(ir::basic_block *block){
 }
 
 /* functions */
+std::vector<value*> module::inline_function(function *callee, const std::vector<value*> &args,
+                                            const std::vector<value*> &rets) {
+  if(args.size() != callee->args().size())
+    throw std::runtime_error("wrong number of arguments when inlining " + callee->get_name());
+  std::map<value*, value*> vmap;
+  for(size_t i = 0; i < args.size(); i++)
+    if(args[i])
+      vmap[callee->args()[i]] = args[i];
+  // the entry block is merged into the insertion block;
+  // the other blocks are appended to the caller
+  basic_block *current = builder_.get_insert_block();
+  std::vector<basic_block*> new_blocks;
+  for(basic_block *block: callee->blocks()){
+    basic_block *new_block = current;
+    if(block != callee->blocks().front()){
+      new_block = basic_block::create(block->get_context(), block->get_name(), current->get_parent());
+      new_blocks.push_back(new_block);
+    }
+    vmap[block] = new_block;
+  }
+  auto remap_block = [&](basic_block *block) {
+    return block ? (basic_block*)vmap.at(block) : nullptr;
+  };
+  for(basic_block *block: callee->blocks())
+  for(basic_block *pred: block->get_predecessors())
+    remap_block(block)->add_predecessor(remap_block(pred));
+  // instructions; operands are remapped in a second pass (see function::clone)
+  basic_block *exit = nullptr;
+  std::vector<instruction*> cloned;
+  for(basic_block *block: callee->blocks())
+  for(instruction *inst: block->get_inst_list()){
+    if(isa<return_inst>(inst)){
+      if(exit)
+        throw std::runtime_error("cannot inline " + callee->get_name() + ": multiple returns");
+      exit = remap_block(block);
+      continue;
+    }
+    instruction *new_inst = inst->clone();
+    basic_block *new_block = remap_block(block);
+    new_block->get_inst_list().push_back(new_inst);
+    new_inst->set_parent(new_block);
+    vmap[inst] = new_inst;
+    cloned.push_back(new_inst);
+  }
+  if(!exit)
+    throw std::runtime_error("cannot inline " + callee->get_name() + ": no return");
+  for(instruction *inst: cloned){
+    for(size_t i = 0; i < inst->ops().size(); i++){
+      value *op = inst->ops()[i];
+      if(!op)
+        continue;
+      auto it = vmap.find(op);
+      inst->set_operand(i, it == vmap.end() ? op : it->second);
+    }
+    if(auto *phi = dyn_cast<phi_node>(inst))
+    for(unsigned i = 0; i < phi->get_num_incoming(); i++)
+      phi->set_incoming_block(i, remap_block(phi->get_incoming_block(i)));
+  }
+  // all predecessors of the inlined blocks are known
+  for(basic_block *block: new_blocks)
+    seal_block(block);
+  builder_.set_insert_point(exit);
+  std::vector<value*> res;
+  for(value *ret: rets){
+    auto it = vmap.find(ret);
+    res.push_back(it == vmap.end() ? ret : it->second);
+  }
+  return res;
+}
+
 function *module::get_or_insert_function(const std::string &name, function_type *ty) {
   function *&fn = (function*&)symbols_[name];
   if(fn == nullptr)
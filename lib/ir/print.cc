@@ -126,7 +126,7 @@ void SlotTracker::create_function_slot(const value *v) {
 }
 
 int SlotTracker::get_local_slot(const value *v) {
-  assert(dynamic_cast<constant>(v) == nullptr && "Can't get a constant slot");
+  assert(!isa<constant>(v) && "Can't get a constant slot");
 
   // Check for uninitialized state and do lazy initialization.
   initialize_if_needed();
@@ -153,7 +153,7 @@ void AssemblyWriter::write_operand(const value *operand, bool print_type) {
     return;
   }
 
-  if (auto *c = dynamic_cast<const ir::constant*>(operand)) {
+  if (auto *c = ir::dyn_cast<ir::constant>(operand)) {
     os << c->repr();
     return;
   }
@@ -379,7 +379,7 @@ void print(module &mod, std::ostream& os) {
         if(num_ops > 0)
           os << " ";;
         for(unsigned i = 0; i < num_ops; i++){
-          if(auto *x = dynamic_cast<ir::constant*>(ops[i]))
+          if(auto *x = ir::dyn_cast<ir::constant>(ops[i]))
             os << x->repr();
           else
             os << get_name(ops[i], cnt++);
@@ -431,7 +431,7 @@ void print(instruction &instr, std::ostream &os) {
     if(num_ops > 0)
       os << " ";;
     for(unsigned i = 0; i < num_ops; i++){
-      if(auto *x = dynamic_cast<ir::constant*>(ops[i]))
+      if(auto *x = ir::dyn_cast<ir::constant>(ops[i]))
         os << x->repr();
       else
         os << ops[i]->get_name();
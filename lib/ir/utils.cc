@@ -43,6 +43,56 @@ std::vector<basic_block*> cfg::reverse_post_order(function* fn) {
   return result;
 }
 
+// Cooper, Harvey & Kennedy, "A Simple, Fast Dominance Algorithm"
+std::map<basic_block*, basic_block*> cfg::immediate_dominators(function* fn) {
+  std::vector<basic_block*> rpo = reverse_post_order(fn);
+  std::map<basic_block*, unsigned> order;
+  for(unsigned n = 0; n < rpo.size(); n++)
+    order[rpo[n]] = n;
+  std::map<basic_block*, basic_block*> idom;
+  for(basic_block* block: rpo)
+    if(block->get_predecessors().empty())
+      idom[block] = block;
+  auto intersect = [&](basic_block* a, basic_block* b) {
+    while(a != b){
+      while(order.at(a) > order.at(b)) a = idom.at(a);
+      while(order.at(b) > order.at(a)) b = idom.at(b);
+    }
+    return a;
+  };
+  bool changed = true;
+  while(changed){
+    changed = false;
+    for(basic_block* block: rpo){
+      if(block->get_predecessors().empty())
+        continue;
+      basic_block* new_idom = nullptr;
+      for(basic_block* pred: block->get_predecessors()){
+        if(idom.find(pred) == idom.end())
+          continue;
+        new_idom = new_idom ? intersect(pred, new_idom) : pred;
+      }
+      auto it = idom.find(block);
+      if(new_idom && (it == idom.end() || it->second != new_idom)){
+        idom[block] = new_idom;
+        changed = true;
+      }
+    }
+  }
+  for(auto& x: idom)
+    if(x.first == x.second)
+      x.second = nullptr;
+  return idom;
+}
+
+bool cfg::dominates(const std::map<basic_block*, basic_block*> &idom,
+                    basic_block* a, basic_block* b) {
+  for(; b; b = idom.at(b))
+    if(a == b)
+      return true;
+  return false;
+}
+
 void for_each_instruction(module &mod, const std::function<void (instruction *)> &do_work) {
   for(ir::function *fn: mod.get_function_list())
   for(ir::basic_block *block: cfg::reverse_post_order(fn))
@@ -12,7 +12,7 @@ class type;
 //                               value class
 //===----------------------------------------------------------------------===//
 
-value::value(type *ty, const std::string &name): ty_(ty){
+value::value(type *ty, value_id_t id, const std::string &name): id_(id), ty_(ty){
   set_name(name);
 }
 
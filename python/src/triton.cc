@@ -92,6 +92,28 @@ void init_triton_codegen(py::module &&m) {
         return std::make_tuple(mod, ker, shared_mem, ss.str());
       },
       py::return_value_policy::take_ownership);
+  m.def(
+      "estimate_registers", [](ir::module &ir, drv::device *dev, int num_warps, int num_stages) {
+        size_t shared_mem;
+        unsigned num_registers = triton::codegen::estimate_registers(ir, dev, num_warps, num_stages, shared_mem);
+        return std::make_tuple(num_registers, shared_mem);
+      });
+  // runs the passes once; the result gives the register estimate
+  // and can then be lowered to machine code
+  py::class_<triton::codegen::lowering>(m, "lowering")
+      .def(py::init<ir::module &, drv::device *, int, int, bool>(), py::keep_alive<1, 2>())
+      .def_property_readonly("num_registers", &triton::codegen::lowering::num_registers)
+      .def_property_readonly("shared_mem", &triton::codegen::lowering::shared_mem)
+      .def("emit_bin", [](triton::codegen::lowering *self, ir::module &ir) {
+        drv::module *mod;
+        drv::kernel *ker;
+        self->emit_bin(mod, ker);
+        std::stringstream ss;
+        ir::print(ir, ss);
+        return std::make_tuple(mod, ker, self->shared_mem(), ss.str());
+      },
+      py::return_value_policy::take_ownership)
+      .def("llir", &triton::codegen::lowering::llir);
 }
 
 /*****************************************************************************/
@@ -157,6 +179,17 @@ void init_triton_frontend(py::module &&m) {
   m.def("min", &ir::dispatch::min, ret::reference);
   m.def("max", &ir::dispatch::max, ret::reference);
   m.def("sum", &ir::dispatch::sum, ret::reference);
+  m.def("argmin", &ir::dispatch::argmin, ret::reference);
+  m.def("argmax", &ir::dispatch::argmax, ret::reference);
+  m.def("logsumexp", &ir::dispatch::logsumexp, ret::reference);
+  // scan
+  m.def("cumsum", &ir::dispatch::cumsum, ret::reference);
+  m.def("cumprod", &ir::dispatch::cumprod, ret::reference);
+  m.def("cummax", &ir::dispatch::cummax, ret::reference);
+  m.def("cummin", &ir::dispatch::cummin, ret::reference);
+  // sorting
+  m.def("sort", &ir::dispatch::sort, ret::reference);
+  m.def("topk", &ir::dispatch::topk, ret::reference);
   // math
   m.def("exp", &ir::dispatch::exp, ret::reference);
   m.def("log", &ir::dispatch::log, ret::reference);
@@ -167,6 +200,41 @@ void init_triton_frontend(py::module &&m) {
   m.def("multiple_of", &ir::dispatch::multiple_of, ret::reference);
   m.def("max_contiguous", &ir::dispatch::max_contiguous, ret::reference);
   m.def("debug_barrier", &ir::dispatch::debug_barrier, ret::reference);
+  // batched dispatch: emits a tape of operations recorded by the frontend in one call.
+  // Each entry is (opcode, *operands), where an operand is an ir.value, a Python
+  // constant, or a 1-tuple holding the index of an earlier entry of the tape.
+  // Returns the value, scalar type name and block shape of every entry.
+  m.attr("batched_ops") = ir::dispatch::batched_ops();
+  m.def("run_tape", [](py::list tape, ir::builder *builder) {
+    std::vector<ir::value *> values;
+    std::vector<std::tuple<ir::value *, std::string, ir::type::block_shapes_t>> ret;
+    std::vector<ir::value *> args;
+    for (py::handle entry : tape) {
+      py::tuple op = py::reinterpret_borrow<py::tuple>(entry);
+      args.clear();
+      for (size_t i = 1; i < op.size(); i++) {
+        py::handle x = op[i];
+        if (py::isinstance<py::tuple>(x))
+          args.push_back(values.at(py::reinterpret_borrow<py::tuple>(x)[0].cast<size_t>()));
+        else if (py::isinstance<py::bool_>(x))
+          args.push_back(builder->get_int1(x.cast<bool>()));
+        else if (py::isinstance<py::int_>(x))
+          args.push_back(builder->get_int32(x.cast<int>()));
+        else if (py::isinstance<py::float_>(x))
+          args.push_back(builder->get_float32(x.cast<float>()));
+        else
+          args.push_back(x.cast<ir::value *>());
+      }
+      ir::value *res = ir::dispatch::batched(op[0].cast<unsigned>(), args, builder);
+      ir::type *ty = res->get_type();
+      ir::type::block_shapes_t shape;
+      if (ty->is_block_ty())
+        shape = ty->get_block_shapes();
+      values.push_back(res);
+      ret.push_back(std::make_tuple(res, ty->get_scalar_ty()->repr(), shape));
+    }
+    return ret;
+  }, ret::reference);
 }
 
 /*****************************************************************************/
@@ -183,6 +251,15 @@ void init_triton_ir(py::module &&m) {
   auto value = py::class_<ir::value>(m, "value");
   value.def_property("name", &ir::value::get_name, &ir::value::set_name);
   value.def_property_readonly("type", &ir::value::get_type);
+  // scalar type name and block shape in one call, so that wrapping the result
+  // of a frontend operation does not need several round-trips through pybind
+  value.def_property_readonly("type_info", [](ir::value *self) {
+    ir::type *ty = self->get_type();
+    ir::type::block_shapes_t shape;
+    if (ty->is_block_ty())
+      shape = ty->get_block_shapes();
+    return std::make_tuple(ty->get_scalar_ty()->repr(), shape);
+  });
 
   py::class_<ir::user, ir::value>(m, "user");
 
@@ -193,7 +270,8 @@ void init_triton_ir(py::module &&m) {
 
   py::class_<ir::constant_int, ir::constant>(m, "constant_int")
       .def_property_readonly("value", &ir::constant_int::get_value)
-      .def("__int__", [](ir::constant_int *self) { return self->get_value(); });
+      .def("__int__", [](ir::constant_int *self) { return self->get_value(); })
+      .def("__bool__", [](ir::constant_int *self) { return self->get_value() != 0; });
 
   py::class_<ir::constant_fp, ir::constant>(m, "constant_float")
       .def_property_readonly("value", &ir::constant_fp::get_value);
@@ -248,8 +326,10 @@ void init_triton_ir(py::module &&m) {
 
   py::class_<ir::module>(m, "module")
       .def(py::init<std::string, ir::builder &>())
+      .def("clone", &ir::module::clone, ret::take_ownership, py::keep_alive<0, 1>())
       .def("get_or_insert_function", &ir::module::get_or_insert_function, ret::reference)
       .def("seal_block", &ir::module::seal_block)
+      .def("inline_function", &ir::module::inline_function, ret::reference)
       .def("set_value", (void (ir::module::*)(const std::string &, ir::value *)) & ir::module::set_value)
       .def("set_type", &ir::module::set_type)
       .def("get_value", (ir::value * (ir::module::*)(const std::string &)) & ir::module::get_value, ret::reference)
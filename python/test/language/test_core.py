@@ -303,6 +303,69 @@ def test_atomic_rmw(op, dtype_x, mode, device='cuda'):
         triton.testing.assert_almost_equal(z_ref, z_tri)
 
 
+@pytest.mark.parametrize("op, dtype_x, axis", [
+    (op, dtype_x, axis)
+    for op in ['add', 'max', 'min']
+    for dtype_x in ['int32', 'float32']
+    for axis in [0, 1, None]] + [('add', 'float16', axis) for axis in [0, 1, None]])
+def test_atomic_rmw_broadcast(op, dtype_x, axis, device='cuda'):
+    M, N = 32, 64
+    dtype_x = cvt[dtype_x]
+
+    # triton kernel
+    @triton.jit
+    def kernel(X, Z, **meta):
+        rm = tl.arange(0, meta['M'])
+        rn = tl.arange(0, meta['N'])
+        x = tl.load(X + rm[:, None] * meta['N'] + rn[None, :])
+        zero = tl.zeros([meta['M'], meta['N']], dtype=tl.int32)
+        mask = (rm[:, None] + rn[None, :]) % 3 != 0
+        GENERATE_TEST_HERE
+
+    # destinations only depend on the axes that are not reduced
+    off = {0: 'rn[None, :] + zero', 1: 'rm[:, None] + zero', None: 'zero'}[axis]
+    kernel = patch_kernel(kernel, {'GENERATE_TEST_HERE': f'tl.atomic_{op}(Z + {off}, x, mask=mask)'})
+    max_neutral = float('-inf') if dtype_x.is_floating_point else torch.iinfo(dtype_x).min
+    min_neutral = float('inf') if dtype_x.is_floating_point else torch.iinfo(dtype_x).max
+    neutral = {'add': 0, 'max': max_neutral, 'min': min_neutral}[op]
+    # triton result
+    x_tri = triton.testing.random((M, N), dtype=dtype_x, device=device)
+    z_tri = torch.empty({0: N, 1: M, None: 1}[axis], dtype=dtype_x, device=device)
+    z_tri.fill_(neutral)
+    kernel[(1, )](x_tri, z_tri, M=M, N=N)
+    # torch result
+    rm = torch.arange(M, device=device)[:, None]
+    rn = torch.arange(N, device=device)[None, :]
+    x_ref = torch.where((rm + rn) % 3 != 0, x_tri, torch.full_like(x_tri, neutral))
+    torch_op = {'add': torch.sum, 'max': torch.amax, 'min': torch.amin}[op]
+    z_ref = torch_op(x_ref, dim=(0, 1) if axis is None else axis).reshape(-1).to(dtype_x)
+    # compare
+    if dtype_x == torch.float16:
+        triton.testing.assert_allclose(z_ref, z_tri)
+    elif op == 'add':
+        triton.testing.assert_almost_equal(z_ref, z_tri)
+    else:
+        assert (z_ref == z_tri).all()
+
+
+@pytest.mark.parametrize("axis", [0, 1, None])
+def test_atomic_rmw_broadcast_host(axis):
+    M, N = 32, 64
+    # CPU targets issue one atomic per destination
+    @triton.jit
+    def kernel(X, Z, **meta):
+        rm = tl.arange(0, meta['M'])
+        rn = tl.arange(0, meta['N'])
+        x = tl.load(X + rm[:, None] * meta['N'] + rn[None, :])
+        zero = tl.zeros([meta['M'], meta['N']], dtype=tl.int32)
+        GENERATE_TEST_HERE
+    off = {0: 'rn[None, :] + zero', 1: 'rm[:, None] + zero', None: 'zero'}[axis]
+    kernel = patch_kernel(kernel, {'GENERATE_TEST_HERE': f'tl.atomic_add(Z + {off}, x)'})
+    x = torch.empty((M, N), dtype=torch.int32)
+    llir = kernel._init_kernel().host_llir(x, x, M=M, N=N)
+    assert llir.count('atomicrmw') == {0: N, 1: M, None: 1}[axis]
+
+
 # ---------------
 # test cast
 # ---------------
@@ -337,6 +400,90 @@ def test_cast(dtype_x, dtype_z, bitcast, device='cuda'):
         z_ref = x.to(z_tri.dtype)
     assert z_tri == z_ref
 
+
+@pytest.mark.parametrize("dtype", ['float16', 'float32'])
+def test_f8_roundtrip(dtype, device='cuda'):
+    # all fp8 values
+    f8 = torch.arange(-128, 128, dtype=torch.int8, device=device)
+    # triton kernel
+    @triton.jit
+    def kernel(X, Y, Z, N, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        x = tl.load(X + off, mask=off < N)
+        y = x.to(Y.dtype.element_ty)
+        tl.store(Y + off, y, mask=off < N)
+        tl.store(Z + off, y.to(tl.float8), mask=off < N)
+    y = torch.empty(f8.shape, dtype=cvt[dtype], device=device)
+    z = torch.empty_like(f8)
+    kernel[(1, )](triton.reinterpret(f8, tl.float8), y, triton.reinterpret(z, tl.float8), f8.numel(), BLOCK=256)
+    # fp8 are the sign, exponent and top mantissa bits of an fp16
+    bits = f8.to(torch.int32) & 0xff
+    f16_ref = (((bits & 0x80) << 8) | ((bits & 0x7f) << 7)).to(torch.int16).view(torch.float16)
+    assert (y.to(torch.float16).view(torch.int16) == f16_ref.view(torch.int16)).all()
+    assert (z == f8).all()
+
+
+def test_f8_rounding(device='cuda'):
+    # fp32 values at and next to the halfway points between consecutive
+    # positive fp8 values; the ones next to them must not tie
+    k = torch.arange(0, 127, dtype=torch.int32, device=device)
+    f8_to_f32 = lambda bits: (bits << 7).to(torch.int16).view(torch.float16).float()
+    lo, hi = f8_to_f32(k), f8_to_f32(k + 1)
+    mid = (lo + hi) / 2
+    x = torch.cat([mid, torch.nextafter(mid, hi), torch.nextafter(mid, lo)])
+    ref = torch.cat([k + (k & 1), k + 1, k])
+    x, ref = torch.cat([x, -x]), torch.cat([ref, ref | 0x80])
+    # triton kernel
+    @triton.jit
+    def kernel(X, Z, N, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        x = tl.load(X + off, mask=off < N)
+        tl.store(Z + off, x.to(tl.float8), mask=off < N)
+    z = torch.empty(x.shape, dtype=torch.int8, device=device)
+    kernel[(1, )](x, triton.reinterpret(z, tl.float8), x.numel(), BLOCK=1024)
+    assert ((z.to(torch.int32) & 0xff) == ref).all()
+
+
+def test_f8_host():
+    # conversions lower to plain vector operations on CPU targets
+    @triton.jit
+    def kernel(X, Y, Z, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        tl.store(Y + off, tl.load(X + off).to(tl.float8))
+        tl.store(Z + off, tl.load(Y + off).to(tl.float32))
+    x = torch.empty((128, ), dtype=torch.float32)
+    y = torch.empty((128, ), dtype=torch.int8)
+    llir = kernel._init_kernel().host_llir(x, triton.reinterpret(y, tl.float8), x, BLOCK=128)
+    assert 'asm' not in llir
+    # fp32 -> fp16 is rounded to odd before fp16 -> fp8
+    assert 'fcmp une' in llir
+
+
+def test_bf16_roundtrip(device='cuda'):
+    # all bf16 values
+    bf16 = torch.arange(-32768, 32768, dtype=torch.int32, device=device).to(torch.int16).view(torch.bfloat16)
+    # triton kernel
+    @triton.jit
+    def kernel(X, Y, Z, N, **meta):
+        off = tl.program_id(0) * meta['BLOCK'] + tl.arange(0, meta['BLOCK'])
+        x = tl.load(X + off, mask=off < N)
+        y = x.to(tl.float32)
+        tl.store(Y + off, y, mask=off < N)
+        tl.store(Z + off, y.to(tl.bfloat16), mask=off < N)
+    y = torch.empty(bf16.shape, dtype=torch.float32, device=device)
+    z = torch.empty_like(bf16)
+    kernel[(bf16.numel() // 1024, )](bf16, y, z, bf16.numel(), BLOCK=1024)
+    nan = torch.isnan(bf16)
+    assert (torch.isnan(y) == nan).all() and (torch.isnan(z) == nan).all()
+    assert (y[~nan] == bf16[~nan].float()).all()
+    assert (z.view(torch.int16)[~nan] == bf16.view(torch.int16)[~nan]).all()
+    # fp32 -> bf16 rounds to nearest even
+    x = torch.randn(4096, dtype=torch.float32, device=device)
+    y = torch.empty_like(x)
+    z = torch.empty(x.shape, dtype=torch.bfloat16, device=device)
+    kernel[(x.numel() // 1024, )](x, y, z, x.numel(), BLOCK=1024)
+    assert (z.view(torch.int16) == x.to(torch.bfloat16).view(torch.int16)).all()
+
 # ---------------
 # test reduce
 # ---------------
@@ -387,6 +534,281 @@ def test_reduce2d(dtype, shape, axis, device='cuda'):
     # compare
     triton.testing.assert_almost_equal(z_tri, z_ref)
 
+@pytest.mark.parametrize("shape, axis, num_warps, max_barriers",
+  [((1024,), 0, 1, 0),
+   ((1024,), 0, 4, 1),
+   ((32, 32), 1, 4, 0),
+   ((32, 32), 0, 4, 1)])
+def test_reduce_barriers(shape, axis, num_warps, max_barriers, device='cuda'):
+    # triton kernels
+    @triton.jit
+    def kernel1d(X, Z, **meta):
+        x = tl.load(X + tl.arange(0, meta['BLOCK_N']))
+        tl.store(Z, tl.sum(x, axis=0))
+
+    @triton.jit
+    def kernel2d(X, Z, **meta):
+        range_m = tl.arange(0, meta['BLOCK_M'])
+        range_n = tl.arange(0, meta['BLOCK_N'])
+        x = tl.load(X + range_m[:, None]*meta['BLOCK_N'] + range_n[None, :])
+        tl.store(Z + tl.arange(0, meta['BLOCK_Z']), tl.sum(x, axis=meta['AXIS']))
+    x = triton.testing.random(shape, dtype=torch.float32, device=device)
+    z_ref = torch.sum(x, axis=axis).reshape(-1)
+    # triton result
+    z_tri = torch.empty_like(z_ref)
+    if len(shape) == 1:
+        binary = kernel1d[(1,)](x, z_tri, BLOCK_N=shape[0], num_warps=num_warps)
+    else:
+        binary = kernel2d[(1,)](x, z_tri, BLOCK_M=shape[0], BLOCK_N=shape[1], BLOCK_Z=z_ref.shape[0],
+                                AXIS=axis, num_warps=num_warps)
+    triton.testing.assert_almost_equal(z_tri, z_ref)
+    # warps only synchronize when the reduced axis spans several of them
+    assert binary.asm('llir').count('call void @llvm.nvvm.barrier0') <= max_barriers
+
+
+@pytest.mark.parametrize("shape", [(2, 1024), (8, 512)])
+def test_fused_reduce(shape, device='cuda'):
+    # triton kernel
+    @triton.jit
+    def kernel(X, Mean, Var, **meta):
+        range_m = tl.arange(0, meta['BLOCK_M'])
+        range_n = tl.arange(0, meta['BLOCK_N'])
+        x = tl.load(X + range_m[:, None]*meta['BLOCK_N'] + range_n[None, :])
+        mean = tl.sum(x, axis=1) / meta['BLOCK_N']
+        var = tl.sum(x*x, axis=1) / meta['BLOCK_N'] - mean*mean
+        tl.store(Mean + range_m, mean)
+        tl.store(Var + range_m, var)
+    x = triton.testing.random(shape, dtype=torch.float32, device=device)
+    # triton result
+    mean_tri = torch.empty((shape[0],), dtype=torch.float32, device=device)
+    var_tri = torch.empty_like(mean_tri)
+    binary = kernel[(1,)](x, mean_tri, var_tri, BLOCK_M=shape[0], BLOCK_N=shape[1], num_warps=4)
+    # torch result
+    triton.testing.assert_almost_equal(mean_tri, torch.mean(x, axis=1))
+    triton.testing.assert_almost_equal(var_tri, torch.var(x, axis=1, unbiased=False))
+    # both sums share a single round of shared memory
+    assert binary.asm('llir').count('call void @llvm.nvvm.barrier0') <= 1
+
+
+@pytest.mark.parametrize("shape, dtype", [(shape, dtype) \
+        for shape in [(2, 1024), (8, 512), (32, 32)]\
+        for dtype in ['float16', 'float32']])
+def test_logsumexp(shape, dtype, device='cuda'):
+    # online softmax: max and sum of exponentials in a single reduction tree
+    @triton.jit
+    def kernel(X, LSE, Z, **meta):
+        range_m = tl.arange(0, meta['BLOCK_M'])
+        range_n = tl.arange(0, meta['BLOCK_N'])
+        off = range_m[:, None]*meta['BLOCK_N'] + range_n[None, :]
+        x = tl.load(X + off)
+        # masked out entries do not contribute
+        x = tl.where(range_n[None, :] % 3 == 0, float('-inf'), x)
+        lse = tl.logsumexp(x, axis=1)
+        tl.store(LSE + range_m, lse)
+        tl.store(Z + off, tl.exp(x - lse[:, None]))
+    x = triton.testing.random(shape, dtype=cvt[dtype], device=device)
+    # triton result
+    lse_tri = torch.empty((shape[0],), dtype=torch.float32, device=device)
+    z_tri = torch.empty(shape, dtype=torch.float32, device=device)
+    binary = kernel[(1,)](x, lse_tri, z_tri, BLOCK_M=shape[0], BLOCK_N=shape[1], num_warps=4)
+    # torch result
+    x_ref = x.float()
+    x_ref[:, ::3] = float('-inf')
+    triton.testing.assert_almost_equal(lse_tri, torch.logsumexp(x_ref, axis=1))
+    triton.testing.assert_almost_equal(z_tri, torch.softmax(x_ref, axis=1))
+    assert binary.asm('llir').count('call void @llvm.nvvm.barrier0') <= 1
+
+
+def _first_arg_extremum(x, op, axis):
+    x = x.float() if op == 'argmax' else -x.float()
+    # torch returns the index of the first extremum for boolean masks
+    return (x == x.max(dim=axis, keepdim=True)[0]).int().argmax(dim=axis).int()
+
+
+@pytest.mark.parametrize("op, dtype, shape",
+  [(op, dtype, shape) \
+        for op in ['argmin', 'argmax']\
+        for dtype in ['int32', 'float16', 'float32']\
+        for shape in [128, 512]])
+def test_arg_reduce1d(op, dtype, shape, device='cuda'):
+    dtype = cvt[dtype]
+    # triton kernel
+    @triton.jit
+    def kernel(X, Z, **meta):
+        x = tl.load(X + tl.arange(0, meta['BLOCK']))
+        tl.store(Z, GENERATE_TEST_HERE)
+    kernel = patch_kernel(kernel, {'GENERATE_TEST_HERE': f'tl.{op}(x, axis=0)'})
+    # few distinct values, so that ties are common
+    x = torch.randint(-8, 8, (shape,), device=device).to(dtype)
+    # triton result
+    z_tri = torch.empty((1,), dtype=torch.int32, device=device)
+    kernel[(1,)](x, z_tri, BLOCK=shape)
+    # compare
+    assert (z_tri == _first_arg_extremum(x, op, 0)).all()
+
+
+@pytest.mark.parametrize("op, shape, axis",
+  [(op, shape, axis) \
+        for op in ['argmin', 'argmax']\
+        for shape, axis in [((4, 1024), 1), ((64, 32), 0)]])
+def test_arg_reduce2d(op, shape, axis, device='cuda'):
+    # triton kernel
+    @triton.jit
+    def kernel(X, Z, **meta):
+        range_m = tl.arange(0, meta['BLOCK_M'])
+        range_n = tl.arange(0, meta['BLOCK_N'])
+        x = tl.load(X + range_m[:, None]*meta['BLOCK_N'] + range_n[None, :])
+        z = GENERATE_TEST_HERE
+        tl.store(Z + tl.arange(0, meta['BLOCK_Z']), z)
+    kernel = patch_kernel(kernel, {'GENERATE_TEST_HERE': f'tl.{op}(x, axis=meta["AXIS"])'})
+    x = torch.randint(-8, 8, shape, device=device).to(torch.float32)
+    # triton result
+    z_tri = torch.empty((shape[1 - axis],), dtype=torch.int32, device=device)
+    kernel[(1,)](x, z_tri, BLOCK_M=shape[0], BLOCK_N=shape[1], BLOCK_Z=shape[1 - axis], AXIS=axis)
+    # compare
+    assert (z_tri == _first_arg_extremum(x, op, axis)).all()
+
+# ---------------
+# test scan
+# ---------------
+@pytest.mark.parametrize("op, dtype, shape",
+  [(op, dtype, shape) \
+        for op in ['cumsum', 'cummax']\
+        for dtype in ['int32', 'float32']\
+        for shape in [32, 128, 1024, 4096]] +
+  [(op, 'int64', 128) for op in ['cumsum', 'cummax', 'cummin']])
+def test_scan1d(op, dtype, shape, device='cuda'):
+    dtype = cvt[dtype]
+    # triton kernel
+    @triton.jit
+    def kernel(X, Z, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        x = tl.load(X + off)
+        tl.store(Z + off, GENERATE_TEST_HERE)
+    kernel = patch_kernel(kernel, {'GENERATE_TEST_HERE': f'tl.{op}(x, axis=0)'})
+    x = triton.testing.random((shape,), dtype=dtype, device=device)
+    if dtype is torch.int64:
+        # outside of the int32 range, where int32 neutrals are not neutral
+        x = torch.randint(2**33, 2**40, (shape,), dtype=dtype, device=device)
+        x = -x if op == 'cummax' else x
+    # triton result
+    z_tri = torch.empty_like(x)
+    kernel[(1,)](x, z_tri, BLOCK=shape)
+    # torch result
+    z_ref = {'cumsum': lambda x: torch.cumsum(x, 0),
+             'cummax': lambda x: torch.cummax(x, 0)[0],
+             'cummin': lambda x: torch.cummin(x, 0)[0]}[op](x)
+    # compare
+    triton.testing.assert_almost_equal(z_tri, z_ref.to(dtype))
+
+
+@pytest.mark.parametrize("shape, axis",
+  [(shape, axis) \
+        for shape in [(8, 256), (64, 64), (256, 8)]\
+        for axis in [0, 1]])
+def test_scan2d(shape, axis, device='cuda'):
+    # triton kernel
+    @triton.jit
+    def kernel(X, Z, **meta):
+        range_m = tl.arange(0, meta['BLOCK_M'])
+        range_n = tl.arange(0, meta['BLOCK_N'])
+        off = range_m[:, None]*meta['BLOCK_N'] + range_n[None, :]
+        x = tl.load(X + off)
+        tl.store(Z + off, tl.cumsum(x, axis=meta['AXIS']))
+    x = triton.testing.random(shape, dtype=torch.int32, device=device)
+    # triton result
+    z_tri = torch.empty_like(x)
+    kernel[(1,)](x, z_tri, BLOCK_M=shape[0], BLOCK_N=shape[1], AXIS=axis)
+    # torch result
+    z_ref = torch.cumsum(x, axis).to(torch.int32)
+    # compare
+    assert (z_tri == z_ref).all()
+
+# ---------------
+# test sort
+# ---------------
+@pytest.mark.parametrize("dtype, shape, descending",
+  [(dtype, shape, descending) \
+        for dtype in ['int32', 'float32']\
+        for shape in [32, 128, 1024, 4096]\
+        for descending in [False, True]])
+def test_sort1d(dtype, shape, descending, device='cuda'):
+    dtype = cvt[dtype]
+    # triton kernel
+    @triton.jit
+    def kernel(X, Z, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        x = tl.load(X + off)
+        tl.store(Z + off, tl.sort(x, 0, descending=meta['DESCENDING']))
+    x = triton.testing.random((shape,), dtype=dtype, device=device)
+    # triton result
+    z_tri = torch.empty_like(x)
+    kernel[(1,)](x, z_tri, BLOCK=shape, DESCENDING=descending)
+    # torch result
+    z_ref = torch.sort(x, descending=descending)[0]
+    # compare
+    assert (z_tri == z_ref).all()
+
+
+@pytest.mark.parametrize("shape, axis",
+  [(shape, axis) \
+        for shape in [(8, 256), (64, 64), (256, 8)]\
+        for axis in [0, 1]])
+def test_sort2d(shape, axis, device='cuda'):
+    # triton kernel
+    @triton.jit
+    def kernel(X, Z, **meta):
+        range_m = tl.arange(0, meta['BLOCK_M'])
+        range_n = tl.arange(0, meta['BLOCK_N'])
+        off = range_m[:, None]*meta['BLOCK_N'] + range_n[None, :]
+        x = tl.load(X + off)
+        tl.store(Z + off, tl.sort(x, meta['AXIS']))
+    x = triton.testing.random(shape, dtype=torch.float32, device=device)
+    # triton result
+    z_tri = torch.empty_like(x)
+    kernel[(1,)](x, z_tri, BLOCK_M=shape[0], BLOCK_N=shape[1], AXIS=axis)
+    # torch result
+    z_ref = torch.sort(x, axis)[0]
+    # compare
+    assert (z_tri == z_ref).all()
+
+
+@pytest.mark.parametrize("shape, k",
+  [(shape, k) \
+        for shape in [128, 1024]\
+        for k in [1, 8, 64]])
+def test_topk(shape, k, device='cuda'):
+    # triton kernel
+    @triton.jit
+    def kernel(X, Z, **meta):
+        x = tl.load(X + tl.arange(0, meta['BLOCK']))
+        tl.store(Z + tl.arange(0, meta['K']), tl.topk(x, meta['K'], 0))
+    x = triton.testing.random((shape,), dtype=torch.float32, device=device)
+    # triton result
+    z_tri = torch.empty((k,), dtype=x.dtype, device=device)
+    kernel[(1,)](x, z_tri, BLOCK=shape, K=k)
+    # torch result
+    z_ref = torch.topk(x, k)[0]
+    # compare
+    assert (z_tri == z_ref).all()
+
+
+@pytest.mark.parametrize("op", ['sort', 'topk'])
+def test_sort_host(op):
+    # CPU targets run the whole network in registers
+    @triton.jit
+    def kernel(X, Z, **meta):
+        x = tl.load(X + tl.arange(0, meta['BLOCK']))
+        GENERATE_TEST_HERE
+    kernel = patch_kernel(kernel, {'GENERATE_TEST_HERE': {
+        'sort': "tl.store(Z + tl.arange(0, meta['BLOCK']), tl.sort(x, 0))",
+        'topk': "tl.store(Z + tl.arange(0, meta['K']), tl.topk(x, meta['K'], 0))"}[op]})
+    x = torch.empty((1024, ), dtype=torch.float32)
+    llir = kernel._init_kernel().host_llir(x, x, BLOCK=1024, K=8)
+    assert 'fcmp olt' in llir
+    assert 'addrspace(3)' not in llir
+    assert 'shfl' not in llir
+
 # ---------------
 # test permute
 # ---------------
@@ -492,14 +914,393 @@ def test_dot(epilogue, device='cuda'):
     assert 'st.global.v4' in ptx
 
 
+@pytest.mark.parametrize("M, N, K, trans_b",
+  [(M, N, K, trans_b) \
+        for M, N, K in [(64, 64, 64), (128, 64, 32), (16, 16, 8)]\
+        for trans_b in [False, True]])
+def test_dot_int8(M, N, K, trans_b, device='cuda'):
+    # triton kernel
+    @triton.jit
+    def kernel(X, stride_xm, stride_xk,
+               Y, stride_yk, stride_yn,
+               Z, stride_zm, stride_zn, **meta):
+        off_m = tl.arange(0, meta['BLOCK_M'])
+        off_n = tl.arange(0, meta['BLOCK_N'])
+        off_k = tl.arange(0, meta['BLOCK_K'])
+        Xs = X + off_m[:, None] * stride_xm + off_k[None, :] * stride_xk
+        Ys = Y + off_k[:, None] * stride_yk + off_n[None, :] * stride_yn
+        Zs = Z + off_m[:, None] * stride_zm + off_n[None, :] * stride_zn
+        tl.store(Zs, tl.dot(tl.load(Xs), tl.load(Ys)))
+    # input
+    x = torch.randint(-128, 128, (M, K), dtype=torch.int8, device=device)
+    y = torch.randint(-128, 128, (N, K) if trans_b else (K, N), dtype=torch.int8, device=device)
+    y = y.t() if trans_b else y
+    # triton result
+    z_tri = torch.empty((M, N), dtype=torch.int32, device=device)
+    pgm = kernel[(1, 1)](x, x.stride(0), x.stride(1),
+                         y, y.stride(0), y.stride(1),
+                         z_tri, z_tri.stride(0), z_tri.stride(1),
+                         BLOCK_M=M, BLOCK_K=K, BLOCK_N=N)
+    # torch result
+    z_ref = torch.matmul(x.cpu().long(), y.cpu().long()).to(torch.int32)
+    # compare
+    assert (z_tri.cpu() == z_ref).all()
+    # make sure the expected instructions are used
+    ptx = pgm.asm('ptx')
+    cc = torch.cuda.get_device_capability(device)
+    if K % 32 == 0 and cc >= (8, 0):
+        assert 'mma.sync.aligned.m16n8k32.row.col.s32.s8.s8.s32' in ptx
+    elif K % 32 == 0 and cc >= (7, 5):
+        assert 'mma.sync.aligned.m8n8k16.row.col.s32.s8.s8.s32' in ptx
+    else:
+        assert 'dp4a.s32.s32' in ptx
+
+
+@pytest.mark.parametrize("dtype, allow_tf32, trans_a",
+  [(dtype, allow_tf32, trans_a) \
+        for dtype, allow_tf32 in [('float32', False), ('float32', True), ('bfloat16', False)]\
+        for trans_a in [False, True]])
+def test_dot_precision(dtype, allow_tf32, trans_a, device='cuda'):
+    if torch.cuda.get_device_capability(device) < (8, 0):
+        pytest.skip("tf32 and bf16 tensor cores require sm_80")
+    torch.manual_seed(0)
+    # triton kernel
+    @triton.jit
+    def kernel(X, stride_xm, stride_xk,
+               Y, stride_yk, stride_yn,
+               Z, stride_zm, stride_zn, **meta):
+        off_m = tl.arange(0, meta['BLOCK_M'])
+        off_n = tl.arange(0, meta['BLOCK_N'])
+        off_k = tl.arange(0, meta['BLOCK_K'])
+        Xs = X + off_m[:, None] * stride_xm + off_k[None, :] * stride_xk
+        Ys = Y + off_k[:, None] * stride_yk + off_n[None, :] * stride_yn
+        Zs = Z + off_m[:, None] * stride_zm + off_n[None, :] * stride_zn
+        tl.store(Zs, tl.dot(tl.load(Xs), tl.load(Ys), allow_tf32=meta['ALLOW_TF32']))
+    # input
+    M, N, K = 64, 64, 32
+    dtype = cvt[dtype]
+    x = triton.testing.random((K, M) if trans_a else (M, K), dtype=dtype, device=device)
+    x = x.t() if trans_a else x
+    y = triton.testing.random((K, N), dtype=dtype, device=device)
+    # triton result
+    z_tri = torch.empty((M, N), dtype=torch.float32, device=device)
+    pgm = kernel[(1, 1)](x, x.stride(0), x.stride(1),
+                         y, y.stride(0), y.stride(1),
+                         z_tri, z_tri.stride(0), z_tri.stride(1),
+                         BLOCK_M=M, BLOCK_K=K, BLOCK_N=N, ALLOW_TF32=allow_tf32)
+    # torch result
+    z_ref = torch.matmul(x.float(), y.float())
+    # compare
+    if dtype == torch.float32 and not allow_tf32:
+        triton.testing.assert_almost_equal(z_tri, z_ref)
+    else:
+        assert torch.allclose(z_tri, z_ref, atol=1e-1, rtol=1e-2)
+    # make sure the requested precision is used
+    ptx = pgm.asm('ptx')
+    if dtype == torch.bfloat16:
+        assert 'mma.sync.aligned.m16n8k16.row.col.f32.bf16.bf16.f32' in ptx
+    elif allow_tf32:
+        assert 'mma.sync.aligned.m16n8k8.row.col.f32.tf32.tf32.f32' in ptx
+    else:
+        assert 'mma.sync' not in ptx
+
+
+# ---------------
+# test jit
+# ---------------
+
+def test_parse_cache():
+    @triton.jit
+    def kernel(X, **meta):
+        x = tl.load(X)
+        tl.store(X, GENERATE_TEST_HERE)
+
+    tree = kernel.parse()
+    assert kernel.parse() is tree
+    # patching the source must invalidate the cached AST
+    kernel = patch_kernel(kernel, {'GENERATE_TEST_HERE': 'x + 1'})
+    assert kernel.parse() is not tree
+    store = kernel.parse().body[0].body[1].value
+    assert isinstance(store.args[1], ast.BinOp)
+
+
+def test_jit_callee(monkeypatch, device='cuda'):
+    @triton.jit
+    def double_n(x, n):
+        y = x
+        for i in range(n):
+            y = y * 2
+        return y, x
+
+    @triton.jit
+    def kernel(X, Y, Z, n, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        x = tl.load(X + off)
+        y, _ = double_n(x, n)
+        z, _ = double_n(y, n)
+        z, w = double_n(z, 1)
+        tl.store(Y + off, y)
+        tl.store(Z + off, z + w)
+
+    # helpers are compiled once per signature, not once per call site
+    compiled = []
+    compile_callee = triton.code_gen.JITFunction._compile_callee
+    def count(self, args, generator):
+        compiled.append(self)
+        return compile_callee(self, args, generator)
+    monkeypatch.setattr(triton.code_gen.JITFunction, '_compile_callee', count)
+    x = torch.randn(128, device=device)
+    y = torch.empty_like(x)
+    z = torch.empty_like(x)
+    kernel[(1, )](x, y, z, 3, BLOCK=128)
+    assert len(compiled) == 2
+    triton.testing.assert_allclose(y, x * 8)
+    triton.testing.assert_allclose(z, x * 64 * 2 + x * 64)
+
+
+def test_tape(monkeypatch, device='cuda'):
+    @triton.jit
+    def kernel(X, Y, Z, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        x = tl.load(X + off)
+        y = tl.load(Y + off)
+        z = tl.where(x > 0, x * 2 + y, -y)
+        tl.store(Z + off, z)
+
+    # element-wise operations of a statement are emitted in one call
+    tapes = []
+    run_tape = tl.core.frontend.run_tape
+    def record(tape, builder):
+        tapes.append([entry[0] for entry in tape])
+        return run_tape(tape, builder)
+    monkeypatch.setattr(tl.core.frontend, 'run_tape', record)
+    x = torch.randn(128, device=device)
+    y = torch.randn(128, device=device)
+    z = torch.empty_like(x)
+    kernel[(1, )](x, y, z, BLOCK=128)
+    opcodes = tl.core._Tape.opcodes
+    assert [opcodes[op] for op in ['greater_than', 'mul', 'add', 'minus', 'where']] in tapes
+    triton.testing.assert_allclose(z, torch.where(x > 0, x * 2 + y, -y))
+
+
+def test_tape_error(device='cuda'):
+    @triton.jit
+    def kernel(X, Z, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        x = tl.load(X + off)
+        z = x + 1 + GENERATE_TEST_HERE * 2
+        tl.store(Z + off, z)
+
+    x = torch.randn(128, device=device)
+    z = torch.empty_like(x)
+    # the error is reported at the failing sub-expression
+    bad = patch_kernel(kernel, {'GENERATE_TEST_HERE': '(x & 1.0)'})
+    with pytest.raises(triton.code_gen.CompilationError) as e:
+        bad[(1, )](x, z, BLOCK=128)
+    lines = e.value.message.split('\n')
+    caret = next(i for i, line in enumerate(lines) if line.strip() == '^')
+    assert lines[caret].index('^') == lines[caret - 1].index('x & 1.0')
+    # operations recorded before the error do not leak into the next compile
+    good = patch_kernel(kernel, {'GENERATE_TEST_HERE': 'x'})
+    good[(1, )](x, z, BLOCK=128)
+    triton.testing.assert_allclose(z, x * 3 + 1)
+
+
+
+
+def test_clone(device='cuda'):
+    @triton.jit
+    def kernel(X, Z, N, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        acc = tl.zeros([meta['BLOCK']], dtype=tl.float32)
+        for i in range(0, N):
+            acc += tl.load(X + i * meta['BLOCK'] + off)
+        tl.store(Z + off, acc)
+
+    x = torch.randn((4, 128), device=device)
+    z = torch.empty((128, ), device=device)
+    generator = triton.code_gen.Kernel(kernel)._generate(x, z, 4, attributes=dict(), constants=dict(), BLOCK=128)
+    clone = generator.module.clone()
+    tt_device = triton.code_gen._triton.driver.cu_device(torch.cuda.current_device(), False)
+    emit = triton.code_gen._triton.code_gen.add_passes_to_emit_bin
+    # both modules must go through codegen independently and agree
+    ref_mod, _, _, ref_ir = emit(generator.module, tt_device, 4, 2, False)
+    tri_mod, _, _, tri_ir = emit(clone, tt_device, 4, 2, False)
+    assert ref_ir == tri_ir
+    assert ref_mod.ptx() == tri_mod.ptx()
+
+
+def test_gvn(device='cuda'):
+    @triton.jit
+    def kernel(X, Z, **meta):
+        x = tl.load(X + tl.arange(0, meta['BLOCK']))
+        tl.store(Z + tl.arange(0, meta['BLOCK']), x * 2)
+
+    x = torch.randn((128, ), device=device)
+    z_tri = torch.empty_like(x)
+    binary = kernel[(1, )](x, z_tri, BLOCK=128)
+    triton.testing.assert_almost_equal(z_tri, x * 2)
+    # both aranges are numbered the same
+    assert binary.asm('ttir').count('make_range') == 1
+
+
+def test_simplify(device='cuda'):
+    @triton.jit
+    def kernel(X, Z, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        x = tl.load(X + off * 1 + 0)
+        tl.store(Z + off, x * 1. - 0.)
+
+    @triton.jit
+    def reference(X, Z, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        x = tl.load(X + off)
+        tl.store(Z + off, x)
+
+    x = torch.randn((128, ), device=device)
+    z_tri = torch.empty_like(x)
+    binary = kernel[(1, )](x, z_tri, BLOCK=128)
+    triton.testing.assert_almost_equal(z_tri, x)
+    # identities are folded away before code generation
+    ref_binary = reference[(1, )](x, z_tri, BLOCK=128)
+    assert len(binary.asm('llir').splitlines()) <= len(ref_binary.asm('llir').splitlines())
+
+
+def test_reassociate(device='cuda'):
+    @triton.jit
+    def kernel(X, Z, stride_xm, **meta):
+        pid = tl.program_id(0)
+        rm = pid * meta['BLOCK_M'] + tl.arange(0, meta['BLOCK_M'])
+        rn = tl.arange(0, meta['BLOCK_N'])
+        x = tl.load(X + (rm[:, None] * stride_xm + rn[None, :] + 1))
+        tl.store(Z + rm[:, None] * meta['BLOCK_N'] + rn[None, :], x)
+
+    x = torch.randn((64, 33), device=device)
+    z_tri = torch.empty((64, 32), device=device)
+    kernel[(4, )](x, z_tri, x.stride(0), BLOCK_M=16, BLOCK_N=32)
+    triton.testing.assert_almost_equal(z_tri, x[:, 1:])
+
+
+def test_estimate_registers(device='cuda'):
+    @triton.jit
+    def kernel(X, Z, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        tl.store(Z + off, tl.load(X + off))
+
+    x = torch.randn((8192, ), device=device)
+    z = torch.empty((8192, ), device=device)
+    small = kernel._init_kernel().estimate_registers(x, z, num_warps=4, BLOCK=128)
+    large = kernel._init_kernel().estimate_registers(x, z, num_warps=4, BLOCK=8192)
+    assert 0 < small < large
+
+
+def test_estimate_registers_reused(monkeypatch, device='cuda'):
+    lowered = []
+    lower = triton.code_gen.Kernel._lower
+    def count(self, *args, **kwargs):
+        lowered.append(kwargs['num_warps'])
+        return lower(self, *args, **kwargs)
+    monkeypatch.setattr(triton.code_gen.Kernel, '_lower', count)
+    x = torch.randn((1024, ), device=device)
+    z = torch.empty((1024, ), device=device)
+    # the passes run for the estimate are reused by the launch
+    @triton.jit
+    def kernel(X, Z, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        tl.store(Z + off, tl.load(X + off))
+
+    kernel._init_kernel().estimate_registers(x, z, grid=(1, ), num_warps=4, BLOCK=128)
+    kernel[(1, )](x, z, num_warps=4, BLOCK=128)
+    assert lowered == [4]
+    assert not kernel.lowered
+    triton.testing.assert_almost_equal(z[:128], x[:128])
+    # the autotuner forwards the grid to the estimate
+    lowered.clear()
+    configs = [triton.Config({'BLOCK': 128}, num_warps=2), triton.Config({'BLOCK': 128}, num_warps=4)]
+    @triton.autotune(configs=configs, key=[])
+    @triton.jit
+    def tuned(X, Z, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        tl.store(Z + off, tl.load(X + off))
+
+    tuned[lambda meta: (1, )](x, z)
+    assert sorted(lowered) == [2, 4]
+    assert not tuned.lowered
+
 # ---------------
 # test load
 # ---------------
 
+@pytest.mark.parametrize("N", [64, 128, 200])
+def test_masked_load_in_bounds(N, device='cuda'):
+    @triton.jit
+    def kernel(X, Z, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        mask = off < meta['N']
+        x = tl.load(X + off, mask=mask, other=1.)
+        tl.store(Z + off, x, mask=mask)
+
+    x = torch.randn((256, ), device=device)
+    z_tri = torch.zeros((256, ), device=device)
+    binary = kernel[(1, )](x, z_tri, N=N, BLOCK=128)
+    z_ref = torch.zeros((256, ), device=device)
+    z_ref[:min(N, 128)] = x[:min(N, 128)]
+    triton.testing.assert_almost_equal(z_tri, z_ref)
+    # masks that are provably true are removed
+    if N >= 128:
+        assert 'masked_' not in binary.asm('ttir')
+
+@pytest.mark.parametrize("cache", ["", ".ca", ".cg", ".cs", ".lu", ".cv"])
+def test_load_cache_modifier(cache, device='cuda'):
+    @triton.jit
+    def kernel(X, Z, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        x = tl.load(X + off, cache_modifier=meta['CACHE'])
+        tl.store(Z + off, x)
+
+    x = torch.randn((128, ), device=device)
+    z_tri = torch.empty_like(x)
+    binary = kernel[(1, )](x, z_tri, BLOCK=128, CACHE=cache)
+    triton.testing.assert_almost_equal(z_tri, x)
+    assert f'ld.global{cache}.' in binary.asm('ptx')
+
+@pytest.mark.parametrize("eviction_policy, cache", [("", ""), ("evict_first", ".cs"), ("evict_last", ".ca")])
+def test_load_eviction_policy(eviction_policy, cache, device='cuda'):
+    @triton.jit
+    def kernel(X, Z, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        x = tl.load(X + off, eviction_policy=meta['EVICTION'])
+        tl.store(Z + off, x)
+
+    x = torch.randn((128, ), device=device)
+    z_tri = torch.empty_like(x)
+    binary = kernel[(1, )](x, z_tri, BLOCK=128, EVICTION=eviction_policy)
+    triton.testing.assert_almost_equal(z_tri, x)
+    # eviction priorities are lowered to the closest cache operator
+    assert f'ld.global{cache}.' in binary.asm('ptx')
+
 # ---------------
 # test store
 # ---------------
 
+@pytest.mark.parametrize("cache, eviction_policy", [(".cs", ""), (".wt", ""), ("", "evict_first"), ("", "evict_last")])
+def test_store_cache_modifier(cache, eviction_policy, device='cuda'):
+    @triton.jit
+    def kernel(X, Z, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        x = tl.load(X + off, volatile=True)
+        tl.store(Z + off, x, cache_modifier=meta['CACHE'], eviction_policy=meta['EVICTION'])
+
+    x = torch.randn((128, ), device=device)
+    z_tri = torch.empty_like(x)
+    binary = kernel[(1, )](x, z_tri, BLOCK=128, CACHE=cache, EVICTION=eviction_policy)
+    triton.testing.assert_almost_equal(z_tri, x)
+    ptx = binary.asm('ptx')
+    assert 'ld.volatile.global' in ptx
+    if not cache:
+        cache = {"evict_first": ".cs", "evict_last": ""}[eviction_policy]
+    assert f'st.global{cache}.' in ptx
+
 # ---------------
 # test if
 # ---------------
@@ -508,6 +1309,154 @@ def test_dot(epilogue, device='cuda'):
 # test for
 # ---------------
 
+@pytest.mark.parametrize("N", [1, 3, 8, 64])
+def test_for_constexpr(N, device='cuda'):
+    @triton.jit
+    def kernel(X, Z, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        acc = tl.zeros([meta['BLOCK']], dtype=tl.float32)
+        for i in range(0, meta['N']):
+            acc += tl.load(X + i * meta['BLOCK'] + off)
+        tl.store(Z + off, acc)
+
+    x = torch.randn((N, 128), device=device)
+    z_tri = torch.empty((128, ), device=device)
+    binary = kernel[(1, )](x, z_tri, N=N, BLOCK=128)
+    triton.testing.assert_almost_equal(z_tri, x.sum(0))
+    # short loops with compile-time bounds are fully unrolled
+    if N <= 8:
+        assert 'phi' not in binary.asm('ttir')
+
+
+@pytest.mark.parametrize("N", [0, 1, 17])
+def test_for_invariant(N, device='cuda'):
+    @triton.jit
+    def kernel(X, Y, Z, N, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        acc = tl.zeros([meta['BLOCK']], dtype=tl.float32)
+        for i in range(0, N):
+            # loop-invariant load, hoisted and predicated on N > 0
+            acc += tl.load(X + off) * i + tl.load(Y + i * meta['BLOCK'] + off)
+        tl.store(Z + off, acc)
+
+    x = torch.randn((128, ), device=device)
+    y = torch.randn((max(N, 1), 128), device=device)
+    z_tri = torch.empty((128, ), device=device)
+    kernel[(1, )](x, y, z_tri, N, BLOCK=128)
+    z_ref = x * sum(range(N)) + y[:N].sum(0)
+    triton.testing.assert_almost_equal(z_tri, z_ref)
+
+
+@pytest.mark.parametrize("N", [1, 17])
+def test_for_pointer_increment(N, device='cuda'):
+    @triton.jit
+    def kernel(X, Z, N, stride_xn, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        ptrs = X + off
+        acc = tl.zeros([meta['BLOCK']], dtype=tl.float32)
+        for i in range(0, N):
+            acc += tl.load(ptrs)
+            ptrs += stride_xn
+        tl.store(Z + off, acc)
+
+    x = torch.randn((N, 128), device=device)
+    z_tri = torch.empty((128, ), device=device)
+    kernel[(1, )](x, z_tri, N, x.stride(0), BLOCK=128)
+    triton.testing.assert_almost_equal(z_tri, x.sum(0))
+
+
+@pytest.mark.parametrize("N", [1, 100, 128])
+def test_for_pipelined_loads(N, device='cuda'):
+    # loads feeding element-wise operations, with pointers and
+    # masks computed from the induction variable
+    @triton.jit
+    def kernel(X, Y, Z, N, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        acc = tl.zeros([meta['BLOCK']], dtype=tl.float32)
+        for k in range(0, N, meta['BLOCK']):
+            x = tl.load(X + k + off, mask=k + off < N, other=0.)
+            y = tl.load(Y + k + off, mask=k + off < N, other=0.)
+            acc += x * y
+        tl.store(Z + off, acc)
+
+    BLOCK = 32
+    x = torch.randn((N, ), device=device)
+    y = torch.randn((N, ), device=device)
+    z_tri = torch.empty((BLOCK, ), device=device)
+    binary = kernel[(1, )](x, y, z_tri, N, BLOCK=BLOCK)
+    xy = torch.zeros((triton.cdiv(N, BLOCK) * BLOCK, ), device=device)
+    xy[:N] = x * y
+    triton.testing.assert_almost_equal(z_tri, xy.view(-1, BLOCK).sum(0))
+    # both loads are pre-fetched into phi nodes
+    assert binary.asm('ttir').count('phi f32<32>') >= 3
+
+
+@pytest.mark.parametrize("N", [1, 3])
+def test_for_shared_reuse(N, device='cuda'):
+    # `a` is converted to shared memory before the loop and read in every
+    # iteration: its buffer must not be reused by the ones of the loop body
+    @triton.jit
+    def kernel(A, B, Z, N, **meta):
+        BLOCK = meta['BLOCK']
+        off_m = tl.arange(0, BLOCK)
+        off_n = tl.arange(0, BLOCK)
+        ptrs_a = A + off_m[:, None] * BLOCK + off_n[None, :]
+        ptrs_b = B + off_m[:, None] * BLOCK + off_n[None, :]
+        a = tl.load(ptrs_a)
+        acc = tl.dot(a, tl.load(ptrs_b))
+        for i in range(0, N):
+            ptrs_b += BLOCK * BLOCK
+            acc += tl.dot(a, tl.load(ptrs_b))
+        tl.store(Z + off_m[:, None] * BLOCK + off_n[None, :], acc)
+
+    BLOCK = 32
+    a = triton.testing.random((BLOCK, BLOCK), dtype=torch.float16, device=device)
+    b = triton.testing.random((N + 1, BLOCK, BLOCK), dtype=torch.float16, device=device)
+    z_tri = torch.empty((BLOCK, BLOCK), dtype=torch.float32, device=device)
+    kernel[(1, )](a, b, z_tri, N, BLOCK=BLOCK)
+    z_ref = torch.matmul(a.float(), b.float()).sum(0)
+    triton.testing.assert_almost_equal(z_tri, z_ref)
+
+
+# dots whose operands are all loaded upfront have overlapping shared buffers;
+# dots whose operands are loaded right before them can reuse the same buffers.
+# more than 12 buffers are packed by best-fit decreasing alone
+@pytest.mark.parametrize("num_dots, overlap", [(2, False), (2, True), (13, False), (7, True)])
+def test_shared_packing(num_dots, overlap, device='cuda'):
+    @triton.jit
+    def kernel(A, B, Z, **meta):
+        BLOCK = meta['BLOCK']
+        off_m = tl.arange(0, BLOCK)
+        off_n = tl.arange(0, BLOCK)
+        ptrs_a = A + off_m[:, None] * BLOCK + off_n[None, :]
+        ptrs_b = B + off_m[:, None] * BLOCK + off_n[None, :]
+        GENERATE_TEST_HERE
+        tl.store(Z + off_m[:, None] * BLOCK + off_n[None, :], acc)
+
+    def dots(num_dots, overlap):
+        load = lambda ptrs, i: f'tl.load({ptrs} + {i} * BLOCK * BLOCK)'
+        if overlap:
+            stmts = [f'a{i} = {load("ptrs_a", i)}; b{i} = {load("ptrs_b", i)}' for i in range(num_dots)]
+            stmts += [f'acc {"+=" if i else "="} tl.dot(a{i}, b{i})' for i in range(num_dots)]
+        else:
+            stmts = [f'acc {"+=" if i else "="} tl.dot({load("ptrs_a", i)}, {load("ptrs_b", i)})' for i in range(num_dots)]
+        return '\n    '.join(stmts)
+
+    BLOCK = 32
+    a = triton.testing.random((num_dots, BLOCK, BLOCK), dtype=torch.float16, device=device)
+    b = triton.testing.random((num_dots, BLOCK, BLOCK), dtype=torch.float16, device=device)
+    z_tri = torch.empty((BLOCK, BLOCK), dtype=torch.float32, device=device)
+    # shared memory needed by the two operands of a single dot
+    single = patch_kernel(kernel, {'GENERATE_TEST_HERE': dots(1, False)})
+    expected = single[(1, )](a, b, z_tri, BLOCK=BLOCK).shared_mem
+    if overlap:
+        expected *= num_dots
+    kernel = patch_kernel(kernel, {'GENERATE_TEST_HERE': dots(num_dots, overlap)})
+    binary = kernel[(1, )](a, b, z_tri, BLOCK=BLOCK)
+    assert binary.shared_mem == expected
+    z_ref = torch.matmul(a.float(), b.float()).sum(0)
+    triton.testing.assert_almost_equal(z_tri, z_ref)
+
 # ---------------
 # test while
 # ---------------
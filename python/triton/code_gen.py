@@ -37,7 +37,6 @@ class CodeGenerator(ast.NodeVisitor):
             value = triton.language.block(value)
         if isinstance(value, triton.language.block):
             self.module.set_value(name, value.handle)
-            self.module.set_type(name, value.handle.type)
         self.lscope[name] = value
 
     def is_triton_object(self, value):
@@ -46,6 +45,8 @@ class CodeGenerator(ast.NodeVisitor):
     def visit_compound_statement(self, stmts):
         for stmt in stmts:
             self.last_ret = self.visit(stmt)
+            # recorded operations never outlive the statement (and its basic block)
+            self.tape.flush()
             if isinstance(stmt, ast.Return):
                 break
         return stmts and isinstance(stmt, ast.Return)
@@ -60,6 +61,14 @@ class CodeGenerator(ast.NodeVisitor):
         self.constants = constants
         self.kwargs = kwargs
         self.last_node = None
+        # node whose visit is in progress
+        self.current_node = None
+        # element-wise operations are batched per statement
+        self.tape = triton.language.core._Tape(self.builder, lambda: self.current_node)
+        self.builder.tape = self.tape
+        # jit'd helpers compiled to Triton-IR, keyed by (helper, signature);
+        # shared with the generators of the helpers themselves
+        self.callees = dict()
         self.builtins = {
             'range': range,
             'min': triton.language.minimum,
@@ -403,7 +412,18 @@ class CodeGenerator(ast.NodeVisitor):
     def visit(self, node):
         if node is not None:
             self.last_node = node
-        return super().visit(node)
+        current_node, self.current_node = self.current_node, node
+        try:
+            return super().visit(node)
+        except Exception:
+            # operations recorded before the error are never emitted, and
+            # errors of batched operations point at their own expression
+            if self.tape.error_location is not None:
+                self.last_node = self.tape.error_location
+            self.tape.discard()
+            raise
+        finally:
+            self.current_node = current_node
 
     def generic_visit(self, node):
         typename = type(node).__name__
@@ -529,7 +549,7 @@ class Kernel:
     def __init__(self, fn):
         self.fn = fn
 
-    def _compile(self, *wargs, device, attributes, constants, num_warps, num_stages, force_nc_cache, **meta):
+    def _generate(self, *wargs, attributes, constants, **meta):
         # create IR module
         context = _triton.ir.context()
         # get just-in-time proto-type of kernel
@@ -547,12 +567,76 @@ class Kernel:
             if node is None or isinstance(e, (NotImplementedError, CompilationError)):
                 raise e
             raise CompilationError(self.fn.src, node, e)
+        return generator
+
+    def _lower(self, *wargs, device, attributes, constants, num_warps, num_stages, force_nc_cache, **meta):
+        # generate Triton-IR; the generator owns the builder the module refers to
+        generator = self._generate(*wargs, attributes=attributes, constants=constants, **meta)
+        # run the compiler passes
+        lowering = _triton.code_gen.lowering(generator.module, device, num_warps, num_stages, force_nc_cache)
+        return generator, lowering
+
+    def _compile(self, *wargs, key, device, attributes, constants, num_warps, num_stages, force_nc_cache, **meta):
+        # the passes may already have run to estimate registers
+        lowered = self.fn.lowered.pop((key, force_nc_cache), None)
+        if lowered is None:
+            lowered = self._lower(*wargs, device=device, attributes=attributes, constants=constants,
+                                  num_warps=num_warps, num_stages=num_stages, force_nc_cache=force_nc_cache, **meta)
+        generator, lowering = lowered
         # Compile to machine code
-        mod, ker, shared_mem, ir_asm = _triton.code_gen.add_passes_to_emit_bin(generator.module, device, num_warps, num_stages, force_nc_cache)
+        mod, ker, shared_mem, ir_asm = lowering.emit_bin(generator.module)
         if shared_mem > device.max_shared_memory():
             raise OutOfResources(shared_mem, device.max_shared_memory(), "shared memory")
         return Binary(mod, ker, num_warps, num_stages, force_nc_cache, shared_mem, ir_asm)
 
+    @staticmethod
+    def _cache_key(*wargs, device, attributes, constants, num_warps, num_stages, **meta):
+        tensor_idxs = [i for i, arg in enumerate(wargs) if hasattr(arg, 'data_ptr')]
+        types_key = Kernel._types_key(*wargs, tensor_idxs=tensor_idxs)
+        attr_key = frozenset(attributes.items())
+        meta_key = frozenset(meta.items())
+        const_key = frozenset(constants.items())
+        return (device.type, device.index, types_key, attr_key, num_warps, num_stages, meta_key, const_key)
+
+    def estimate_registers(self, *wargs, grid=None, num_warps=4, num_stages=2, **meta):
+        """
+        Returns the number of registers per thread the compiler estimates the kernel needs
+        with the given configuration, without generating machine code.
+        The pass results are kept until the kernel is launched with this configuration
+        or until :code:`clear_lowered` is called. :code:`grid` is accepted (and ignored)
+        so that launch arguments can be forwarded as-is.
+        """
+        device = torch.device('cuda', torch.cuda.current_device())
+        tt_device = _triton.driver.cu_device(device.index, False)
+        args = [arg.data_ptr() if hasattr(arg, 'data_ptr') else arg for arg in wargs]
+        attributes = {i: Kernel.pow2_divisor(a) for i, a in enumerate(args) if isinstance(a, int)}
+        constants = {i: arg for i, arg in enumerate(wargs) if isinstance(arg, int) and arg == 1}
+        key = Kernel._cache_key(*wargs, device=device, attributes=attributes, constants=constants,
+                                num_warps=num_warps, num_stages=num_stages, **meta)
+        if (key, False) not in self.fn.lowered:
+            self.fn.lowered[(key, False)] = self._lower(*wargs, device=tt_device, attributes=attributes, constants=constants,
+                                                        num_warps=num_warps, num_stages=num_stages, force_nc_cache=False, **meta)
+        return self.fn.lowered[(key, False)][1].num_registers
+
+    def host_llir(self, *wargs, num_warps=4, num_stages=2, **meta):
+        """
+        Returns the LLVM-IR generated for the host (CPU) target. The host backend
+        cannot launch kernels, but this lets code generation be checked without a GPU.
+        """
+        tt_device = _triton.driver.host_device()
+        args = [arg.data_ptr() if hasattr(arg, 'data_ptr') else arg for arg in wargs]
+        attributes = {i: Kernel.pow2_divisor(a) for i, a in enumerate(args) if isinstance(a, int)}
+        constants = {i: arg for i, arg in enumerate(wargs) if isinstance(arg, int) and arg == 1}
+        generator, lowering = self._lower(*wargs, device=tt_device, attributes=attributes, constants=constants,
+                                          num_warps=num_warps, num_stages=num_stages, force_nc_cache=False, **meta)
+        return lowering.llir(generator.module)
+
+    def clear_lowered(self):
+        """
+        Drops the pass results kept by :code:`estimate_registers`.
+        """
+        self.fn.lowered.clear()
+
     def __call__(self, *wargs, grid, num_warps=4, num_stages=2, force_nc_cache=False, **meta):
         # device inference
         tensor_idxs = [i for i, arg in enumerate(wargs) if hasattr(arg, 'data_ptr')]
@@ -590,16 +674,13 @@ class Kernel:
         # transforms ints whose value is one into constants for just-in-time compilation
         constants = {i: arg for i, arg in enumerate(wargs) if isinstance(arg, int) and arg == 1}
         # determine if we need to re-compile
-        types_key = Kernel._types_key(*wargs, tensor_idxs=tensor_idxs)
-        attr_key = frozenset(attributes.items())
-        meta_key = frozenset(meta.items())
-        const_key = frozenset(constants.items())
-        key = (device.type, device.index, types_key, attr_key, num_warps, num_stages, meta_key, const_key)
+        key = Kernel._cache_key(*wargs, device=device, attributes=attributes, constants=constants,
+                                num_warps=num_warps, num_stages=num_stages, **meta)
         cache = self.fn.cache
         if key not in cache:
             # compile and cache configuration if necessary
             cache[key] = self._compile(
-                *wargs, device=tt_device, attributes=attributes,
+                *wargs, key=key, device=tt_device, attributes=attributes,
                 num_warps=num_warps, num_stages=num_stages, force_nc_cache=force_nc_cache, 
                 constants=constants, **meta
             )
@@ -658,12 +739,32 @@ class Autotuner:
             self.kernel(*args, num_warps=config.num_warps, num_stages=config.num_stages, **current)
         return triton.testing.do_bench(kernel_call)
 
+    def _prune(self, *args, **meta):
+        # drop the configurations that are expected to spill registers,
+        # unless all of them are
+        if not hasattr(self.kernel, 'estimate_registers'):
+            return self.configs
+        # the grid is a launch argument, not a meta-parameter
+        meta = {k: v for k, v in meta.items() if k != 'grid'}
+        pruned = []
+        for config in self.configs:
+            limit = builtins.min(255, 65536 // (32 * config.num_warps))
+            current = dict(meta, **config.meta)
+            num_registers = self.kernel.estimate_registers(*args, num_warps=config.num_warps,
+                                                           num_stages=config.num_stages, **current)
+            if num_registers <= limit:
+                pruned.append(config)
+        return pruned if pruned else self.configs
+
     def __call__(self, *args, **meta):
         if len(self.configs) > 1:
             key = tuple([args[i] for i in self.key_idx])
             if key not in self.cache:
                 timings = {config: self._bench(*args, config=config, **meta) \
-                        for config in self.configs}
+                        for config in self._prune(*args, **meta)}
+                # pass results of the pruned configurations are not needed
+                if hasattr(self.kernel, 'clear_lowered'):
+                    self.kernel.clear_lowered()
                 self.cache[key] = builtins.min(timings, key=timings.get)
                 self.hook(args)
             config = self.cache[key]
@@ -678,6 +779,9 @@ class JITFunction:
         self.module = fn.__module__
         self.arg_names = inspect.getfullargspec(fn).args
         self.cache = dict()
+        # pass results of configurations whose registers were estimated
+        # but which were not compiled yet
+        self.lowered = dict()
         self.kernel_decorators = []
         self.src = textwrap.dedent(inspect.getsource(fn))
         self.kernel = None
@@ -686,18 +790,85 @@ class JITFunction:
     # we do not parse in the constructor because
     # the user might want to monkey-patch self.src dynamically.
     # Some unit tests do this, for example.
+    # The resulting tree is cached until self.src changes, so that
+    # kernels calling jit'd helpers do not re-parse them at every call site.
     def parse(self):
-        tree = ast.parse(self.src)
-        assert isinstance(tree, ast.Module)
-        assert len(tree.body) == 1
-        assert isinstance(tree.body[0], ast.FunctionDef)
-        return tree
+        if self.tree is None:
+            tree = ast.parse(self.src)
+            assert isinstance(tree, ast.Module)
+            assert len(tree.body) == 1
+            assert isinstance(tree.body[0], ast.FunctionDef)
+            self.tree = tree
+        return self.tree
+
+    # Helpers are compiled once per signature into a Triton-IR function whose
+    # body is then cloned into each call site by `module.inline_function`.
+    # Returns nested in control flow or arguments that cannot be hashed
+    # fall back to inlining the AST.
+    def _callee_key(self, args, generator):
+        node = self.parse().body[0]
+        if len(args) != len(node.args.args):
+            return None
+        returns = [n for stmt in node.body for n in ast.walk(stmt) if isinstance(n, ast.Return)]
+        if any(r is not node.body[-1] for r in returns):
+            return None
+        key = []
+        for arg in args:
+            if isinstance(arg, triton.language.block):
+                ty_name, shape = arg.handle.type_info
+                key.append((ty_name, tuple(shape)))
+            else:
+                key.append((type(arg), arg))
+        if node.args.kwarg is not None:
+            key.append(tuple(sorted(generator.kwargs.items())))
+        key = tuple(key)
+        try:
+            hash(key)
+        except TypeError:
+            return None
+        return key
+
+    def _compile_callee(self, args, generator):
+        context = generator.builder.context
+        int32 = _triton.ir.type.get_int32(context)
+        arg_types = [arg.handle.type if isinstance(arg, triton.language.block) else int32 for arg in args]
+        prototype = _triton.ir.type.make_function(_triton.ir.type.get_void(context), arg_types)
+        constants = {i: arg for i, arg in enumerate(args) if not isinstance(arg, triton.language.block)}
+        gscope = sys.modules[self.fn.__module__].__dict__
+        callee = CodeGenerator(context, prototype, gscope=gscope, attributes=dict(), constants=constants, kwargs=generator.kwargs)
+        callee.callees = generator.callees
+        node = self.parse().body[0]
+        try:
+            callee.visit(self.parse())
+        except Exception as e:
+            if callee.last_node is None or isinstance(e, (NotImplementedError, CompilationError)):
+                raise e
+            raise CompilationError(self.src, callee.last_node, e)
+        fn = callee.module.get_or_insert_function(node.name, prototype)
+        ret = callee.last_ret if node.body and isinstance(node.body[-1], ast.Return) else None
+        return callee, fn, ret
 
     def __call__(self, *args, generator: CodeGenerator, **meta):
+        key = self._callee_key(args, generator)
+        if key is None:
+            return self._inline(*args, generator=generator)
+        if (self, key) not in generator.callees:
+            generator.callees[(self, key)] = self._compile_callee(args, generator)
+        _, fn, ret = generator.callees[(self, key)]
+        rets = list(ret) if isinstance(ret, tuple) else [ret]
+        handles = [r.handle for r in rets if isinstance(r, triton.language.block)]
+        ir_args = [arg.handle if isinstance(arg, triton.language.block) else None for arg in args]
+        handles = iter(generator.module.inline_function(fn, ir_args, handles))
+        rets = [triton.language.block(next(handles)) if isinstance(r, triton.language.block) else r for r in rets]
+        return tuple(rets) if isinstance(ret, tuple) else rets[0]
+
+    def _inline(self, *args, generator: CodeGenerator):
         try:
-            gscope = generator.gscope.copy()
+            # the global scope is only re-bound (never mutated) and
+            # `get_values` already returns a fresh dict, so neither need a copy
+            gscope = generator.gscope
             lscope = generator.lscope.copy()
-            values = generator.module.get_values().copy()
+            values = generator.module.get_values()
             generator.gscope = sys.modules[self.fn.__module__].__dict__
             ret = generator.visit_FunctionDef(self.parse().body[0], inline=True, arg_values=args)
             generator.gscope = gscope
@@ -713,6 +884,8 @@ class JITFunction:
     def __setattr__(self, name, value):
         if name == 'kernel_decorators':
             self.kernel = None
+        if name == 'src':
+            self.tree = None
         super(JITFunction, self).__setattr__(name, value)
 
     def _init_kernel(self):
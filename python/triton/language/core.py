@@ -19,17 +19,80 @@ def _to_ir(x, builder):
     return x
 
 
-def _patch(fn):
+# Value-only frontend operations are recorded on a tape instead of crossing
+# into C++ one at a time. The tape is emitted by a single `frontend.run_tape`
+# call when one of its results is first used, or when its owner flushes it.
+# Operations go to the tape attached to their builder (`builder.tape`), if any.
+class _Tape:
+    opcodes = {name: i for i, name in enumerate(frontend.batched_ops)}
+
+    def __init__(self, builder, location=lambda: None):
+        self.builder = builder
+        # returns the source location of the operation being recorded
+        self.location = location
+        # source location of the operation that made the last flush fail
+        self.error_location = None
+        self.discard()
+
+    def record(self, opcode, args):
+        entry = [opcode]
+        for x in args:
+            if isinstance(x, block) and x._handle is None and x._tape is self:
+                entry.append((x._slot, ))
+            elif isinstance(x, (bool, int, float)):
+                entry.append(x)
+            else:
+                entry.append(_to_ir(x, self.builder))
+        ret = block.__new__(block)
+        ret._handle = None
+        ret._tape = self
+        ret._slot = len(self.results)
+        self.entries.append(tuple(entry))
+        self.results.append(ret)
+        self.locations.append(self.location())
+        return ret
+
+    def flush(self):
+        if not self.entries:
+            return
+        entries, results, locations = self.entries, self.results, self.locations
+        self.discard()
+        try:
+            values = frontend.run_tape(entries, self.builder)
+        except Exception:
+            # replay growing prefixes of the tape to find the failing operation;
+            # the module is being discarded anyway
+            for i in range(len(entries)):
+                try:
+                    frontend.run_tape(entries[:i + 1], self.builder)
+                except Exception:
+                    self.error_location = locations[i]
+                    break
+            raise
+        for ret, (handle, ty_name, shape) in zip(results, values):
+            ret._init(handle, ty_name, shape)
+
+    def discard(self):
+        self.entries = []
+        self.results = []
+        self.locations = []
+
+
+def _patch(fn, opcode=None):
     def _from_ir(x):
         if isinstance(x, ir.value):
-            if x.type.is_void():
+            type_info = x.type_info
+            if type_info[0] == 'void':
                 return None
-            return block(x)
+            return block(x, type_info)
         return x
 
     def wrapper(*args, **kwargs):
         builder = args[-1]
         assert isinstance(builder, ir.builder)
+        tape = getattr(builder, 'tape', None)
+        if opcode is not None and tape is not None and not kwargs:
+            return tape.record(opcode, args[:-1])
         args = [_to_ir(x, builder) for x in args]
         kwargs = {k: _to_ir(v, builder) for k, v in kwargs.items()}
         ret = fn(*args, **kwargs)
@@ -42,8 +105,8 @@ def _patch(fn):
 
 for name in dir(frontend):
     fn = getattr(frontend, name)
-    if callable(fn):
-        setattr(frontend, name, _patch(fn))
+    if callable(fn) and name != 'run_tape':
+        setattr(frontend, name, _patch(fn, _Tape.opcodes.get(name)))
 
 
 def builtin(fn):
@@ -89,34 +152,55 @@ pi32_t = pointer_dtype(int32)
 
 
 class block:
+    # scalar type names, as printed by Triton-IR
+    _dtypes = {
+        'i1': int1, 'i8': int8, 'i16': int16, 'i32': int32, 'i64': int64,
+        'fp8': float8, 'f16': float16, 'bf16': bfloat16, 'f32': float32, 'f64': float64,
+    }
+
     @staticmethod
-    def _init_dtype(ir_type):
+    def _init_dtype(ty_name):
         # primitive type
-        if ir_type.is_int1(): return int1
-        if ir_type.is_int8(): return int8
-        if ir_type.is_int16(): return int16
-        if ir_type.is_int32(): return int32
-        if ir_type.is_int64(): return int64
-        if ir_type.is_fp8(): return float8
-        if ir_type.is_fp16(): return float16
-        if ir_type.is_bf16(): return bfloat16
-        if ir_type.is_fp32(): return float32
-        if ir_type.is_fp64(): return float64
+        if ty_name in block._dtypes:
+            return block._dtypes[ty_name]
         # pointer type
-        if ir_type.is_ptr():
-            element_ty = block._init_dtype(ir_type.element)
-            return pointer_dtype(element_ty)
-        raise ValueError(f"Unsupported type {ir_type}")
-
-    def __init__(self, handle):
+        if ty_name.endswith('*'):
+            element_ty = block._init_dtype(ty_name[:-1])
+            return block._dtypes.setdefault(ty_name, pointer_dtype(element_ty))
+        raise ValueError(f"Unsupported type {ty_name}")
+
+    def __init__(self, handle, type_info=None):
+        # Scalar type and block shape are fetched in a single call
+        if type_info is None:
+            type_info = handle.type_info
+        self._init(handle, *type_info)
+
+    def _init(self, handle, ty_name, shape):
         # IR handle
-        self.handle = handle
+        self._handle = handle
         # Block shape
-        self.shape = (1, )
-        if self.handle.type.is_block():
-            self.shape = self.handle.type.shape
+        self._shape = shape if shape else (1, )
         # Data-type wrapper
-        self.dtype = block._init_dtype(self.handle.type.scalar)
+        self._dtype = block._init_dtype(ty_name)
+
+    # blocks recorded on the tape are only built when first used
+    @property
+    def handle(self):
+        if self._handle is None:
+            self._tape.flush()
+        return self._handle
+
+    @property
+    def shape(self):
+        if self._handle is None:
+            self._tape.flush()
+        return self._shape
+
+    @property
+    def dtype(self):
+        if self._handle is None:
+            self._tape.flush()
+        return self._dtype
 
     @builtin
     def __add__(self, other, _builder=None):
@@ -365,18 +449,22 @@ def reshape(input, shape, _builder=None):
 
 
 @builtin
-def dot(input, other, _builder=None):
+def dot(input, other, allow_tf32=False, _builder=None):
     """
     Returns the matrix product of two blocks.
 
     The two blocks must be two dimensionals and have compatible inner dimensions.
+    The product of two :code:`int8` blocks is accumulated in :code:`int32`.
+    :code:`bfloat16` blocks use tensor cores on sm_80 and later.
 
     :param input: The first block to be multiplied.
-    :type input: 2D block of scalar-type in {:code:`float16`, :code:`float32`}
+    :type input: 2D block of scalar-type in {:code:`float16`, :code:`bfloat16`, :code:`float32`, :code:`int8`}
     :param other: The second block to be multiplied.
-    :type other: 2D block of scalar-type in {:code:`float16`, :code:`float32`}
+    :type other: 2D block of scalar-type in {:code:`float16`, :code:`bfloat16`, :code:`float32`, :code:`int8`}
+    :param allow_tf32: if true, :code:`float32` blocks are rounded to tf32 and multiplied on tensor cores (sm_80 and later)
+    :type allow_tf32: bool
     """
-    return frontend.dot(input, other, _builder)
+    return frontend.dot(input, other, allow_tf32, _builder)
 
 
 # -----------------------
@@ -385,7 +473,7 @@ def dot(input, other, _builder=None):
 
 
 @builtin
-def load(pointer, mask=None, other=None, _builder=None):
+def load(pointer, mask=None, other=None, cache_modifier="", eviction_policy="", volatile=False, _builder=None):
     """
     Return a block of data whose values are, elementwise, loaded from memory at location defined by :code:`pointer`.
 
@@ -399,12 +487,18 @@ def load(pointer, mask=None, other=None, _builder=None):
     :type mask: Block of triton.int1, optional
     :param other: if mask[idx] is false, return other[idx]
     :type other: Block, optional
+    :param cache_modifier: PTX cache operator of the load: one of :code:`".ca"`, :code:`".cg"`, :code:`".cs"`, :code:`".lu"` or :code:`".cv"`.
+    :type cache_modifier: str, optional
+    :param eviction_policy: :code:`"evict_first"` for data read only once, :code:`"evict_last"` for data reused soon.
+    :type eviction_policy: str, optional
+    :param volatile: whether the load may not be cached or reordered.
+    :type volatile: bool, optional
     """
-    return frontend.load(pointer, mask, other, _builder)
+    return frontend.load(pointer, mask, other, cache_modifier, eviction_policy, volatile, _builder)
 
 
 @builtin
-def store(pointer, value, mask=None, _builder=None):
+def store(pointer, value, mask=None, cache_modifier="", eviction_policy="", volatile=False, _builder=None):
     """
     Stores :code:`value` block of elements in memory, element-wise, at the memory locations specified by :code:`pointer`. 
 
@@ -416,8 +510,14 @@ def store(pointer, value, mask=None, _builder=None):
     :type value: Block
     :param mask: If mask[idx] is false, do not store :code:`value[idx]` at :code:`pointer[idx]`.
     :type mask: Block of triton.int1, optional
+    :param cache_modifier: PTX cache operator of the store: one of :code:`".wb"`, :code:`".cg"`, :code:`".cs"` or :code:`".wt"`.
+    :type cache_modifier: str, optional
+    :param eviction_policy: :code:`"evict_first"` for data that will not be read soon, :code:`"evict_last"` otherwise.
+    :type eviction_policy: str, optional
+    :param volatile: whether the store may not be cached or reordered.
+    :type volatile: bool, optional
     """
-    return frontend.store(pointer, value, mask, _builder)
+    return frontend.store(pointer, value, mask, cache_modifier, eviction_policy, volatile, _builder)
 
 
 # -----------------------
@@ -598,6 +698,95 @@ def sum(input, axis, _builder=None):
     return frontend.sum(input, axis, _builder)
 
 
+@builtin
+@_add_reduction_docstr("index of the first maximum")
+def argmax(input, axis, _builder=None):
+    return frontend.argmax(input, axis, _builder)
+
+
+@builtin
+@_add_reduction_docstr("index of the first minimum")
+def argmin(input, axis, _builder=None):
+    return frontend.argmin(input, axis, _builder)
+
+
+@builtin
+@_add_reduction_docstr("logarithm of the sum of exponentials")
+def logsumexp(input, axis, _builder=None):
+    return frontend.logsumexp(input, axis, _builder)
+
+
+# -----------------------
+# Scans
+# -----------------------
+
+def _add_scan_docstr(name):
+
+    def _decorator(func):
+        docstr = """
+    Returns the inclusive cumulative {name} of the elements in the :code:`input` block along the provided :code:`axis`
+
+    :param input: the input values
+    :param axis: the dimension along which the scan should be done
+    """
+        func.__doc__ = docstr.format(name=name)
+        return func
+
+    return _decorator
+
+
+@builtin
+@_add_scan_docstr("sum")
+def cumsum(input, axis, _builder=None):
+    return frontend.cumsum(input, axis, _builder)
+
+
+@builtin
+@_add_scan_docstr("product")
+def cumprod(input, axis, _builder=None):
+    return frontend.cumprod(input, axis, _builder)
+
+
+@builtin
+@_add_scan_docstr("maximum")
+def cummax(input, axis, _builder=None):
+    return frontend.cummax(input, axis, _builder)
+
+
+@builtin
+@_add_scan_docstr("minimum")
+def cummin(input, axis, _builder=None):
+    return frontend.cummin(input, axis, _builder)
+
+
+# -----------------------
+# Sorting
+# -----------------------
+
+@builtin
+def sort(input, axis, descending=False, _builder=None):
+    """
+    Returns the elements of the :code:`input` block sorted along the provided :code:`axis`
+
+    :param input: the input values
+    :param axis: the dimension along which the elements should be sorted
+    :param descending: if true, the largest elements come first
+    """
+    return frontend.sort(input, axis, descending, _builder)
+
+
+@builtin
+def topk(input, k, axis, _builder=None):
+    """
+    Returns the :code:`k` largest elements of the :code:`input` block along the provided :code:`axis`, in decreasing order
+
+    :param input: the input values
+    :param k: the number of elements to keep, a power of 2
+    :param axis: the dimension along which the elements should be selected
+    """
+    return frontend.topk(input, k, axis, _builder)
+
+
 # -----------------------
 # Internal for debugging
 # -----------------------